@@ -78,6 +78,17 @@
 #define DCL_ALWAYS_INLINE
 #endif
 
+/// DCL_TARGET - On compilers where we have a directive to do so, compile a
+/// function for additional instruction-set features, e.g. "avx2". Callers are
+/// responsible for checking that the host supports them.
+#if __has_attribute(target) && !DCL_COMPILER_IS_MSVC
+#define DCL_TARGET(FEATURES) __attribute__((target(FEATURES)))
+#define DCL_HAS_TARGET_ATTRIBUTE 1
+#else
+#define DCL_TARGET(FEATURES)
+#define DCL_HAS_TARGET_ATTRIBUTE 0
+#endif
+
 #ifdef __GNUC__
 #define DCL_NORETURN __attribute__((noreturn))
 #elif defined(_MSC_VER)
@@ -164,10 +175,14 @@
 #define DCL_SCANF0_LIKE(FORMAT_ARG, FIRST_VAR_ARG)                             \
   __attribute__((__format__(__scanf__, FORMAT_ARG, FIRST_VAR_ARG)))
 
-#ifdef __LITTLE_ENDIAN__
+// Clang on Darwin defines __LITTLE_ENDIAN__ and __BIG_ENDIAN__, GCC only
+// defines __BYTE_ORDER__.
+#if defined(__LITTLE_ENDIAN__) ||                                              \
+  (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
 #define DCL_LITTLE_ENDIAN
 #endif
-#ifdef __BIG_ENDIAN__
+#if defined(__BIG_ENDIAN__) ||                                                 \
+  (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
 #define DCL_BIG_ENDIAN
 #endif
 
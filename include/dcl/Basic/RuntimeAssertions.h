@@ -29,7 +29,6 @@
 
 namespace dcl {
 
-DCL_ALWAYS_INLINE
 void _assert(
   bool predicate,
   bool predicate1,
@@ -42,11 +41,9 @@ void _assert(
  * `assert`. Thus this function is named with `_assert`.
  *
  */
-DCL_ALWAYS_INLINE
 void _assert(bool predicate, const char * __restrict format, ...)
   DCL_PRINTF_LIKE(2, 3);
 
-DCL_ALWAYS_INLINE
 void _assert(bool predicate);
 
 void precondition(bool predicate, const char * __restrict format, ...)
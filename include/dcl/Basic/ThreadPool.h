@@ -0,0 +1,115 @@
+//===--- ThreadPool.h - Reusable Worker Threads -----------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BASIC_THREADPOOL_H
+#define DCL_BASIC_THREADPOOL_H
+
+#include <dcl/Basic/Compilers.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dcl {
+
+/// Worker threads that run loops over indices.
+///
+/// The threads are started once, with the pool, and are reused by every
+/// loop, so that loops over a few items do not pay for creating threads.
+/// The pool runs one loop at a time. A loop started while another one runs,
+/// e.g. from the body of the other one, runs on the calling thread alone.
+class ThreadPool {
+
+private:
+  using WorkFn = void (*)(void * context, size_t index);
+
+  std::vector<std::thread> _workers;
+
+  std::mutex _mutex;
+
+  std::condition_variable _wakeCondition;
+
+  std::condition_variable _doneCondition;
+
+  std::atomic<bool> _isBusy;
+
+  WorkFn _work;
+
+  void * _context;
+
+  size_t _count;
+
+  std::atomic<size_t> _nextIndex;
+
+  /// The number of workers taking part in the current loop.
+  unsigned _helperCount;
+
+  /// The number of workers not yet done with the current loop.
+  unsigned _busyHelperCount;
+
+  uint64_t _generation;
+
+  bool _isStopping;
+
+public:
+  /// Starts a pool of `threadCount` threads, the calling one included.
+  /// Zero picks the number of hardware threads.
+  explicit ThreadPool(unsigned threadCount = 0);
+
+  ThreadPool(const ThreadPool&) = delete;
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool();
+
+  /// A pool with one thread per hardware thread, started on first use.
+  static ThreadPool& getShared();
+
+  /// The number of threads running a loop, the calling one included.
+  DCL_ALWAYS_INLINE
+  unsigned getThreadCount() const {
+    return static_cast<unsigned>(_workers.size() + 1);
+  }
+
+  /// Invokes `work` with every index in [0, `count`) on up to `threadCount`
+  /// threads of the pool, the calling one included, and returns once all of
+  /// them are done. Zero picks every thread of the pool.
+  template <typename Work>
+  void forEachIndex(size_t count, Work&& work, unsigned threadCount = 0) {
+    using WorkTy = std::remove_reference_t<Work>;
+    run(
+      count,
+      threadCount,
+      [](void * context, size_t index) {
+        (*static_cast<WorkTy *>(context))(index);
+      },
+      const_cast<void *>(static_cast<const void *>(std::addressof(work))));
+  }
+
+private:
+  void run(size_t count, unsigned threadCount, WorkFn work, void * context);
+
+  void drain();
+
+  void runWorker(unsigned workerIndex);
+};
+
+} // namespace dcl
+
+#endif // DCL_BASIC_THREADPOOL_H
@@ -0,0 +1,64 @@
+//===--- Fat.h - Fat Binary Format Definitions ------------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file provides the definitions of <mach-o/fat.h>. On Darwin hosts the
+//  SDK header is used directly; other hosts get an identical, self-contained
+//  copy.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_ABI_FAT_H
+#define DCL_BINARY_DARWIN_ABI_FAT_H
+
+#include <dcl/Basic/Basic.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+
+#if DCL_TARGET_OS_DARWIN
+
+#include <mach-o/fat.h>
+
+#else
+
+#include <cstdint>
+
+#define FAT_MAGIC 0xcafebabe
+#define FAT_CIGAM 0xbebafeca
+
+struct fat_header {
+  uint32_t magic;
+  uint32_t nfat_arch;
+};
+
+struct fat_arch {
+  cpu_type_t cputype;
+  cpu_subtype_t cpusubtype;
+  uint32_t offset;
+  uint32_t size;
+  uint32_t align;
+};
+
+#define FAT_MAGIC_64 0xcafebabf
+#define FAT_CIGAM_64 0xbfbafeca
+
+struct fat_arch_64 {
+  cpu_type_t cputype;
+  cpu_subtype_t cpusubtype;
+  uint64_t offset;
+  uint64_t size;
+  uint32_t align;
+  uint32_t reserved;
+};
+
+#endif // DCL_TARGET_OS_DARWIN
+
+#endif // DCL_BINARY_DARWIN_ABI_FAT_H
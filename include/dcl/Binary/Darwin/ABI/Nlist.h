@@ -0,0 +1,76 @@
+//===--- Nlist.h - Mach-O Symbol Table Format Definitions -------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file provides the definitions of <mach-o/nlist.h>. On Darwin hosts
+//  the SDK header is used directly; other hosts get an identical,
+//  self-contained copy.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_ABI_NLIST_H
+#define DCL_BINARY_DARWIN_ABI_NLIST_H
+
+#include <dcl/Basic/Basic.h>
+
+#if DCL_TARGET_OS_DARWIN
+
+#include <mach-o/nlist.h>
+
+#else
+
+#include <cstdint>
+
+struct nlist {
+  union {
+    uint32_t n_strx;
+  } n_un;
+  uint8_t n_type;
+  uint8_t n_sect;
+  int16_t n_desc;
+  uint32_t n_value;
+};
+
+struct nlist_64 {
+  union {
+    uint32_t n_strx;
+  } n_un;
+  uint8_t n_type;
+  uint8_t n_sect;
+  uint16_t n_desc;
+  uint64_t n_value;
+};
+
+#define N_STAB 0xe0
+#define N_PEXT 0x10
+#define N_TYPE 0x0e
+#define N_EXT  0x01
+
+#define N_UNDF 0x0
+#define N_ABS  0x2
+#define N_SECT 0xe
+#define N_PBUD 0xc
+#define N_INDR 0xa
+
+#define NO_SECT  0
+#define MAX_SECT 255
+
+#define REFERENCED_DYNAMICALLY 0x0010
+#define N_NO_DEAD_STRIP        0x0020
+#define N_WEAK_REF             0x0040
+#define N_WEAK_DEF             0x0080
+#define N_ARM_THUMB_DEF        0x0008
+#define N_ALT_ENTRY            0x0200
+
+#endif // DCL_TARGET_OS_DARWIN
+
+#endif // DCL_BINARY_DARWIN_ABI_NLIST_H
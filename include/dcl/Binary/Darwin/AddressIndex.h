@@ -0,0 +1,215 @@
+//===--- AddressIndex.h - Address Translation for Segments ------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_ADDRESSINDEX_H
+#define DCL_BINARY_DARWIN_ADDRESSINDEX_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/Utilities.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dcl::Binary::Darwin {
+
+namespace details {
+
+/// An immutable set of disjoint half-open intervals, each mapped to a
+/// `Value`. The interval starts are kept apart from the rest so that the
+/// search only touches one dense array.
+template <typename Value>
+class IntervalTable {
+
+public:
+  class Entry {
+  public:
+    uint64_t start;
+
+    uint64_t end;
+
+    Value * value;
+  };
+
+private:
+  std::vector<uint64_t> _starts;
+
+  std::vector<Entry> _entries;
+
+public:
+  /// Adds an interval. Empty intervals are ignored.
+  DCL_ALWAYS_INLINE
+  void add(uint64_t start, uint64_t size, Value * value) {
+    if (size == 0) {
+      return;
+    }
+    _entries.push_back(Entry{start, start + size, value});
+  }
+
+  /// Sorts the intervals. Must be called once after the last `add`.
+  void seal() {
+    std::stable_sort(
+      _entries.begin(), _entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.start < rhs.start;
+      });
+    _starts.resize(_entries.size());
+    for (size_t index = 0; index < _entries.size(); index++) {
+      _starts[index] = _entries[index].start;
+    }
+  }
+
+  /// The interval containing `key`, or `nullptr`.
+  DCL_ALWAYS_INLINE
+  const Entry * find(uint64_t key) const {
+    size_t index = FindLastNotGreater(_starts.data(), _starts.size(), key);
+    if (index == _starts.size() || key >= _entries[index].end) {
+      return nullptr;
+    }
+    return &_entries[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _entries.size(); }
+};
+
+} // namespace details
+
+/// Maps virtual memory addresses and file offsets of a Mach-O image to its
+/// segments and sections.
+///
+/// The index is built once from the segment commands and is immutable
+/// afterwards, so it may be shared between threads.
+template <typename Target, typename ByteOrder>
+class AddressIndex {
+
+public:
+  using PointerValueTy = typename Target::PointerValueTy;
+
+  using SegmentTy = SegmentCommand<Target, ByteOrder>;
+
+  using SectionTy = Section<Target, ByteOrder>;
+
+private:
+  details::IntervalTable<SegmentTy> _segmentsByAddress;
+
+  details::IntervalTable<SegmentTy> _segmentsByFileOffset;
+
+  details::IntervalTable<SectionTy> _sectionsByAddress;
+
+public:
+  explicit AddressIndex(const LoadCommandIndex<Target, ByteOrder>& commands) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    for (auto& eachCommand : commands.all(CommandKind::Semgent)) {
+      auto segment = reinterpret_cast<SegmentTy *>(&eachCommand);
+      _segmentsByAddress.add(
+        segment->getVirtualMemoryAddress(),
+        segment->getVirtualMemorySize(),
+        segment);
+      _segmentsByFileOffset.add(
+        segment->getFileOffset(), segment->getFileSize(), segment);
+
+      // Only index the sections that fit in the command.
+      size_t capacity = 0;
+      if (segment->getCommandSize() >= sizeof(SegmentTy)) {
+        capacity =
+          (segment->getCommandSize() - sizeof(SegmentTy)) / sizeof(SectionTy);
+      }
+      size_t sectionCount =
+        std::min<size_t>(segment->getSectionCount(), capacity);
+      auto sections = reinterpret_cast<SectionTy *>(
+        reinterpret_cast<uint8_t *>(segment) + sizeof(SegmentTy));
+      for (size_t index = 0; index < sectionCount; index++) {
+        _sectionsByAddress.add(
+          sections[index].getVirtualMemoryAddress(),
+          sections[index].getVirtualMemorySize(),
+          &sections[index]);
+      }
+    }
+    _segmentsByAddress.seal();
+    _segmentsByFileOffset.seal();
+    _sectionsByAddress.seal();
+  }
+
+#pragma mark - Lookup
+
+  /// The segment whose virtual memory range contains `address`.
+  DCL_ALWAYS_INLINE
+  SegmentTy * segmentFor(PointerValueTy address) const {
+    auto entry = _segmentsByAddress.find(address);
+    return entry ? entry->value : nullptr;
+  }
+
+  /// The segment whose file range contains `fileOffset`.
+  DCL_ALWAYS_INLINE
+  SegmentTy * segmentForFileOffset(uint64_t fileOffset) const {
+    auto entry = _segmentsByFileOffset.find(fileOffset);
+    return entry ? entry->value : nullptr;
+  }
+
+  /// The section whose virtual memory range contains `address`.
+  DCL_ALWAYS_INLINE
+  SectionTy * sectionFor(PointerValueTy address) const {
+    auto entry = _sectionsByAddress.find(address);
+    return entry ? entry->value : nullptr;
+  }
+
+#pragma mark - Translation
+
+  /// Translates `address` into a file offset. Fails for addresses outside
+  /// of any segment and for zero-fill memory past the end of a segment's
+  /// file contents.
+  DCL_ALWAYS_INLINE
+  bool vmToFileOffset(PointerValueTy address, uint64_t& fileOffset) const {
+    auto entry = _segmentsByAddress.find(address);
+    if (!entry) {
+      return false;
+    }
+    uint64_t delta = address - entry->start;
+    if (delta >= entry->value->getFileSize()) {
+      return false;
+    }
+    fileOffset = entry->value->getFileOffset() + delta;
+    return true;
+  }
+
+  /// Translates `fileOffset` into a virtual memory address. Fails for file
+  /// contents that are not mapped by any segment.
+  DCL_ALWAYS_INLINE
+  bool fileOffsetToVm(uint64_t fileOffset, PointerValueTy& address) const {
+    auto entry = _segmentsByFileOffset.find(fileOffset);
+    if (!entry) {
+      return false;
+    }
+    uint64_t delta = fileOffset - entry->start;
+    if (delta >= entry->value->getVirtualMemorySize()) {
+      return false;
+    }
+    address = static_cast<PointerValueTy>(
+      entry->value->getVirtualMemoryAddress() + delta);
+    return true;
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t getSegmentCount() const { return _segmentsByAddress.size(); }
+
+  DCL_ALWAYS_INLINE
+  size_t getSectionCount() const { return _sectionsByAddress.size(); }
+};
+
+} // namespace dcl::Binary::Darwin
+
+#endif // DCL_BINARY_DARWIN_ADDRESSINDEX_H
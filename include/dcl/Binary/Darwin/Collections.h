@@ -16,8 +16,6 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <dcl/Binary/Darwin/Iterators.h>
 #include <dcl/Binary/Darwin/Traits.h>
 
@@ -123,6 +121,4 @@ public:
 
 } // namespace dcl::Binary::Darwin
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_COLLECTIONS_H
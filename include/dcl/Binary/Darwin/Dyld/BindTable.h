@@ -0,0 +1,455 @@
+//===--- BindTable.h - Dyld Bind Opcode Interpreter -------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_BINDTABLE_H
+#define DCL_BINARY_DARWIN_DYLD_BINDTABLE_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Dyld/DyldInfo.h>
+#include <dcl/Binary/Darwin/Utilities.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// The kind of bind opcode stream. Lazy streams hold one program per lazy
+/// symbol, each ending with `Done`, so `Done` does not end them.
+enum class BindStreamKind : uint8_t {
+  Regular,
+  Weak,
+  Lazy,
+};
+
+/// The binds of one bind opcode stream, stored as a structure of arrays.
+///
+/// Symbol names are not copied: each record keeps the 32-bit offset of its
+/// name in the stream. Library ordinals are interned, so each record keeps a
+/// 16-bit index into `getLibraryOrdinals()`.
+///
+/// Streams that use `Threaded` hold no addresses for their binds. Their
+/// records instead form the ordinal table of the chained pointers that start
+/// at each of `getThreadedChainStart*()`.
+class BindTable {
+
+  friend class BindOpcodeInterpreter;
+
+private:
+  const uint8_t * _stream = nullptr;
+
+  std::vector<uint8_t> _segmentIndices;
+
+  std::vector<uint64_t> _segmentOffsets;
+
+  std::vector<uint8_t> _types;
+
+  std::vector<uint8_t> _symbolFlags;
+
+  std::vector<uint16_t> _ordinalIndices;
+
+  std::vector<uint32_t> _symbolNameOffsets;
+
+  std::vector<int64_t> _addends;
+
+  std::vector<int64_t> _libraryOrdinals;
+
+  std::vector<uint8_t> _threadedChainStartSegmentIndices;
+
+  std::vector<uint64_t> _threadedChainStartSegmentOffsets;
+
+  bool _isThreaded = false;
+
+public:
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _segmentIndices.size(); }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _segmentIndices.empty(); }
+
+  DCL_ALWAYS_INLINE
+  bool isThreaded() const { return _isThreaded; }
+
+  /// Empties the table but keeps its storage.
+  void clear() {
+    _stream = nullptr;
+    _segmentIndices.clear();
+    _segmentOffsets.clear();
+    _types.clear();
+    _symbolFlags.clear();
+    _ordinalIndices.clear();
+    _symbolNameOffsets.clear();
+    _addends.clear();
+    _libraryOrdinals.clear();
+    _threadedChainStartSegmentIndices.clear();
+    _threadedChainStartSegmentOffsets.clear();
+    _isThreaded = false;
+  }
+
+#pragma mark - Accessing Records
+
+  DCL_ALWAYS_INLINE
+  uint8_t getSegmentIndex(size_t index) const { return _segmentIndices[index]; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getSegmentOffset(size_t index) const {
+    return _segmentOffsets[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  uint8_t getType(size_t index) const { return _types[index]; }
+
+  DCL_ALWAYS_INLINE
+  uint8_t getSymbolFlags(size_t index) const { return _symbolFlags[index]; }
+
+  DCL_ALWAYS_INLINE
+  int64_t getAddend(size_t index) const { return _addends[index]; }
+
+  DCL_ALWAYS_INLINE
+  uint16_t getLibraryOrdinalIndex(size_t index) const {
+    return _ordinalIndices[index];
+  }
+
+  /// The library ordinal, which may be one of `BIND_SPECIAL_DYLIB_*`.
+  DCL_ALWAYS_INLINE
+  int64_t getLibraryOrdinal(size_t index) const {
+    return _libraryOrdinals[_ordinalIndices[index]];
+  }
+
+  /// The offset of the symbol name from the start of the stream.
+  DCL_ALWAYS_INLINE
+  uint32_t getSymbolNameOffset(size_t index) const {
+    return _symbolNameOffsets[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  std::string_view getSymbolName(size_t index) const {
+    return reinterpret_cast<const char *>(_stream + _symbolNameOffsets[index]);
+  }
+
+  /// The distinct library ordinals in order of first use.
+  DCL_ALWAYS_INLINE
+  const std::vector<int64_t>& getLibraryOrdinals() const {
+    return _libraryOrdinals;
+  }
+
+#pragma mark - Threaded Binds
+
+  DCL_ALWAYS_INLINE
+  size_t getThreadedChainStartCount() const {
+    return _threadedChainStartSegmentIndices.size();
+  }
+
+  DCL_ALWAYS_INLINE
+  uint8_t getThreadedChainStartSegmentIndex(size_t index) const {
+    return _threadedChainStartSegmentIndices[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getThreadedChainStartSegmentOffset(size_t index) const {
+    return _threadedChainStartSegmentOffsets[index];
+  }
+};
+
+/// Executes bind opcode streams into `BindTable`s.
+class BindOpcodeInterpreter {
+
+public:
+  /// Records keep 16-bit indices into the library ordinals.
+  DCL_CONSTEXPR
+  static const size_t kMaxLibraryOrdinalCount = 0x10000;
+
+private:
+  uint32_t _pointerSize;
+
+  /// Binds outside of these segments are rejected before they are recorded.
+  SegmentSizes _segments;
+
+  /// The ordinal interned last, which most records share.
+  int64_t _lastOrdinal;
+
+  uint16_t _lastOrdinalIndex;
+
+  /// The index of each interned ordinal in the table.
+  std::unordered_map<int64_t, uint16_t> _ordinalIndices;
+
+public:
+  /// Interprets the streams of an image with `segments`.
+  DCL_ALWAYS_INLINE
+  BindOpcodeInterpreter(uint32_t pointerSize, SegmentSizes segments)
+    : _pointerSize(pointerSize), _segments(std::move(segments)),
+      _lastOrdinal(0), _lastOrdinalIndex(0) {}
+
+  /// Replaces the contents of `table` with the binds of the stream in
+  /// [`begin`, `end`). Returns false if the stream is malformed or binds
+  /// outside of its segments, in which case `table` holds the binds decoded
+  /// so far.
+  bool interpret(
+    const uint8_t * begin,
+    const uint8_t * end,
+    BindStreamKind kind,
+    BindTable& table) {
+    table.clear();
+    table._stream = begin;
+    table._libraryOrdinals.push_back(0);
+    _lastOrdinal = 0;
+    _lastOrdinalIndex = 0;
+    _ordinalIndices.clear();
+    _ordinalIndices.emplace(0, 0);
+
+    uint8_t segmentIndex = 0;
+    uint64_t segmentOffset = 0;
+    uint8_t type = kind == BindStreamKind::Lazy ? BIND_TYPE_POINTER : 0;
+    uint8_t symbolFlags = 0;
+    uint16_t ordinalIndex = 0;
+    uint32_t symbolNameOffset = 0;
+    bool hasSymbolName = false;
+    int64_t addend = 0;
+
+    auto bind = [&]() -> bool {
+      if (
+        !hasSymbolName ||
+        !_segments.contains(segmentIndex, segmentOffset, _pointerSize)) {
+        return false;
+      }
+      table._segmentIndices.push_back(segmentIndex);
+      table._segmentOffsets.push_back(segmentOffset);
+      table._types.push_back(type);
+      table._symbolFlags.push_back(symbolFlags);
+      table._ordinalIndices.push_back(ordinalIndex);
+      table._symbolNameOffsets.push_back(symbolNameOffset);
+      table._addends.push_back(addend);
+      return true;
+    };
+
+    const uint8_t * p = begin;
+    while (p < end) {
+      BindOpcode opcode{*p++};
+      uint8_t immediate = opcode.getImmediate();
+      switch (opcode.getKind()) {
+      case BindOpcode::Kind::Done:
+        if (kind != BindStreamKind::Lazy) {
+          return true;
+        }
+        break;
+      case BindOpcode::Kind::SetDylibOrdinalWithImmediate:
+        if (!intern(table, immediate, ordinalIndex)) {
+          return false;
+        }
+        break;
+      case BindOpcode::Kind::SetDylibOrdinalWithUleb: {
+        uint64_t ordinal = 0;
+        if (
+          !tryReadUleb128(p, end, ordinal) ||
+          !intern(table, static_cast<int64_t>(ordinal), ordinalIndex)) {
+          return false;
+        }
+        break;
+      }
+      case BindOpcode::Kind::SetDylibOrdinalWithNegativeImmediate:
+        // The immediate is the low nibble of a negative 8-bit ordinal.
+        if (!intern(
+              table,
+              immediate == 0
+                ? 0
+                : static_cast<int8_t>(BIND_OPCODE_MASK | immediate),
+              ordinalIndex)) {
+          return false;
+        }
+        break;
+      case BindOpcode::Kind::SetSymbolTrailingFlagsWithImmediate:
+        symbolFlags = immediate;
+        symbolNameOffset = static_cast<uint32_t>(p - begin);
+        while (p < end && *p != '\0') {
+          p++;
+        }
+        if (p == end) {
+          return false;
+        }
+        p++;
+        hasSymbolName = true;
+        break;
+      case BindOpcode::Kind::SetTypeWithImmediate:
+        type = immediate;
+        break;
+      case BindOpcode::Kind::SetAddendWithSleb:
+        if (!tryReadSleb128(p, end, addend)) {
+          return false;
+        }
+        break;
+      case BindOpcode::Kind::SetSegmentAndOffsetUleb:
+        segmentIndex = immediate;
+        if (!tryReadUleb128(p, end, segmentOffset)) {
+          return false;
+        }
+        break;
+      case BindOpcode::Kind::AddAddressUleb: {
+        uint64_t delta = 0;
+        if (!tryReadUleb128(p, end, delta)) {
+          return false;
+        }
+        segmentOffset += delta;
+        break;
+      }
+      case BindOpcode::Kind::DoBind:
+        if (!bind()) {
+          return false;
+        }
+        if (!table._isThreaded) {
+          segmentOffset += _pointerSize;
+        }
+        break;
+      case BindOpcode::Kind::DoBindAddAddressUleb: {
+        uint64_t delta = 0;
+        if (!bind() || !tryReadUleb128(p, end, delta)) {
+          return false;
+        }
+        segmentOffset += delta + _pointerSize;
+        break;
+      }
+      case BindOpcode::Kind::DoBindAddAddressImmediateScaled:
+        if (!bind()) {
+          return false;
+        }
+        segmentOffset += uint64_t(immediate) * _pointerSize + _pointerSize;
+        break;
+      case BindOpcode::Kind::DoBindUlebTimesSkippingUleb: {
+        uint64_t count = 0;
+        uint64_t skip = 0;
+        // Checked up front, so that no record is added for a run that ends
+        // out of the segment.
+        if (
+          !tryReadUleb128(p, end, count) || !tryReadUleb128(p, end, skip) ||
+          !_segments.contains(
+            segmentIndex, segmentOffset, _pointerSize, count, skip)) {
+          return false;
+        }
+        for (uint64_t index = 0; index < count; index++) {
+          if (!bind()) {
+            return false;
+          }
+          segmentOffset += skip + _pointerSize;
+        }
+        break;
+      }
+      case BindOpcode::Kind::Threaded:
+        switch (BindOpcode::SubOpcode(immediate)) {
+        case BindOpcode::SubOpcode::SetBindOrdinalTableSizeUleb: {
+          uint64_t tableSize = 0;
+          if (!tryReadUleb128(p, end, tableSize)) {
+            return false;
+          }
+          table._isThreaded = true;
+          reserve(table, tableSize);
+          break;
+        }
+        case BindOpcode::SubOpcode::Apply:
+          if (!_segments.contains(segmentIndex, segmentOffset, _pointerSize)) {
+            return false;
+          }
+          table._threadedChainStartSegmentIndices.push_back(segmentIndex);
+          table._threadedChainStartSegmentOffsets.push_back(segmentOffset);
+          break;
+        default:
+          return false;
+        }
+        break;
+      default:
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Runs the stream of `kind` described by `command` of the image at
+  /// `image`, which must be `imageSize` bytes long.
+  template <typename Target, typename ByteOrder>
+  bool interpret(
+    const void * image,
+    size_t imageSize,
+    const DyldInfoCommand<Target, ByteOrder>& command,
+    BindStreamKind kind,
+    BindTable& table) {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    switch (kind) {
+    case BindStreamKind::Regular:
+      offset = command.getBindingInfoOffset();
+      size = command.getBindingInfoSize();
+      break;
+    case BindStreamKind::Weak:
+      offset = command.getWeakBindingInfoOffset();
+      size = command.getWeakBindingInfoSize();
+      break;
+    case BindStreamKind::Lazy:
+      offset = command.getLazyBindingInfoOffset();
+      size = command.getLazyBindingInfoSize();
+      break;
+    }
+    if (offset > imageSize || size > imageSize - offset) {
+      table.clear();
+      return false;
+    }
+    auto begin = static_cast<const uint8_t *>(image) + offset;
+    return interpret(begin, begin + size, kind, table);
+  }
+
+private:
+  /// Stores the index of `ordinal` in `table` to `index`, adding it if it is
+  /// new. Fails once the indices run out.
+  DCL_ALWAYS_INLINE
+  bool intern(BindTable& table, int64_t ordinal, uint16_t& index) {
+    if (ordinal == _lastOrdinal) {
+      index = _lastOrdinalIndex;
+      return true;
+    }
+    auto& ordinals = table._libraryOrdinals;
+    auto found = _ordinalIndices.find(ordinal);
+    if (found == _ordinalIndices.end()) {
+      if (ordinals.size() >= kMaxLibraryOrdinalCount) {
+        return false;
+      }
+      found = _ordinalIndices
+                .emplace(ordinal, static_cast<uint16_t>(ordinals.size()))
+                .first;
+      ordinals.push_back(ordinal);
+    }
+    _lastOrdinal = ordinal;
+    _lastOrdinalIndex = found->second;
+    index = _lastOrdinalIndex;
+    return true;
+  }
+
+  DCL_ALWAYS_INLINE
+  static void reserve(BindTable& table, uint64_t count) {
+    // Bound the hint so that a corrupt stream cannot exhaust memory.
+    size_t capacity = static_cast<size_t>(count < 0x10000 ? count : 0x10000);
+    table._segmentIndices.reserve(capacity);
+    table._segmentOffsets.reserve(capacity);
+    table._types.reserve(capacity);
+    table._symbolFlags.reserve(capacity);
+    table._ordinalIndices.reserve(capacity);
+    table._symbolNameOffsets.reserve(capacity);
+    table._addends.reserve(capacity);
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_BINDTABLE_H
@@ -0,0 +1,149 @@
+//===--- ChainedAuthTable.h - Authenticated Chained Pointers ----*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_CHAINEDAUTHTABLE_H
+#define DCL_BINARY_DARWIN_DYLD_CHAINEDAUTHTABLE_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupWalker.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// The arm64e pointer authentication keys.
+enum class PointerAuthKey : uint8_t {
+  IA = 0,
+  IB = 1,
+  DA = 2,
+  DB = 3,
+};
+
+/// How an authenticated chained pointer is signed at load time.
+class ChainedAuthEntry {
+public:
+  uint64_t segmentOffset;
+
+  /// The target of a rebase as an offset from the load address, or the
+  /// import index of a bind.
+  uint64_t target;
+
+  uint32_t segmentIndex;
+
+  uint16_t diversity;
+
+  PointerAuthKey key;
+
+  bool hasAddressDiversity : 1;
+
+  bool isBind : 1;
+
+  /// The discriminator the pointer is signed with when its location is
+  /// loaded at `address`.
+  DCL_ALWAYS_INLINE
+  uint64_t getDiscriminator(uint64_t address) const {
+    if (!hasAddressDiversity) {
+      return diversity;
+    }
+    return (address & 0x0000FFFFFFFFFFFF) | (uint64_t(diversity) << 48);
+  }
+};
+
+/// The authenticated pointers of the fixup chains of an image, sorted by
+/// location.
+///
+/// Applying fixups outside of the target process can only produce stripped
+/// pointers, so this is where the signing schema of each of them is kept.
+class ChainedAuthTable {
+
+private:
+  std::vector<ChainedAuthEntry> _entries;
+
+public:
+  /// Replaces the contents of the table with the authenticated pointers
+  /// `walker` visits. Returns false if a chain is malformed.
+  template <typename Target, typename ByteOrder>
+  bool build(const ChainedFixupWalker<Target, ByteOrder>& walker) {
+    _entries.clear();
+    bool isValid = walker.forEach([&](const ChainedFixup& fixup) {
+      if (!fixup.isAuth) {
+        return;
+      }
+      ChainedAuthEntry entry;
+      entry.segmentOffset = fixup.segmentOffset;
+      entry.segmentIndex = fixup.segmentIndex;
+      entry.diversity = fixup.diversity;
+      entry.key = static_cast<PointerAuthKey>(fixup.key);
+      entry.hasAddressDiversity = fixup.hasAddressDiversity;
+      entry.isBind = fixup.kind == ChainedFixupKind::Bind;
+      entry.target = entry.isBind ? fixup.ordinal : fixup.target;
+      _entries.push_back(entry);
+    });
+    // Pages with several chains are visited one chain after another.
+    std::sort(_entries.begin(), _entries.end(), &lessThan);
+    return isValid;
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _entries.size(); }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _entries.empty(); }
+
+  DCL_ALWAYS_INLINE
+  const ChainedAuthEntry& operator[](size_t index) const {
+    return _entries[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  const ChainedAuthEntry * begin() const { return _entries.data(); }
+
+  DCL_ALWAYS_INLINE
+  const ChainedAuthEntry * end() const {
+    return _entries.data() + _entries.size();
+  }
+
+  /// The authenticated pointer at `segmentOffset` of `segmentIndex`, or
+  /// `nullptr` if the location does not hold one.
+  const ChainedAuthEntry *
+  find(uint32_t segmentIndex, uint64_t segmentOffset) const {
+    ChainedAuthEntry key{};
+    key.segmentIndex = segmentIndex;
+    key.segmentOffset = segmentOffset;
+    auto found = std::lower_bound(begin(), end(), key, &lessThan);
+    if (
+      found == end() || found->segmentIndex != segmentIndex ||
+      found->segmentOffset != segmentOffset) {
+      return nullptr;
+    }
+    return found;
+  }
+
+private:
+  DCL_ALWAYS_INLINE
+  static bool
+  lessThan(const ChainedAuthEntry& lhs, const ChainedAuthEntry& rhs) {
+    if (lhs.segmentIndex != rhs.segmentIndex) {
+      return lhs.segmentIndex < rhs.segmentIndex;
+    }
+    return lhs.segmentOffset < rhs.segmentOffset;
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_CHAINEDAUTHTABLE_H
@@ -0,0 +1,207 @@
+//===--- ChainedFixupApplier.h - Chained Fixup Application ------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPAPPLIER_H
+#define DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPAPPLIER_H
+
+#include <dcl/Basic/Basic.h>
+#include <dcl/Basic/ThreadPool.h>
+
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupWalker.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// Rebases and binds a copy of an image as if it were loaded at a chosen
+/// address, the way dyld would, except that authenticated pointers are not
+/// signed.
+///
+/// The chains are read from the image the walker walks and the results are
+/// written into a separate copy of it, for example a `IO::File` mapped with
+/// `IO::MappingOptions::Private`, so that the image itself is never
+/// modified. Every page has chains of its own, hence pages are fixed up
+/// independently of each other and may be spread over several threads.
+template <typename Target, typename ByteOrder>
+class ChainedFixupApplier {
+
+public:
+  using WalkerTy = ChainedFixupWalker<Target, ByteOrder>;
+
+  class Page {
+  public:
+    uint32_t segmentIndex;
+
+    uint32_t pageIndex;
+  };
+
+private:
+  const WalkerTy& _walker;
+
+  const uint8_t * _image;
+
+  uint64_t _loadAddress;
+
+  const uint64_t * _bindTargets;
+
+  size_t _bindTargetCount;
+
+  bool _stripsAuthenticatedPointers;
+
+  std::vector<Page> _pages;
+
+public:
+  /// `image` is the start of the image `walker` walks.
+  ChainedFixupApplier(
+    const WalkerTy& walker, const void * image, uint64_t loadAddress)
+    : _walker(walker), _image(static_cast<const uint8_t *>(image)),
+      _loadAddress(loadAddress), _bindTargets(nullptr), _bindTargetCount(0),
+      _stripsAuthenticatedPointers(true) {
+    for (size_t segment = 0; segment < walker.getSegmentCount(); segment++) {
+      auto starts = walker.getStartsInSegment(segment);
+      if (!starts) {
+        continue;
+      }
+      for (size_t page = 0; page < starts->getPageCount(); page++) {
+        if (starts->getPageStartAtIndex(page) != DYLD_CHAINED_PTR_START_NONE) {
+          _pages.push_back(Page{
+            static_cast<uint32_t>(segment), static_cast<uint32_t>(page)});
+        }
+      }
+    }
+  }
+
+  ChainedFixupApplier(const ChainedFixupApplier&) = delete;
+
+  ChainedFixupApplier& operator=(const ChainedFixupApplier&) = delete;
+
+  /// Binds to `targets[ordinal]` plus the addend of the bind. The targets
+  /// must outlive the applier.
+  DCL_ALWAYS_INLINE
+  void setBindTargets(const uint64_t * targets, size_t count) {
+    _bindTargets = targets;
+    _bindTargetCount = count;
+  }
+
+  /// Whether authenticated pointers are replaced by their unsigned targets,
+  /// which is the default. Otherwise they are left encoded as they are in
+  /// the image, and `ChainedAuthTable` can tell how to sign them.
+  DCL_ALWAYS_INLINE
+  void setStripsAuthenticatedPointers(bool strips) {
+    _stripsAuthenticatedPointers = strips;
+  }
+
+  DCL_ALWAYS_INLINE
+  bool stripsAuthenticatedPointers() const {
+    return _stripsAuthenticatedPointers;
+  }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getLoadAddress() const { return _loadAddress; }
+
+  /// The number of pages with chains.
+  DCL_ALWAYS_INLINE
+  size_t getPageCount() const { return _pages.size(); }
+
+  DCL_ALWAYS_INLINE
+  const Page& getPage(size_t index) const { return _pages[index]; }
+
+  /// Fixes up page `index` in `copy`, which must have the same layout as the
+  /// image. Fails for malformed chains and for binds without a target.
+  bool applyPage(void * copy, size_t index) const {
+    const Page& page = _pages[index];
+    auto segment = _walker.getSegment(page.segmentIndex);
+    if (!segment || !segment->data) {
+      return false;
+    }
+    uint8_t * destination =
+      static_cast<uint8_t *>(copy) + (segment->data - _image);
+    bool isValid = true;
+    bool isWalked = _walker.forEachInPage(
+      page.segmentIndex, page.pageIndex, [&](const ChainedFixup& fixup) {
+        if (fixup.isAuth && !_stripsAuthenticatedPointers) {
+          return;
+        }
+        uint64_t value = 0;
+        if (!resolve(fixup, value)) {
+          isValid = false;
+          return;
+        }
+        store(destination + fixup.segmentOffset, fixup.size, value);
+      });
+    return isWalked && isValid;
+  }
+
+  /// Fixes up every page in `copy` with up to `threadCount` threads of the
+  /// shared `ThreadPool`, the calling one included. Zero picks every thread
+  /// of the pool.
+  bool apply(void * copy, unsigned threadCount = 0) const {
+    std::atomic<bool> isValid{true};
+    ThreadPool::getShared().forEachIndex(
+      _pages.size(),
+      [&](size_t index) {
+        if (!isValid.load(std::memory_order_relaxed)) {
+          return;
+        }
+        if (!applyPage(copy, index)) {
+          isValid.store(false, std::memory_order_relaxed);
+        }
+      },
+      threadCount);
+    return isValid.load();
+  }
+
+private:
+  DCL_ALWAYS_INLINE
+  bool resolve(const ChainedFixup& fixup, uint64_t& value) const {
+    switch (fixup.kind) {
+    case ChainedFixupKind::Rebase:
+      value = _loadAddress + fixup.target;
+      if (!fixup.isAuth) {
+        value |= uint64_t(fixup.high8) << 56;
+      }
+      return true;
+    case ChainedFixupKind::Bind:
+      if (fixup.ordinal >= _bindTargetCount) {
+        return false;
+      }
+      value = _bindTargets[fixup.ordinal] + fixup.addend;
+      return true;
+    case ChainedFixupKind::NonPointer:
+      value = fixup.target;
+      return true;
+    }
+    return false;
+  }
+
+  DCL_ALWAYS_INLINE
+  static void store(uint8_t * location, uint8_t size, uint64_t value) {
+    if (size == sizeof(uint32_t)) {
+      uint32_t narrow = ByteOrder::swapFromHost(static_cast<uint32_t>(value));
+      std::memcpy(location, &narrow, sizeof(narrow));
+      return;
+    }
+    value = ByteOrder::swapFromHost(value);
+    std::memcpy(location, &value, sizeof(value));
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPAPPLIER_H
@@ -0,0 +1,625 @@
+//===--- ChainedFixupWalker.h - Dyld Chained Fixup Walker -------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  Every segment of an image with chained fixups has a start for each of its
+//  pages. A start is the page offset of the first location of a chain, and
+//  every location of a chain holds the distance to the next one in its
+//  `next` bits, in units of the stride of the pointer format. The pointer
+//  format is per segment, so the walker dispatches on it once per segment
+//  and then runs a loop specialized for that format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPWALKER_H
+#define DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPWALKER_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Dyld/DyldFixupChains.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+enum class ChainedFixupKind : uint8_t {
+  Rebase,
+  Bind,
+  /// A 32-bit value in a chain that is not a pointer. Its location has to be
+  /// overwritten with `target`.
+  NonPointer,
+};
+
+/// A location of a fixup chain, decoded independently of its format.
+class ChainedFixup {
+public:
+  using Kind = ChainedFixupKind;
+
+  Kind kind;
+
+  bool isAuth;
+
+  bool hasAddressDiversity;
+
+  uint8_t key;
+
+  uint16_t diversity;
+
+  /// The top byte of a rebased pointer.
+  uint8_t high8;
+
+  /// The kernel collection the target of a kernel cache rebase is in.
+  uint8_t cacheLevel;
+
+  /// The size of the location, either 4 or 8 bytes.
+  uint8_t size;
+
+  uint32_t segmentIndex;
+
+  uint64_t segmentOffset;
+
+  /// The target of a rebase as an offset from the preferred load address,
+  /// or from the cache base for cache formats. The value to store for a
+  /// non-pointer.
+  uint64_t target;
+
+  uint32_t ordinal;
+
+  int64_t addend;
+
+  /// The contents of the location in host byte order.
+  uint64_t rawValue;
+};
+
+namespace details {
+
+class ChainedFixupContext {
+public:
+  uint64_t preferredLoadAddress;
+
+  uint32_t maxValidPointer;
+};
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static int64_t SignExtendChainedAddend(uint64_t value, unsigned bits) {
+  uint64_t sign = uint64_t(1) << (bits - 1);
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+/// Describes how a chained pointer format is laid out. `kStride` is the unit
+/// of the `next` bits, `getNext` extracts them and `decode` fills in a fixup
+/// from the contents of a location.
+template <ChainedPointerFormat Format>
+class ChainedPointerFormatTraits;
+
+template <bool IsTargetOffset>
+class ChainedPointer64FormatTraits {
+public:
+  using StorageTy = uint64_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = 4;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return (raw >> 51) & 0xFFF; }
+
+  DCL_ALWAYS_INLINE
+  static void decode(
+    StorageTy raw, const ChainedFixupContext& context, ChainedFixup& fixup) {
+    if (raw >> 63) {
+      fixup.kind = ChainedFixupKind::Bind;
+      fixup.ordinal = raw & 0xFFFFFF;
+      fixup.addend = (raw >> 24) & 0xFF;
+      return;
+    }
+    fixup.kind = ChainedFixupKind::Rebase;
+    fixup.target = raw & 0xFFFFFFFFF;
+    fixup.high8 = (raw >> 36) & 0xFF;
+    if (!IsTargetOffset) {
+      fixup.target -= context.preferredLoadAddress;
+    }
+  }
+};
+
+template <uint32_t Stride, bool IsTargetOffset, unsigned OrdinalBits>
+class ChainedPointerArm64EFormatTraits {
+public:
+  using StorageTy = uint64_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = Stride;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return (raw >> 51) & 0x7FF; }
+
+  DCL_ALWAYS_INLINE
+  static void decode(
+    StorageTy raw, const ChainedFixupContext& context, ChainedFixup& fixup) {
+    bool isBind = (raw >> 62) & 1;
+    fixup.isAuth = raw >> 63;
+    if (fixup.isAuth) {
+      fixup.diversity = (raw >> 32) & 0xFFFF;
+      fixup.hasAddressDiversity = (raw >> 48) & 1;
+      fixup.key = (raw >> 49) & 0x3;
+    }
+    if (isBind) {
+      fixup.kind = ChainedFixupKind::Bind;
+      fixup.ordinal = raw & ((uint64_t(1) << OrdinalBits) - 1);
+      if (!fixup.isAuth) {
+        fixup.addend = SignExtendChainedAddend((raw >> 32) & 0x7FFFF, 19);
+      }
+      return;
+    }
+    fixup.kind = ChainedFixupKind::Rebase;
+    if (fixup.isAuth) {
+      // Authenticated rebase targets are always offsets.
+      fixup.target = raw & 0xFFFFFFFF;
+      return;
+    }
+    fixup.target = raw & 0x7FFFFFFFFFF;
+    fixup.high8 = (raw >> 43) & 0xFF;
+    if (!IsTargetOffset) {
+      fixup.target -= context.preferredLoadAddress;
+    }
+  }
+};
+
+template <uint32_t Stride>
+class ChainedPointerKernelCacheFormatTraits {
+public:
+  using StorageTy = uint64_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = Stride;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return (raw >> 51) & 0xFFF; }
+
+  DCL_ALWAYS_INLINE
+  static void
+  decode(StorageTy raw, const ChainedFixupContext&, ChainedFixup& fixup) {
+    fixup.kind = ChainedFixupKind::Rebase;
+    fixup.target = raw & 0x3FFFFFFF;
+    fixup.cacheLevel = (raw >> 30) & 0x3;
+    fixup.isAuth = raw >> 63;
+    if (fixup.isAuth) {
+      fixup.diversity = (raw >> 32) & 0xFFFF;
+      fixup.hasAddressDiversity = (raw >> 48) & 1;
+      fixup.key = (raw >> 49) & 0x3;
+    }
+  }
+};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic32> {
+public:
+  using StorageTy = uint32_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = 4;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return (raw >> 26) & 0x1F; }
+
+  DCL_ALWAYS_INLINE
+  static void decode(
+    StorageTy raw, const ChainedFixupContext& context, ChainedFixup& fixup) {
+    if (raw >> 31) {
+      fixup.kind = ChainedFixupKind::Bind;
+      fixup.ordinal = raw & 0xFFFFF;
+      fixup.addend = (raw >> 20) & 0x3F;
+      return;
+    }
+    uint32_t target = raw & 0x3FFFFFF;
+    if (context.maxValidPointer != 0 && target > context.maxValidPointer) {
+      // Values above the greatest valid pointer are biased scalars.
+      uint32_t bias = (0x04000000 + context.maxValidPointer) / 2;
+      fixup.kind = ChainedFixupKind::NonPointer;
+      fixup.target = uint32_t(target - bias);
+      return;
+    }
+    fixup.kind = ChainedFixupKind::Rebase;
+    fixup.target = target - context.preferredLoadAddress;
+  }
+};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic32Cache> {
+public:
+  using StorageTy = uint32_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = 4;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return raw >> 30; }
+
+  DCL_ALWAYS_INLINE
+  static void
+  decode(StorageTy raw, const ChainedFixupContext&, ChainedFixup& fixup) {
+    fixup.kind = ChainedFixupKind::Rebase;
+    fixup.target = raw & 0x3FFFFFFF;
+  }
+};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic32Firmware> {
+public:
+  using StorageTy = uint32_t;
+
+  DCL_CONSTEXPR
+  static const uint32_t kStride = 4;
+
+  DCL_ALWAYS_INLINE
+  static uint32_t getNext(StorageTy raw) { return raw >> 26; }
+
+  DCL_ALWAYS_INLINE
+  static void decode(
+    StorageTy raw, const ChainedFixupContext& context, ChainedFixup& fixup) {
+    fixup.kind = ChainedFixupKind::Rebase;
+    fixup.target = (raw & 0x3FFFFFF) - context.preferredLoadAddress;
+  }
+};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic64>
+  : public ChainedPointer64FormatTraits<false> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic64Offset>
+  : public ChainedPointer64FormatTraits<true> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Generic64KernelCache>
+  : public ChainedPointerKernelCacheFormatTraits<4> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::X86_64KernelCache>
+  : public ChainedPointerKernelCacheFormatTraits<1> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Arm64E>
+  : public ChainedPointerArm64EFormatTraits<8, false, 16> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Arm64EFirmware>
+  : public ChainedPointerArm64EFormatTraits<4, false, 16> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Arm64EKernal>
+  : public ChainedPointerArm64EFormatTraits<4, true, 16> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Arm64EUserland>
+  : public ChainedPointerArm64EFormatTraits<8, true, 16> {};
+
+template <>
+class ChainedPointerFormatTraits<ChainedPointerFormat::Arm64EUserland24>
+  : public ChainedPointerArm64EFormatTraits<8, true, 24> {};
+
+} // namespace details
+
+/// Walks the fixup chains described by the `LC_DYLD_CHAINED_FIXUPS` payload
+/// of an image.
+///
+/// The walker only reads the image, so it may be shared between threads,
+/// and separate pages may be walked concurrently.
+template <typename Target, typename ByteOrder>
+class ChainedFixupWalker {
+
+public:
+  using HeaderTy = ChainedFixupsHeader<Target, ByteOrder>;
+
+  using StartsInImageTy = ChainedStartsInImage<Target, ByteOrder>;
+
+  using StartsInSegmentTy = ChainedStartsInSegment<Target, ByteOrder>;
+
+  /// The contents of a segment in the file.
+  class Segment {
+  public:
+    const uint8_t * data;
+
+    uint64_t size;
+  };
+
+private:
+  const uint8_t * _begin;
+
+  const uint8_t * _end;
+
+  uint64_t _preferredLoadAddress;
+
+  std::vector<Segment> _segments;
+
+  std::vector<const StartsInSegmentTy *> _starts;
+
+public:
+  /// Walks the payload in [`begin`, `end`). `segments` are the contents of
+  /// the segments in load command order.
+  ChainedFixupWalker(
+    const uint8_t * begin,
+    const uint8_t * end,
+    std::vector<Segment> segments,
+    uint64_t preferredLoadAddress)
+    : _begin(begin), _end(end), _preferredLoadAddress(preferredLoadAddress),
+      _segments(std::move(segments)) {
+    initialize();
+  }
+
+  /// Walks the chained fixups of the image indexed by `commands`, which must
+  /// be `imageSize` bytes long.
+  ChainedFixupWalker(
+    const LoadCommandIndex<Target, ByteOrder>& commands, size_t imageSize)
+    : _begin(nullptr), _end(nullptr), _preferredLoadAddress(0) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    auto image = reinterpret_cast<const uint8_t *>(commands.getHeader());
+    for (auto& eachCommand : commands.all(CommandKind::Semgent)) {
+      auto segment =
+        reinterpret_cast<const SegmentCommand<Target, ByteOrder> *>(
+          &eachCommand);
+      uint64_t offset = segment->getFileOffset();
+      uint64_t size = segment->getFileSize();
+      if (offset > imageSize || size > imageSize - offset) {
+        _segments.push_back(Segment{nullptr, 0});
+        continue;
+      }
+      if (offset == 0 && size != 0) {
+        _preferredLoadAddress = segment->getVirtualMemoryAddress();
+      }
+      _segments.push_back(Segment{image + offset, size});
+    }
+    if (auto command = commands.template first<LinkEditDataCommand>(
+          CommandKind::DyldChainedFixups)) {
+      uint64_t offset = command->getDataOffset();
+      uint64_t size = command->getDataSize();
+      if (offset <= imageSize && size <= imageSize - offset) {
+        _begin = image + offset;
+        _end = _begin + size;
+      }
+    }
+    initialize();
+  }
+
+  /// Whether there are no valid chained fixups to walk.
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _starts.empty(); }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getPreferredLoadAddress() const { return _preferredLoadAddress; }
+
+  DCL_ALWAYS_INLINE
+  const HeaderTy * getHeader() const {
+    return empty() ? nullptr : reinterpret_cast<const HeaderTy *>(_begin);
+  }
+
+  /// The number of segments in the payload.
+  DCL_ALWAYS_INLINE
+  size_t getSegmentCount() const { return _starts.size(); }
+
+  /// The contents of `segmentIndex`, or `nullptr` if it is out of range.
+  DCL_ALWAYS_INLINE
+  const Segment * getSegment(size_t segmentIndex) const {
+    return segmentIndex < _segments.size() ? &_segments[segmentIndex] : nullptr;
+  }
+
+  /// The starts of `segmentIndex`, or `nullptr` if it has no fixups.
+  DCL_ALWAYS_INLINE
+  const StartsInSegmentTy * getStartsInSegment(size_t segmentIndex) const {
+    return segmentIndex < _starts.size() ? _starts[segmentIndex] : nullptr;
+  }
+
+#pragma mark - Walking
+
+  /// Calls `visitor(const ChainedFixup&)` for each location of every chain.
+  /// Returns false if a chain is malformed, after visiting the locations
+  /// before it.
+  template <typename Visitor>
+  bool forEach(Visitor&& visitor) const {
+    for (size_t index = 0; index < _starts.size(); index++) {
+      if (!forEachInSegment(index, visitor)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename Visitor>
+  bool forEachInSegment(size_t segmentIndex, Visitor&& visitor) const {
+    auto starts = getStartsInSegment(segmentIndex);
+    if (!starts) {
+      return true;
+    }
+    return walkPages(segmentIndex, 0, starts->getPageCount(), visitor);
+  }
+
+  template <typename Visitor>
+  bool forEachInPage(
+    size_t segmentIndex, size_t pageIndex, Visitor&& visitor) const {
+    auto starts = getStartsInSegment(segmentIndex);
+    if (!starts || pageIndex >= starts->getPageCount()) {
+      return true;
+    }
+    return walkPages(segmentIndex, pageIndex, pageIndex + 1, visitor);
+  }
+
+private:
+  void initialize() {
+    size_t size = _end - _begin;
+    if (!_begin || size < sizeof(typename HeaderTy::WrappedTy)) {
+      return;
+    }
+    auto header = reinterpret_cast<const HeaderTy *>(_begin);
+    uint64_t startsOffset = header->getStartsOffset();
+    if (startsOffset > size || size - startsOffset < sizeof(uint32_t)) {
+      return;
+    }
+    auto startsInImage =
+      reinterpret_cast<const StartsInImageTy *>(_begin + startsOffset);
+    uint64_t segmentCount = startsInImage->getSegmentCount();
+    if ((size - startsOffset) / sizeof(uint32_t) - 1 < segmentCount) {
+      return;
+    }
+
+    const size_t startsHeaderSize =
+      offsetof(typename StartsInSegmentTy::WrappedTy, page_start);
+    std::vector<const StartsInSegmentTy *> starts(segmentCount, nullptr);
+    for (uint32_t index = 0; index < segmentCount; index++) {
+      uint64_t offset = startsInImage->getSegmentInfoOffsetAtIndex(index);
+      if (offset == 0) {
+        continue;
+      }
+      offset += startsOffset;
+      if (offset > size || size - offset < startsHeaderSize) {
+        return;
+      }
+      auto startsInSegment =
+        reinterpret_cast<const StartsInSegmentTy *>(_begin + offset);
+      uint64_t startsSize = startsInSegment->getSize();
+      if (
+        startsSize > size - offset || startsSize < startsHeaderSize ||
+        (startsSize - startsHeaderSize) / sizeof(uint16_t) <
+          startsInSegment->getPageCount() ||
+        startsInSegment->getPageSize() == 0) {
+        return;
+      }
+      starts[index] = startsInSegment;
+    }
+    _starts = std::move(starts);
+  }
+
+  template <typename Visitor>
+  bool walkPages(
+    size_t segmentIndex,
+    size_t pageBegin,
+    size_t pageEnd,
+    Visitor& visitor) const {
+    switch (_starts[segmentIndex]->getPointerFormat()) {
+#define DCL_CHAINED_POINTER_FORMAT_CASE(FORMAT)                                \
+  case ChainedPointerFormat::FORMAT:                                           \
+    return walkPagesOfFormat<ChainedPointerFormat::FORMAT>(                    \
+      segmentIndex, pageBegin, pageEnd, visitor);
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic32)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic32Cache)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic32Firmware)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic64)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic64KernelCache)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Generic64Offset)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Arm64E)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Arm64EFirmware)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Arm64EKernal)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Arm64EUserland24)
+      DCL_CHAINED_POINTER_FORMAT_CASE(Arm64EUserland)
+      DCL_CHAINED_POINTER_FORMAT_CASE(X86_64KernelCache)
+#undef DCL_CHAINED_POINTER_FORMAT_CASE
+    }
+    return false;
+  }
+
+  template <ChainedPointerFormat Format, typename Visitor>
+  bool walkPagesOfFormat(
+    size_t segmentIndex,
+    size_t pageBegin,
+    size_t pageEnd,
+    Visitor& visitor) const {
+    if (segmentIndex >= _segments.size()) {
+      return false;
+    }
+    const StartsInSegmentTy * starts = _starts[segmentIndex];
+    const size_t startsHeaderSize =
+      offsetof(typename StartsInSegmentTy::WrappedTy, page_start);
+    const size_t startCount =
+      (starts->getSize() - startsHeaderSize) / sizeof(uint16_t);
+    const uint64_t pageSize = starts->getPageSize();
+    details::ChainedFixupContext context{
+      _preferredLoadAddress,
+      static_cast<uint32_t>(starts->getMaxValidPointer())};
+
+    for (size_t pageIndex = pageBegin; pageIndex < pageEnd; pageIndex++) {
+      uint16_t start = starts->getPageStartAtIndex(pageIndex);
+      if (start == DYLD_CHAINED_PTR_START_NONE) {
+        continue;
+      }
+      uint64_t pageOffset = pageIndex * pageSize;
+      if (!(start & DYLD_CHAINED_PTR_START_MULTI)) {
+        if (!walkChain<Format>(
+              segmentIndex, context, pageOffset + start, visitor)) {
+          return false;
+        }
+        continue;
+      }
+      // The page has several chains, listed past the regular starts.
+      for (size_t index = start & ~DYLD_CHAINED_PTR_START_MULTI;;
+           index++) {
+        if (index >= startCount) {
+          return false;
+        }
+        uint16_t chainStart = starts->getPageStartAtIndex(index);
+        uint64_t offset = chainStart & ~DYLD_CHAINED_PTR_START_LAST;
+        if (!walkChain<Format>(
+              segmentIndex, context, pageOffset + offset, visitor)) {
+          return false;
+        }
+        if (chainStart & DYLD_CHAINED_PTR_START_LAST) {
+          break;
+        }
+      }
+    }
+    return true;
+  }
+
+  template <ChainedPointerFormat Format, typename Visitor>
+  bool walkChain(
+    size_t segmentIndex,
+    const details::ChainedFixupContext& context,
+    uint64_t offset,
+    Visitor& visitor) const {
+    using Traits = details::ChainedPointerFormatTraits<Format>;
+    using StorageTy = typename Traits::StorageTy;
+
+    const Segment& segment = _segments[segmentIndex];
+    while (true) {
+      if (offset > segment.size || segment.size - offset < sizeof(StorageTy)) {
+        return false;
+      }
+      StorageTy raw;
+      std::memcpy(&raw, segment.data + offset, sizeof(StorageTy));
+      raw = ByteOrder::swapToHost(raw);
+
+      ChainedFixup fixup{};
+      fixup.segmentIndex = static_cast<uint32_t>(segmentIndex);
+      fixup.size = sizeof(StorageTy);
+      fixup.segmentOffset = offset;
+      fixup.rawValue = raw;
+      Traits::decode(raw, context, fixup);
+      visitor(std::as_const(fixup));
+
+      uint32_t next = Traits::getNext(raw);
+      if (next == 0) {
+        return true;
+      }
+      offset += uint64_t(next) * Traits::kStride;
+    }
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_CHAINEDFIXUPWALKER_H
@@ -0,0 +1,382 @@
+//===--- ChainedImportTable.h - Dyld Chained Import Table -------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_CHAINEDIMPORTTABLE_H
+#define DCL_BINARY_DARWIN_DYLD_CHAINEDIMPORTTABLE_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Dyld/DyldFixupChains.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+#if DCL_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// An import of a chained fixups payload. Bind fixups refer to imports by
+/// their index in the table.
+class ChainedImportEntry {
+public:
+  int64_t addend;
+
+  /// The offset of the name of the import in the symbol pool.
+  uint32_t nameOffset;
+
+  /// The library ordinal. The special ordinals, such as
+  /// `BIND_SPECIAL_DYLIB_FLAT_LOOKUP`, are negative.
+  int16_t libraryOrdinal;
+
+  bool isWeak;
+};
+
+/// The imports of a chained fixups payload, decoded into one flat array so
+/// that binds can look them up by index.
+///
+/// Names are not copied out of an uncompressed symbol pool. A compressed
+/// pool is inflated once into an arena owned by the table.
+class ChainedImportTable {
+
+  template <typename Target, typename ByteOrder>
+  friend class ChainedImportDecoder;
+
+private:
+  std::vector<ChainedImportEntry> _entries;
+
+  std::vector<char> _arena;
+
+  const char * _symbols = nullptr;
+
+  size_t _symbolsSize = 0;
+
+public:
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _entries.size(); }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _entries.empty(); }
+
+  DCL_ALWAYS_INLINE
+  const ChainedImportEntry& operator[](size_t index) const {
+    return _entries[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  const ChainedImportEntry * begin() const { return _entries.data(); }
+
+  DCL_ALWAYS_INLINE
+  const ChainedImportEntry * end() const {
+    return _entries.data() + _entries.size();
+  }
+
+  /// The name of import `index`.
+  DCL_ALWAYS_INLINE
+  std::string_view getName(size_t index) const {
+    const char * name = _symbols + _entries[index].nameOffset;
+    size_t capacity = _symbolsSize - _entries[index].nameOffset;
+    return std::string_view{name, strnlen(name, capacity)};
+  }
+
+  /// Whether the symbol pool was compressed.
+  DCL_ALWAYS_INLINE
+  bool isInflated() const { return !_arena.empty(); }
+
+  void clear() {
+    _entries.clear();
+    _arena.clear();
+    _symbols = nullptr;
+    _symbolsSize = 0;
+  }
+};
+
+namespace details {
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static int16_t MakeChainedLibraryOrdinal8(uint64_t ordinal) {
+  return ordinal > 0xF0 ? int8_t(ordinal) : int16_t(ordinal);
+}
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static int16_t MakeChainedLibraryOrdinal16(uint64_t ordinal) {
+  return int16_t(ordinal);
+}
+
+/// Describes how the records of an import format are laid out. `kSize` is
+/// the size of a record and `decode` fills in an entry from one.
+template <ChainedImportFormat Format>
+class ChainedImportFormatTraits;
+
+template <>
+class ChainedImportFormatTraits<ChainedImportFormat::Generic> {
+public:
+  DCL_CONSTEXPR
+  static const size_t kSize = sizeof(dyld_chained_import);
+
+  template <typename ByteOrder>
+  DCL_ALWAYS_INLINE static void
+  decode(const uint8_t * record, ChainedImportEntry& entry) {
+    uint32_t raw;
+    std::memcpy(&raw, record, sizeof(raw));
+    raw = ByteOrder::swapToHost(raw);
+    entry.libraryOrdinal = MakeChainedLibraryOrdinal8(raw & 0xFF);
+    entry.isWeak = (raw >> 8) & 1;
+    entry.nameOffset = raw >> 9;
+    entry.addend = 0;
+  }
+};
+
+template <>
+class ChainedImportFormatTraits<ChainedImportFormat::Addend> {
+public:
+  DCL_CONSTEXPR
+  static const size_t kSize = sizeof(dyld_chained_import_addend);
+
+  template <typename ByteOrder>
+  DCL_ALWAYS_INLINE static void
+  decode(const uint8_t * record, ChainedImportEntry& entry) {
+    ChainedImportFormatTraits<ChainedImportFormat::Generic>::decode<ByteOrder>(
+      record, entry);
+    uint32_t addend;
+    std::memcpy(&addend, record + sizeof(uint32_t), sizeof(addend));
+    entry.addend = int32_t(ByteOrder::swapToHost(addend));
+  }
+};
+
+template <>
+class ChainedImportFormatTraits<ChainedImportFormat::Addend64> {
+public:
+  DCL_CONSTEXPR
+  static const size_t kSize = sizeof(dyld_chained_import_addend64);
+
+  template <typename ByteOrder>
+  DCL_ALWAYS_INLINE static void
+  decode(const uint8_t * record, ChainedImportEntry& entry) {
+    uint64_t raw;
+    uint64_t addend;
+    std::memcpy(&raw, record, sizeof(raw));
+    std::memcpy(&addend, record + sizeof(uint64_t), sizeof(addend));
+    raw = ByteOrder::swapToHost(raw);
+    entry.libraryOrdinal = MakeChainedLibraryOrdinal16(raw & 0xFFFF);
+    entry.isWeak = (raw >> 16) & 1;
+    entry.nameOffset = static_cast<uint32_t>(raw >> 32);
+    entry.addend = int64_t(ByteOrder::swapToHost(addend));
+  }
+};
+
+} // namespace details
+
+/// Decodes the imports of `LC_DYLD_CHAINED_FIXUPS` payloads into
+/// `ChainedImportTable`s.
+template <typename Target, typename ByteOrder>
+class ChainedImportDecoder {
+
+public:
+  using HeaderTy = ChainedFixupsHeader<Target, ByteOrder>;
+
+  /// No symbol pool inflates to more than this, since name offsets are at
+  /// most 32 bits wide.
+  DCL_CONSTEXPR
+  static const uint64_t kMaxSymbolsSize = uint64_t(1) << 32;
+
+  /// No symbol pool inflates to more than this many times its compressed
+  /// size. Name pools compress a few times over, while a crafted deflate
+  /// stream can reach about a thousand.
+  DCL_CONSTEXPR
+  static const uint64_t kMaxInflationRatio = 256;
+
+  /// Replaces the contents of `table` with the imports of the payload in
+  /// [`begin`, `end`). Returns false if the payload is malformed or its
+  /// symbol pool cannot be inflated, in which case `table` is empty.
+  bool decode(
+    const uint8_t * begin,
+    const uint8_t * end,
+    ChainedImportTable& table) const {
+    table.clear();
+    if (!decodeUnchecked(begin, end, table)) {
+      table.clear();
+      return false;
+    }
+    return true;
+  }
+
+  /// Decodes the imports of the image indexed by `commands`, which must be
+  /// `imageSize` bytes long.
+  bool decode(
+    const LoadCommandIndex<Target, ByteOrder>& commands,
+    size_t imageSize,
+    ChainedImportTable& table) const {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    table.clear();
+    auto command = commands.template first<LinkEditDataCommand>(
+      CommandKind::DyldChainedFixups);
+    if (!command) {
+      return false;
+    }
+    uint64_t offset = command->getDataOffset();
+    uint64_t size = command->getDataSize();
+    if (offset > imageSize || size > imageSize - offset) {
+      return false;
+    }
+    auto begin = reinterpret_cast<const uint8_t *>(commands.getHeader());
+    return decode(begin + offset, begin + offset + size, table);
+  }
+
+private:
+  bool decodeUnchecked(
+    const uint8_t * begin,
+    const uint8_t * end,
+    ChainedImportTable& table) const {
+    size_t size = end - begin;
+    if (size < sizeof(typename HeaderTy::WrappedTy)) {
+      return false;
+    }
+    auto header = reinterpret_cast<const HeaderTy *>(begin);
+    uint64_t symbolsOffset = header->getSymbolsOffset();
+    if (symbolsOffset > size) {
+      return false;
+    }
+    if (!loadSymbols(
+          begin + symbolsOffset,
+          size - symbolsOffset,
+          header->getSymbolsFormat(),
+          table)) {
+      return false;
+    }
+
+    uint64_t importsOffset = header->getImportsOffset();
+    uint64_t count = header->getImportsCount();
+    if (importsOffset > size) {
+      return false;
+    }
+    const uint8_t * records = begin + importsOffset;
+    size_t capacity = size - importsOffset;
+    switch (header->getImportsFormat()) {
+    case ChainedImportFormat::Generic:
+      return decodeRecords<ChainedImportFormat::Generic>(
+        records, capacity, count, table);
+    case ChainedImportFormat::Addend:
+      return decodeRecords<ChainedImportFormat::Addend>(
+        records, capacity, count, table);
+    case ChainedImportFormat::Addend64:
+      return decodeRecords<ChainedImportFormat::Addend64>(
+        records, capacity, count, table);
+    }
+    return false;
+  }
+
+  template <ChainedImportFormat Format>
+  static bool decodeRecords(
+    const uint8_t * records,
+    size_t capacity,
+    uint64_t count,
+    ChainedImportTable& table) {
+    using Traits = details::ChainedImportFormatTraits<Format>;
+    if (capacity / Traits::kSize < count) {
+      return false;
+    }
+    table._entries.resize(count);
+    ChainedImportEntry * entries = table._entries.data();
+    for (size_t index = 0; index < count; index++) {
+      Traits::template decode<ByteOrder>(
+        records + index * Traits::kSize, entries[index]);
+      if (entries[index].nameOffset >= table._symbolsSize) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool loadSymbols(
+    const uint8_t * symbols,
+    size_t size,
+    ChainedSymbolFormat format,
+    ChainedImportTable& table) {
+    switch (format) {
+    case ChainedSymbolFormat::Uncompressed:
+      table._symbols = reinterpret_cast<const char *>(symbols);
+      table._symbolsSize = size;
+      return true;
+    case ChainedSymbolFormat::ZlibCompressed:
+      if (!inflateSymbols(symbols, size, table._arena)) {
+        return false;
+      }
+      table._symbols = table._arena.data();
+      table._symbolsSize = table._arena.size();
+      return true;
+    }
+    return false;
+  }
+
+  static bool inflateSymbols(
+    const uint8_t * symbols, size_t size, std::vector<char>& arena) {
+#if DCL_HAS_ZLIB
+    if (size > std::numeric_limits<uInt>::max()) {
+      return false;
+    }
+    z_stream stream{};
+    if (inflateInit(&stream) != Z_OK) {
+      return false;
+    }
+    uint64_t limit = std::min(kMaxSymbolsSize, size * kMaxInflationRatio);
+    stream.next_in = const_cast<Bytef *>(symbols);
+    stream.avail_in = static_cast<uInt>(size);
+    arena.resize(std::min<uint64_t>(std::max<uint64_t>(size * 4, 256), limit));
+    size_t produced = 0;
+    int result = Z_OK;
+    while (result == Z_OK) {
+      if (produced == arena.size()) {
+        if (arena.size() >= limit) {
+          break;
+        }
+        arena.resize(std::min<uint64_t>(arena.size() * 2, limit));
+      }
+      stream.next_out = reinterpret_cast<Bytef *>(arena.data() + produced);
+      stream.avail_out = static_cast<uInt>(std::min<size_t>(
+        arena.size() - produced, std::numeric_limits<uInt>::max()));
+      uInt available = stream.avail_out;
+      result = inflate(&stream, Z_NO_FLUSH);
+      produced += available - stream.avail_out;
+    }
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END || produced == 0) {
+      arena.clear();
+      return false;
+    }
+    arena.resize(produced);
+    return true;
+#else
+    (void)symbols;
+    (void)size;
+    (void)arena;
+    return false;
+#endif
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_CHAINEDIMPORTTABLE_H
@@ -16,8 +16,6 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <dcl/Binary/Darwin/Dyld/Traits.h>
 #include <dcl/Binary/Darwin/Iterators.h>
 #include <dcl/Binary/Darwin/MachO.h>
@@ -26,7 +24,7 @@
 #include <cstdint>
 #include <utility>
 
-#include <mach-o/fixup-chains.h>
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
 
 namespace dcl::Binary::Darwin::Dyld {
 
@@ -45,6 +43,7 @@ enum class ChainedPointerFormat : uint16_t {
   Arm64EKernal = DYLD_CHAINED_PTR_ARM64E_KERNEL,
   Arm64EUserland24 = DYLD_CHAINED_PTR_ARM64E_USERLAND24,
   Arm64EUserland = DYLD_CHAINED_PTR_ARM64E_USERLAND,
+  X86_64KernelCache = DYLD_CHAINED_PTR_X86_64_KERNEL_CACHE,
 };
 static_assert(sizeof(ChainedPointerFormat) == sizeof(uint16_t));
 
@@ -113,12 +112,13 @@ public:
 
   DCL_ALWAYS_INLINE
   uint32_t getSegmentInfoOffsetAtIndex(uint32_t index) {
-    return this->getWrappedValue().seg_info_offset[index];
+    return std::as_const(*this).getSegmentInfoOffsetAtIndex(index);
   }
 
   DCL_ALWAYS_INLINE
   uint32_t getSegmentInfoOffsetAtIndex(uint32_t index) const {
-    return this->getWrappedValue().seg_info_offset[index];
+    return ByteOrder::swapToHost(
+      this->getWrappedValue().seg_info_offset[index]);
   }
 };
 
@@ -144,16 +144,21 @@ public:
 
   DCL_ALWAYS_INLINE
   uint16_t getPageStartAtIndex(uint16_t index) const {
-    return this->getWrappedValue().page_start[index];
+    return ByteOrder::swapToHost(this->getWrappedValue().page_start[index]);
   }
 };
 
 #pragma mark - Chained Import
 
+template <typename Format>
+using ChainedImportUnderlyingTy =
+  typename ChainedImportTraits<Format>::UnderlyingTy;
+
 template <typename ByteOrder>
 class ChainedImport
-  : public Platform::
-      TypeWrapper<ChainedImportTraits<ChainedImport<ByteOrder>>, ByteOrder> {
+  : public Platform::TypeWrapper<
+      ChainedImportUnderlyingTy<ChainedImport<ByteOrder>>,
+      ByteOrder> {
 public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, LibraryOrdinal, lib_ordinal);
 
@@ -165,7 +170,7 @@ public:
 template <typename ByteOrder>
 class ChainedImportAddend
   : public Platform::TypeWrapper<
-      ChainedImportTraits<ChainedImportAddend<ByteOrder>>,
+      ChainedImportUnderlyingTy<ChainedImportAddend<ByteOrder>>,
       ByteOrder> {
 public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, LibraryOrdinal, lib_ordinal);
@@ -180,7 +185,7 @@ public:
 template <typename ByteOrder>
 class ChainedImportAddend64
   : public Platform::TypeWrapper<
-      ChainedImportTraits<ChainedImportAddend64<ByteOrder>>,
+      ChainedImportUnderlyingTy<ChainedImportAddend64<ByteOrder>>,
       ByteOrder> {
 public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, LibraryOrdinal, lib_ordinal);
@@ -282,7 +287,8 @@ public:
 
   DCL_ALWAYS_INLINE
   ConstIterator cbegin() const {
-    return Iterator{(uint8_t *)_header + _header->getImportsOffset()};
+    return Iterator{reinterpret_cast<ChainedImport<ByteOrder> *>(
+      (uint8_t *)_header + _header->getImportsOffset())};
   }
 
   DCL_ALWAYS_INLINE
@@ -349,8 +355,11 @@ public:
 #pragma mark Chained-Pointers
 
 class ChainedPointer64Bind;
+class ChainedPointer64Rebase;
 class ChainedPointerArm64EBind;
+class ChainedPointerArm64ERebase;
 class ChainedPointerArm64EAuthBind;
+class ChainedPointerArm64EAuthRebase;
 
 class ChainedPointer64 : public ChainedPointerBase<ChainedPointer64> {};
 
@@ -366,6 +375,8 @@ public:
 class ChainedPointer64Bind : public ChainedPointerBase<ChainedPointer64Bind> {
 
 public:
+  /// Writes through `pointer`, i.e. into the image itself. Use
+  /// `ChainedFixupApplier` to fix up a private copy instead.
   DCL_ALWAYS_INLINE
   static uint64_t
   bind(ChainedPointer64Bind * pointer, const void * const * addressList) {
@@ -388,10 +399,29 @@ public:
   uint64_t getAddend() const { return _base.addend; }
 };
 
+class ChainedPointer64Rebase
+  : public ChainedPointerBase<ChainedPointer64Rebase> {
+
+public:
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() const { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getHigh8() { return _base.high8; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getHigh8() const { return _base.high8; }
+};
+
 class ChainedPointerArm64EBind
   : public ChainedPointerBase<ChainedPointerArm64EBind> {
 
 public:
+  /// Writes through `pointer`, i.e. into the image itself. Use
+  /// `ChainedFixupApplier` to fix up a private copy instead.
   DCL_ALWAYS_INLINE
   static uint64_t
   bind(ChainedPointerArm64EBind * pointer, const void * const * addressList) {
@@ -423,13 +453,23 @@ class ChainedPointerArm64EAuthBind
   : public ChainedPointerBase<ChainedPointerArm64EAuthBind> {
 
 public:
+  /// Writes the target through `pointer` without signing it, since the
+  /// key material is not available outside of the target process.
   DCL_ALWAYS_INLINE
-  static void bind(
+  static uint64_t bind(
     ChainedPointerArm64EAuthBind * pointer,
     const void * const * addressList) {
-    dcl::notImplemented();
+    *reinterpret_cast<uint64_t *>(pointer) =
+      *reinterpret_cast<const uint64_t *>(addressList + pointer->getOrdinal());
+    return *reinterpret_cast<uint64_t *>(pointer);
   }
 
+  DCL_ALWAYS_INLINE
+  uint64_t getOrdinal() { return _base.ordinal; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getOrdinal() const { return _base.ordinal; }
+
   DCL_ALWAYS_INLINE
   uint64_t getZero() { return _base.zero; }
 
@@ -455,6 +495,52 @@ public:
   uint64_t getKey() const { return _base.key; }
 };
 
+class ChainedPointerArm64ERebase
+  : public ChainedPointerBase<ChainedPointerArm64ERebase> {
+
+public:
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() const { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getHigh8() { return _base.high8; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getHigh8() const { return _base.high8; }
+};
+
+class ChainedPointerArm64EAuthRebase
+  : public ChainedPointerBase<ChainedPointerArm64EAuthRebase> {
+
+public:
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getTarget() const { return _base.target; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getDiversity() { return _base.diversity; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getDiversity() const { return _base.diversity; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getAddrDiv() { return _base.addrDiv; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getAddrDiv() const { return _base.addrDiv; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getKey() { return _base.key; }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getKey() const { return _base.key; }
+};
+
 #pragma mark - Chained-Pointer Iterator
 
 template <typename ChainedPointer>
@@ -463,6 +549,9 @@ private:
   ChainedPointer * _base;
 
 public:
+  DCL_ALWAYS_INLINE
+  explicit ChainedPointerIterator(ChainedPointer * base) : _base(base) {}
+
   DCL_ALWAYS_INLINE
   ChainedPointerIterator<ChainedPointer>& operator++() {
     _base = _base->getNext();
@@ -531,7 +620,7 @@ public:
   DCL_ALWAYS_INLINE
   bool operator==(
     ChainedFixupsPageInfoIterator<Target, ByteOrder, Format> other) const {
-    return _machHeader == other.machHeader &&
+    return _machHeader == other._machHeader &&
            _startsInSegment == other._startsInSegment &&
            _pageIndex == other._pageIndex;
   }
@@ -598,7 +687,7 @@ public:
   DCL_ALWAYS_INLINE
   ConstIterator cend() const {
     return Iterator{
-      _machHeader, _startsInSegment, _startsInSegment->SegmentCount()};
+      _machHeader, _startsInSegment, _startsInSegment->getPageCount()};
   }
 };
 
@@ -675,7 +764,7 @@ public:
   DCL_ALWAYS_INLINE
   bool
   operator==(ChainedFixupsSegmentInfoIterator<Target, ByteOrder> other) const {
-    return _machHeader == other.machHeader &&
+    return _machHeader == other._machHeader &&
            _startsInImage == other._startsInImage && _index == other._index;
   }
 
@@ -749,12 +838,10 @@ public:
   DCL_ALWAYS_INLINE
   ConstIterator cend() const {
     return Iterator{
-      _machHeader, _startsInImage, _startsInImage->SegmentCount()};
+      _machHeader, _startsInImage, _startsInImage->getSegmentCount()};
   }
 };
 
 } // namespace dcl::Binary::Darwin::Dyld
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_DYLD_DYLDFIXUPCHAINS_H
@@ -16,16 +16,17 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
 #include <dcl/Binary/Darwin/MachO.h>
 #include <dcl/Binary/Darwin/Utilities.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <utility>
+#include <vector>
 
-#include <mach-o/loader.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
 
 namespace dcl::Binary::Darwin::Dyld {
 
@@ -104,7 +105,6 @@ private:
   ++_address;
 #define DYLD_CONSUME_SUB_OPCODE()                                              \
   {                                                                            \
-    DYLD_CONSUME();                                                            \
     auto subopcode = BindOpcode::SubOpcode(immediate);                         \
     switch (subopcode) {                                                       \
     case BindOpcode::SubOpcode::SetBindOrdinalTableSizeUleb:                   \
@@ -238,8 +238,268 @@ public:
   }
 };
 
-} // namespace dcl::Binary::Darwin::Dyld
+#pragma mark - Rebase Opcodes
+
+class RebaseOpcode {
+
+public:
+  enum class Kind : uint8_t {
+#define DYLD_REBASE_OPCODE(CASE_NAME, CONSTANT, ...) CASE_NAME = CONSTANT,
+#include <dcl/Binary/Darwin/Dyld/RebaseOpcode.def>
+#undef DYLD_REBASE_OPCODE
+  };
+
+private:
+  uint8_t _raw;
+
+public:
+  DCL_ALWAYS_INLINE
+  explicit RebaseOpcode(uint8_t raw) : _raw(raw) {}
+
+  DCL_ALWAYS_INLINE
+  uint8_t getRaw() const { return _raw; }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getAddress() const {
+    return reinterpret_cast<const uint8_t *>(&_raw);
+  }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getTrailingContentsAddress() const {
+    return getAddress() + 1;
+  }
+
+  DCL_ALWAYS_INLINE
+  Kind getKind() const { return Kind(_raw & REBASE_OPCODE_MASK); }
+
+  DCL_ALWAYS_INLINE
+  uint8_t getImmediate() const { return _raw & REBASE_IMMEDIATE_MASK; }
+};
+
+class RebaseOpcodeIterator {
+
+public:
+  using value_type = RebaseOpcode;
+  using difference_type = ptrdiff_t;
+  using pointer = typename std::add_pointer<value_type>::type;
+  using const_pointer = typename std::add_const<pointer>::type;
+  using reference = typename std::add_lvalue_reference<value_type>::type;
+  using const_reference = typename std::add_const<reference>::type;
+  using iterator_category = std::forward_iterator_tag;
+
+private:
+  const uint8_t * _begin;
+
+  const uint8_t * _address;
+
+  const uint8_t * _end;
+
+private:
+  DCL_ALWAYS_INLINE
+  void advance() {
+
+// Dyld rebase opcode consumer
+#define DYLD_CONSUME()      (_address += 1)
+#define DYLD_CONSUME_ULEB() (consumeUleb128())
+
+// Dyld rebase opcode consumer invocator
+#define DYLD_CONSUME_DO(INDEX, ARG) ARG()
+
+// Dyld rebase opcode branching
+#define DYLD_REBASE_OPCODE(CASE_NAME, CONSTANT, DESC, ...)                     \
+  case RebaseOpcode::Kind::CASE_NAME: {                                        \
+    DCL_META_FOREACH(DYLD_CONSUME_DO, ;, __VA_ARGS__);                         \
+    break;                                                                     \
+  }
+
+    RebaseOpcode::Kind kind = operator*().getKind();
+    switch (kind) {
+#include <dcl/Binary/Darwin/Dyld/RebaseOpcode.def>
+    default:
+      // Streams come from untrusted files, hence the iteration ends at the
+      // first undefined opcode instead of aborting.
+      _address = _end;
+      break;
+    }
+#undef DYLD_CONSUME_DO
+  }
+
+  /// Skips a ULEB128 operand, or ends the iteration if it is truncated.
+  DCL_ALWAYS_INLINE
+  void consumeUleb128() {
+    uint64_t value = 0;
+    if (!tryReadUleb128(_address, _end, value)) {
+      _address = _end;
+    }
+  }
+
+public:
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeIterator(const uint8_t * begin, const uint8_t * end)
+    : RebaseOpcodeIterator(begin, begin, end) {}
+
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeIterator(
+    const uint8_t * begin,
+    const uint8_t * address,
+    const uint8_t * end)
+    : _begin(begin), _address(address), _end(end) {}
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getBegin() const { return _begin; }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getAddress() const { return _address; }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getEnd() const { return _end; }
+
+  DCL_ALWAYS_INLINE
+  const ptrdiff_t getOffset() const { return _address - _begin; }
+
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeIterator& operator++() {
+    advance();
+    return *this;
+  }
+
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeIterator operator++(int arg0) {
+    auto iterator = *this;
+    ++(*this);
+    return iterator;
+  }
+
+  DCL_ALWAYS_INLINE
+  bool operator==(RebaseOpcodeIterator other) const {
+    return _address == other._address;
+  }
+
+  DCL_ALWAYS_INLINE
+  bool operator!=(RebaseOpcodeIterator other) const {
+    return !(*this == other);
+  }
+
+  DCL_ALWAYS_INLINE
+  reference operator*() const {
+    return *const_cast<RebaseOpcode *>(
+      reinterpret_cast<const RebaseOpcode *>(_address));
+  }
+
+  DCL_ALWAYS_INLINE
+  pointer operator->() const {
+    return const_cast<RebaseOpcode *>(
+      reinterpret_cast<const RebaseOpcode *>(_address));
+  }
+};
+
+class RebaseOpcodeStream {
+
+private:
+  const uint8_t * _begin;
+
+  const uint8_t * _end;
+
+public:
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeStream(const uint8_t * begin, const uint8_t * end)
+    : _begin(begin), _end(end) {}
+
+  using Iterator = RebaseOpcodeIterator;
+  using ConstIterator = typename std::add_const<Iterator>::type;
+
+  DCL_ALWAYS_INLINE
+  Iterator begin() { return Iterator{std::as_const(*this).begin()}; }
+
+  DCL_ALWAYS_INLINE
+  Iterator end() { return Iterator{std::as_const(*this).end()}; }
+
+  DCL_ALWAYS_INLINE
+  const Iterator begin() const { return cbegin(); }
+
+  DCL_ALWAYS_INLINE
+  const Iterator end() const { return cend(); }
+
+  DCL_ALWAYS_INLINE
+  ConstIterator cbegin() const { return Iterator{_begin, _end}; }
+
+  DCL_ALWAYS_INLINE
+  ConstIterator cend() const { return Iterator{_begin, _end, _end}; }
+
+  DCL_ALWAYS_INLINE
+  uintptr_t getUleb128(const uint8_t *& begin) const {
+    return readUleb128(begin, _end);
+  }
+};
+
+#pragma mark - Segment Bounds
+
+/// The virtual memory sizes of the segments of an image in load command
+/// order. Rebase and bind opcodes address pointers by segment index and
+/// offset, and dyld rejects those that do not lie within their segment.
+class SegmentSizes {
 
-#endif // DCL_TARGET_OS_DARWIN
+private:
+  std::vector<uint64_t> _sizes;
+
+public:
+  SegmentSizes() = default;
+
+  DCL_ALWAYS_INLINE
+  explicit SegmentSizes(std::vector<uint64_t> sizes)
+    : _sizes(std::move(sizes)) {}
+
+  /// The sizes of the segments of the image indexed by `commands`.
+  template <typename Target, typename ByteOrder>
+  explicit SegmentSizes(const LoadCommandIndex<Target, ByteOrder>& commands) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    for (auto& eachCommand : commands.all(CommandKind::Semgent)) {
+      auto segment =
+        reinterpret_cast<const SegmentCommand<Target, ByteOrder> *>(
+          &eachCommand);
+      _sizes.push_back(segment->getVirtualMemorySize());
+    }
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _sizes.size(); }
+
+  DCL_ALWAYS_INLINE
+  uint64_t operator[](size_t segmentIndex) const {
+    return _sizes[segmentIndex];
+  }
+
+  /// Whether `count` pointers of `pointerSize` bytes all lie within segment
+  /// `segmentIndex`, the first at `segmentOffset` and each of the others
+  /// `skip` bytes past the end of the previous one.
+  bool contains(
+    size_t segmentIndex,
+    uint64_t segmentOffset,
+    uint32_t pointerSize,
+    uint64_t count = 1,
+    uint64_t skip = 0) const {
+    if (count == 0) {
+      return true;
+    }
+    if (segmentIndex >= _sizes.size()) {
+      return false;
+    }
+    uint64_t size = _sizes[segmentIndex];
+    if (size < pointerSize || segmentOffset > size - pointerSize) {
+      return false;
+    }
+    // The room left after the first pointer.
+    uint64_t room = size - pointerSize - segmentOffset;
+    if (count == 1) {
+      return true;
+    }
+    if (skip > room) {
+      return false;
+    }
+    return count - 1 <= room / (skip + pointerSize);
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
 
 #endif // DCL_BINARY_DARWIN_DYLD_DYLDINFO_H
@@ -0,0 +1,435 @@
+//===--- ExportsTrie.h - Dyld Exports Trie ----------------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  Each node of the trie starts with the ULEB128 size of its terminal
+//  information, followed by that information if the size is not zero, a byte
+//  holding the number of children, and one edge per child. An edge is a
+//  null-terminated label followed by the ULEB128 offset of the child node
+//  from the start of the trie.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_EXPORTSTRIE_H
+#define DCL_BINARY_DARWIN_DYLD_EXPORTSTRIE_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/Utilities.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// The terminal information of an exported symbol.
+class ExportedSymbol {
+
+public:
+  enum class Kind : uint8_t {
+    Regular = EXPORT_SYMBOL_FLAGS_KIND_REGULAR,
+    ThreadLocal = EXPORT_SYMBOL_FLAGS_KIND_THREAD_LOCAL,
+    Absolute = EXPORT_SYMBOL_FLAGS_KIND_ABSOLUTE,
+  };
+
+private:
+  uint64_t _flags = 0;
+
+  uint64_t _value = 0;
+
+  uint64_t _resolver = 0;
+
+  const char * _importName = nullptr;
+
+public:
+  ExportedSymbol() = default;
+
+  DCL_ALWAYS_INLINE
+  ExportedSymbol(
+    uint64_t flags,
+    uint64_t value,
+    uint64_t resolver,
+    const char * importName)
+    : _flags(flags), _value(value), _resolver(resolver),
+      _importName(importName) {}
+
+  DCL_ALWAYS_INLINE
+  uint64_t getFlags() const { return _flags; }
+
+  DCL_ALWAYS_INLINE
+  Kind getKind() const {
+    return Kind(_flags & EXPORT_SYMBOL_FLAGS_KIND_MASK);
+  }
+
+  DCL_ALWAYS_INLINE
+  bool isWeakDefinition() const {
+    return (_flags & EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION) != 0;
+  }
+
+  DCL_ALWAYS_INLINE
+  bool isReexport() const {
+    return (_flags & EXPORT_SYMBOL_FLAGS_REEXPORT) != 0;
+  }
+
+  DCL_ALWAYS_INLINE
+  bool isStubAndResolver() const {
+    return (_flags & EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER) != 0;
+  }
+
+  /// The offset of the symbol from the image's header. Not meaningful for
+  /// re-exports.
+  DCL_ALWAYS_INLINE
+  uint64_t getAddress() const { return _value; }
+
+  /// The ordinal of the dylib a re-exported symbol comes from.
+  DCL_ALWAYS_INLINE
+  uint64_t getLibraryOrdinal() const { return _value; }
+
+  /// The name of a re-exported symbol in the dylib it comes from. Empty when
+  /// the symbol keeps its name.
+  DCL_ALWAYS_INLINE
+  std::string_view getImportName() const {
+    return _importName ? std::string_view{_importName} : std::string_view{};
+  }
+
+  DCL_ALWAYS_INLINE
+  uint64_t getResolverAddress() const { return _resolver; }
+};
+
+namespace details {
+
+/// Moves `p` past the null-terminated string it points to. Fails if the
+/// string is not terminated before `end`.
+DCL_ALWAYS_INLINE
+inline bool SkipExportsTrieString(const uint8_t *& p, const uint8_t * end) {
+  while (p < end && *p != '\0') {
+    p++;
+  }
+  if (p == end) {
+    return false;
+  }
+  p++;
+  return true;
+}
+
+/// Decodes the terminal information of the node at `node`. Returns false if
+/// the node has none or it is malformed. On return `children` points to the
+/// child count of the node.
+DCL_ALWAYS_INLINE
+inline bool DecodeExportsTrieNode(
+  const uint8_t * node,
+  const uint8_t * end,
+  const uint8_t *& children,
+  ExportedSymbol * symbol) {
+  const uint8_t * p = node;
+  uint64_t terminalSize = 0;
+  if (
+    !tryReadUleb128(p, end, terminalSize) ||
+    terminalSize > static_cast<uint64_t>(end - p)) {
+    children = end;
+    return false;
+  }
+  children = p + terminalSize;
+  if (terminalSize == 0 || symbol == nullptr) {
+    return terminalSize != 0;
+  }
+  uint64_t flags = 0;
+  if (!tryReadUleb128(p, children, flags)) {
+    return false;
+  }
+  if (flags & EXPORT_SYMBOL_FLAGS_REEXPORT) {
+    uint64_t ordinal = 0;
+    if (!tryReadUleb128(p, children, ordinal)) {
+      return false;
+    }
+    auto importName = reinterpret_cast<const char *>(p);
+    if (!SkipExportsTrieString(p, children)) {
+      return false;
+    }
+    *symbol = ExportedSymbol{
+      flags, ordinal, 0, *importName == '\0' ? nullptr : importName};
+    return true;
+  }
+  uint64_t address = 0;
+  if (!tryReadUleb128(p, children, address)) {
+    return false;
+  }
+  uint64_t resolver = 0;
+  if (
+    (flags & EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER) &&
+    !tryReadUleb128(p, children, resolver)) {
+    return false;
+  }
+  *symbol = ExportedSymbol{flags, address, resolver, nullptr};
+  return true;
+}
+
+} // namespace details
+
+/// A read-only view of an exports trie, as pointed to by
+/// `LC_DYLD_EXPORTS_TRIE` or by the export information of `LC_DYLD_INFO`.
+class ExportsTrie {
+
+private:
+  const uint8_t * _begin;
+
+  const uint8_t * _end;
+
+public:
+  DCL_ALWAYS_INLINE
+  ExportsTrie(const uint8_t * begin, const uint8_t * end)
+    : _begin(begin), _end(end) {}
+
+  /// Locates the trie of the image whose load commands are indexed by
+  /// `commands`. The image must be `imageSize` bytes long. The trie is empty
+  /// if the image has none or it lies outside the image.
+  template <typename Target, typename ByteOrder>
+  ExportsTrie(
+    const LoadCommandIndex<Target, ByteOrder>& commands, size_t imageSize)
+    : _begin(nullptr), _end(nullptr) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    if (auto exportsTrie = commands.template first<ExportsTrieCommand>(
+          CommandKind::DyldExportsTrie)) {
+      offset = exportsTrie->getDataOffset();
+      size = exportsTrie->getDataSize();
+    } else if (
+      auto dyldInfo =
+        commands.template first<DyldInfoCommand>(CommandKind::DyldInfoOnly)) {
+      offset = dyldInfo->getExportInfoOffset();
+      size = dyldInfo->getExportInfoSize();
+    } else if (
+      auto dyldInfo =
+        commands.template first<DyldInfoCommand>(CommandKind::DyldInfo)) {
+      offset = dyldInfo->getExportInfoOffset();
+      size = dyldInfo->getExportInfoSize();
+    }
+    if (size == 0 || offset > imageSize || size > imageSize - offset) {
+      return;
+    }
+    _begin = reinterpret_cast<const uint8_t *>(commands.getHeader()) + offset;
+    _end = _begin + size;
+  }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getBegin() const { return _begin; }
+
+  DCL_ALWAYS_INLINE
+  const uint8_t * getEnd() const { return _end; }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _begin == _end; }
+
+  /// Looks `name` up by descending the edges that match it, in time linear
+  /// in the length of `name`. Nothing is copied.
+  bool lookup(std::string_view name, ExportedSymbol& symbol) const {
+    if (empty()) {
+      return false;
+    }
+    const uint8_t * node = _begin;
+    size_t matched = 0;
+    // Each descent consumes at least one character of the name, which bounds
+    // the walk even for tries with cycles.
+    while (true) {
+      const uint8_t * children;
+      if (matched == name.size()) {
+        return details::DecodeExportsTrieNode(node, _end, children, &symbol);
+      }
+      details::DecodeExportsTrieNode(node, _end, children, nullptr);
+      if (children >= _end) {
+        return false;
+      }
+      const uint8_t * p = children;
+      uint8_t childCount = *p++;
+      const uint8_t * next = nullptr;
+      for (uint8_t index = 0; index < childCount && next == nullptr; index++) {
+        size_t position = matched;
+        while (p < _end && *p != '\0' && position < name.size() &&
+               static_cast<char>(*p) == name[position]) {
+          p++;
+          position++;
+        }
+        bool isMatch = p < _end && *p == '\0' && position > matched;
+        if (!details::SkipExportsTrieString(p, _end) || p >= _end) {
+          return false;
+        }
+        uint64_t childOffset = 0;
+        if (!tryReadUleb128(p, _end, childOffset)) {
+          return false;
+        }
+        if (isMatch) {
+          if (childOffset >= static_cast<uint64_t>(_end - _begin)) {
+            return false;
+          }
+          next = _begin + childOffset;
+          matched = position;
+        }
+      }
+      if (next == nullptr) {
+        return false;
+      }
+      node = next;
+    }
+  }
+
+  /// Calls `visitor(name, symbol)` for each exported symbol. See
+  /// `ExportsTrieEnumerator`.
+  template <typename Visitor>
+  DCL_ALWAYS_INLINE
+  void forEach(Visitor&& visitor) const;
+};
+
+/// Enumerates the symbols of exports tries without recursion.
+///
+/// The traversal stack, the name buffer and the set of visited nodes are
+/// kept between enumerations, so enumerating many tries with one enumerator
+/// stops allocating once the buffers have grown to the deepest trie, the
+/// longest name and the largest trie.
+class ExportsTrieEnumerator {
+
+private:
+  class Frame {
+  public:
+    const uint8_t * edge;
+
+    uint32_t remainingChildren;
+
+    uint32_t nameLength;
+  };
+
+  std::vector<Frame> _stack;
+
+  std::vector<char> _name;
+
+  /// One bit per byte of the trie, set for the offsets of visited nodes.
+  std::vector<uint64_t> _visited;
+
+public:
+  /// Calls `visitor(std::string_view name, const ExportedSymbol& symbol)` for
+  /// each exported symbol in depth-first order. `name` is only valid during
+  /// the call. If `visitor` returns `bool`, returning false stops the
+  /// enumeration. Returns false if the enumeration was stopped or the trie
+  /// is malformed, e.g. reaches a node twice as dyld forbids.
+  template <typename Visitor>
+  bool enumerate(const ExportsTrie& trie, Visitor&& visitor) {
+    if (trie.empty()) {
+      return true;
+    }
+    const uint8_t * begin = trie.getBegin();
+    const uint8_t * end = trie.getEnd();
+    _stack.clear();
+    _name.clear();
+    _visited.assign((static_cast<size_t>(end - begin) + 63) / 64, 0);
+    if (!visitNode(begin, 0, end, 0, visitor)) {
+      return false;
+    }
+
+    while (!_stack.empty()) {
+      Frame& frame = _stack.back();
+      if (frame.remainingChildren == 0) {
+        _stack.pop_back();
+        continue;
+      }
+      frame.remainingChildren--;
+
+      _name.resize(frame.nameLength);
+      const uint8_t * p = frame.edge;
+      while (p < end && *p != '\0') {
+        _name.push_back(static_cast<char>(*p++));
+      }
+      if (p >= end || ++p >= end) {
+        return false;
+      }
+      uint64_t childOffset = 0;
+      if (!tryReadUleb128(p, end, childOffset)) {
+        return false;
+      }
+      frame.edge = p;
+      // Edge labels are never empty and no name can be longer than the trie
+      // itself.
+      if (
+        childOffset >= static_cast<uint64_t>(end - begin) ||
+        _name.size() == frame.nameLength ||
+        _name.size() > static_cast<size_t>(end - begin)) {
+        return false;
+      }
+      if (!visitNode(begin, childOffset, end, _name.size(), visitor)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  template <typename Visitor>
+  DCL_ALWAYS_INLINE
+  bool visitNode(
+    const uint8_t * begin,
+    uint64_t offset,
+    const uint8_t * end,
+    size_t nameLength,
+    Visitor& visitor) {
+    // Nodes reached twice make cycles, or shared children enumerated once
+    // per path to them.
+    uint64_t& visited = _visited[offset / 64];
+    uint64_t bit = uint64_t(1) << (offset % 64);
+    if (visited & bit) {
+      return false;
+    }
+    visited |= bit;
+
+    const uint8_t * node = begin + offset;
+    ExportedSymbol symbol;
+    const uint8_t * children;
+    if (details::DecodeExportsTrieNode(node, end, children, &symbol)) {
+      std::string_view name{_name.data(), nameLength};
+      if constexpr (std::is_same_v<
+                      decltype(visitor(name, std::as_const(symbol))),
+                      bool>) {
+        if (!visitor(name, std::as_const(symbol))) {
+          return false;
+        }
+      } else {
+        visitor(name, std::as_const(symbol));
+      }
+    }
+    if (children >= end) {
+      return false;
+    }
+    uint8_t childCount = *children;
+    if (childCount != 0) {
+      _stack.push_back(Frame{
+        children + 1, childCount, static_cast<uint32_t>(nameLength)});
+    }
+    return true;
+  }
+};
+
+template <typename Visitor>
+DCL_ALWAYS_INLINE
+inline void ExportsTrie::forEach(Visitor&& visitor) const {
+  ExportsTrieEnumerator enumerator;
+  enumerator.enumerate(*this, visitor);
+}
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_EXPORTSTRIE_H
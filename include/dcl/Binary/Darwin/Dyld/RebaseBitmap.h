@@ -0,0 +1,310 @@
+//===--- RebaseBitmap.h - Dyld Rebase Opcode Interpreter --------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_DYLD_REBASEBITMAP_H
+#define DCL_BINARY_DARWIN_DYLD_REBASEBITMAP_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Dyld/DyldInfo.h>
+#include <dcl/Binary/Darwin/Utilities.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+
+namespace dcl::Binary::Darwin::Dyld {
+
+/// The locations rebased by a rebase opcode stream.
+///
+/// Every segment gets one bit per pointer-aligned slot, grouped into pages
+/// of whole 64-bit words, so that the rebases of a page can be scanned a
+/// word at a time. Rebases that do not fit in the bitmap, i.e. unaligned
+/// ones or ones not of `REBASE_TYPE_POINTER`, are listed separately.
+class RebaseBitmap {
+
+  friend class RebaseOpcodeInterpreter;
+
+public:
+  class Exception {
+  public:
+    uint8_t segmentIndex;
+
+    uint8_t type;
+
+    uint64_t segmentOffset;
+  };
+
+private:
+  uint32_t _pointerSize;
+
+  uint32_t _pageSize;
+
+  uint32_t _wordsPerPage;
+
+  std::vector<std::vector<uint64_t>> _segments;
+
+  std::vector<Exception> _exceptions;
+
+public:
+  /// `pageSize` must be a multiple of 64 pointers.
+  DCL_ALWAYS_INLINE
+  RebaseBitmap(uint32_t pointerSize, uint32_t pageSize)
+    : _pointerSize(pointerSize), _pageSize(pageSize),
+      _wordsPerPage(pageSize / pointerSize / 64) {
+    DCLAssert(pageSize % (pointerSize * 64) == 0);
+  }
+
+  DCL_ALWAYS_INLINE
+  uint32_t getPointerSize() const { return _pointerSize; }
+
+  DCL_ALWAYS_INLINE
+  uint32_t getPageSize() const { return _pageSize; }
+
+  DCL_ALWAYS_INLINE
+  uint32_t getWordsPerPage() const { return _wordsPerPage; }
+
+  /// One more than the greatest segment index rebased.
+  DCL_ALWAYS_INLINE
+  size_t getSegmentCount() const { return _segments.size(); }
+
+  /// The number of pages of `segmentIndex` up to its last rebased page.
+  DCL_ALWAYS_INLINE
+  size_t getPageCount(size_t segmentIndex) const {
+    if (segmentIndex >= _segments.size()) {
+      return 0;
+    }
+    return _segments[segmentIndex].size() / _wordsPerPage;
+  }
+
+  /// The `getWordsPerPage()` words of page `pageIndex` of `segmentIndex`.
+  /// Bit `i` of word `j` stands for the pointer at page offset
+  /// `(64 * j + i) * getPointerSize()`.
+  DCL_ALWAYS_INLINE
+  const uint64_t * getPageWords(size_t segmentIndex, size_t pageIndex) const {
+    DCLAssert(pageIndex < getPageCount(segmentIndex));
+    return _segments[segmentIndex].data() + pageIndex * _wordsPerPage;
+  }
+
+  DCL_ALWAYS_INLINE
+  const std::vector<Exception>& getExceptions() const { return _exceptions; }
+
+  DCL_ALWAYS_INLINE
+  bool contains(size_t segmentIndex, uint64_t segmentOffset) const {
+    if (segmentIndex >= _segments.size() || segmentOffset % _pointerSize) {
+      return false;
+    }
+    uint64_t slot = segmentOffset / _pointerSize;
+    const std::vector<uint64_t>& words = _segments[segmentIndex];
+    if (slot / 64 >= words.size()) {
+      return false;
+    }
+    return (words[slot / 64] >> (slot % 64)) & 1;
+  }
+
+  /// The number of rebases in the bitmap, not counting exceptions.
+  size_t count() const {
+    size_t total = 0;
+    for (const std::vector<uint64_t>& eachSegment : _segments) {
+      for (uint64_t eachWord : eachSegment) {
+        total += __builtin_popcountll(eachWord);
+      }
+    }
+    return total;
+  }
+
+  /// Calls `visitor(segmentIndex, segmentOffset)` for each rebase in the
+  /// bitmap, in ascending order.
+  template <typename Visitor>
+  void forEach(Visitor&& visitor) const {
+    for (size_t segment = 0; segment < _segments.size(); segment++) {
+      const std::vector<uint64_t>& words = _segments[segment];
+      for (size_t index = 0; index < words.size(); index++) {
+        for (uint64_t word = words[index]; word != 0; word &= word - 1) {
+          uint64_t slot = index * 64 + __builtin_ctzll(word);
+          visitor(segment, slot * _pointerSize);
+        }
+      }
+    }
+  }
+
+  void clear() {
+    _segments.clear();
+    _exceptions.clear();
+  }
+
+private:
+  DCL_ALWAYS_INLINE
+  void set(uint8_t segmentIndex, uint64_t segmentOffset) {
+    if (segmentIndex >= _segments.size()) {
+      _segments.resize(segmentIndex + 1);
+    }
+    std::vector<uint64_t>& words = _segments[segmentIndex];
+    uint64_t slot = segmentOffset / _pointerSize;
+    if (slot / 64 >= words.size()) {
+      uint64_t pages = slot / 64 / _wordsPerPage + 1;
+      words.resize(pages * _wordsPerPage);
+    }
+    words[slot / 64] |= uint64_t(1) << (slot % 64);
+  }
+};
+
+/// Executes rebase opcode streams into `RebaseBitmap`s.
+class RebaseOpcodeInterpreter {
+
+public:
+  /// Streams listing more exceptions than this are rejected. Exceptions are
+  /// rare outside of 32-bit text relocations, and unlike the bitmap their
+  /// storage grows with every rebase.
+  DCL_CONSTEXPR
+  static const size_t kMaxExceptionCount = size_t(1) << 20;
+
+private:
+  uint32_t _pointerSize;
+
+  /// Rebases outside of these segments are rejected rather than grown into.
+  SegmentSizes _segments;
+
+public:
+  /// Interprets the streams of an image with `segments`.
+  DCL_ALWAYS_INLINE
+  RebaseOpcodeInterpreter(uint32_t pointerSize, SegmentSizes segments)
+    : _pointerSize(pointerSize), _segments(std::move(segments)) {}
+
+  /// Replaces the contents of `bitmap` with the rebases of the stream in
+  /// [`begin`, `end`). Returns false if the stream is malformed or rebases
+  /// outside of its segments, in which case `bitmap` holds the rebases
+  /// decoded so far.
+  bool
+  interpret(const uint8_t * begin, const uint8_t * end, RebaseBitmap& bitmap) {
+    bitmap.clear();
+    uint8_t type = 0;
+    uint8_t segmentIndex = 0;
+    uint64_t segmentOffset = 0;
+    uint64_t operand = 0;
+
+    auto rebase = [&]() -> bool {
+      if (!_segments.contains(segmentIndex, segmentOffset, _pointerSize)) {
+        return false;
+      }
+      if (type == REBASE_TYPE_POINTER && segmentOffset % _pointerSize == 0) {
+        bitmap.set(segmentIndex, segmentOffset);
+      } else {
+        if (bitmap._exceptions.size() >= kMaxExceptionCount) {
+          return false;
+        }
+        bitmap._exceptions.push_back(
+          RebaseBitmap::Exception{segmentIndex, type, segmentOffset});
+      }
+      return true;
+    };
+
+    // Runs are checked up front, so that one ending out of the segment
+    // fails without looping over it.
+    auto rebaseTimes = [&](uint64_t count, uint64_t skip) -> bool {
+      if (!_segments.contains(
+            segmentIndex, segmentOffset, _pointerSize, count, skip)) {
+        return false;
+      }
+      for (uint64_t index = 0; index < count; index++) {
+        if (!rebase()) {
+          return false;
+        }
+        segmentOffset += skip + _pointerSize;
+      }
+      return true;
+    };
+
+    const uint8_t * p = begin;
+    while (p < end) {
+      RebaseOpcode opcode{*p++};
+      uint8_t immediate = opcode.getImmediate();
+      switch (opcode.getKind()) {
+      case RebaseOpcode::Kind::Done:
+        return true;
+      case RebaseOpcode::Kind::SetTypeWithImmediate:
+        type = immediate;
+        break;
+      case RebaseOpcode::Kind::SetSegmentAndOffsetUleb:
+        segmentIndex = immediate;
+        if (!tryReadUleb128(p, end, segmentOffset)) {
+          return false;
+        }
+        break;
+      case RebaseOpcode::Kind::AddAddressUleb:
+        if (!tryReadUleb128(p, end, operand)) {
+          return false;
+        }
+        segmentOffset += operand;
+        break;
+      case RebaseOpcode::Kind::AddAddressImmediateScaled:
+        segmentOffset += uint64_t(immediate) * _pointerSize;
+        break;
+      case RebaseOpcode::Kind::DoRebaseImmediateTimes:
+        if (!rebaseTimes(immediate, 0)) {
+          return false;
+        }
+        break;
+      case RebaseOpcode::Kind::DoRebaseUlebTimes:
+        if (!tryReadUleb128(p, end, operand) ||
+            !rebaseTimes(operand, 0)) {
+          return false;
+        }
+        break;
+      case RebaseOpcode::Kind::DoRebaseAddAddressUleb:
+        if (!tryReadUleb128(p, end, operand) || !rebase()) {
+          return false;
+        }
+        segmentOffset += operand + _pointerSize;
+        break;
+      case RebaseOpcode::Kind::DoRebaseUlebTimesSkippingUleb: {
+        uint64_t count = 0;
+        uint64_t skip = 0;
+        if (!tryReadUleb128(p, end, count) || !tryReadUleb128(p, end, skip) ||
+            !rebaseTimes(count, skip)) {
+          return false;
+        }
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Runs the rebase stream described by `command` of the image at `image`,
+  /// which must be `imageSize` bytes long.
+  template <typename Target, typename ByteOrder>
+  bool interpret(
+    const void * image,
+    size_t imageSize,
+    const DyldInfoCommand<Target, ByteOrder>& command,
+    RebaseBitmap& bitmap) {
+    uint64_t offset = command.getRebaseOffset();
+    uint64_t size = command.getRebaseSize();
+    if (offset > imageSize || size > imageSize - offset) {
+      bitmap.clear();
+      return false;
+    }
+    auto begin = static_cast<const uint8_t *>(image) + offset;
+    return interpret(begin, begin + size, bitmap);
+  }
+};
+
+} // namespace dcl::Binary::Darwin::Dyld
+
+#endif // DCL_BINARY_DARWIN_DYLD_REBASEBITMAP_H
@@ -16,10 +16,8 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <cstddef>
-#include <mach-o/fixup-chains.h>
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
 
 namespace dcl::Binary::Darwin::Dyld {
 
@@ -136,6 +134,4 @@ public:
 
 } // namespace dcl::Binary::Darwin::Dyld
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_DYLD_TRAITS_H
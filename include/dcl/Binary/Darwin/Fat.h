@@ -16,12 +16,15 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
-#include <mach-o/fat.h>
+#include <vector>
+#include <dcl/Binary/Darwin/ABI/Fat.h>
 
+#include <dcl/Binary/Darwin/FieldLayouts.h>
+#include <dcl/Binary/Darwin/Format.h>
+#include <dcl/Platform/BulkByteSwap.h>
 #include <dcl/Platform/TypeWrapper.h>
 
 namespace dcl {
@@ -39,14 +42,20 @@ public:
 
   DCL_PLATFORM_TYPE_GETTER(uint32_t, ArchCount, nfat_arch);
 };
+/// An arch of a fat file, which is either a `fat_arch` or a `fat_arch_64`
+/// depending on `Target::FatArchTy`.
 template <typename Target, typename ByteOrder>
 class FatArch
   : public Platform::TypeWrapper<typename Target::FatArchTy, ByteOrder> {
 
 public:
-  DCL_PLATFORM_TYPE_GETTER(uint32_t, Offset, offset);
+  DCL_PLATFORM_TYPE_GETTER(cpu_type_t, CPUType, cputype);
+
+  DCL_PLATFORM_TYPE_GETTER(cpu_subtype_t, CPUSubtype, cpusubtype);
 
-  DCL_PLATFORM_TYPE_GETTER(uint32_t, Size, size);
+  DCL_PLATFORM_TYPE_GETTER(uint64_t, Offset, offset);
+
+  DCL_PLATFORM_TYPE_GETTER(uint64_t, Size, size);
 
   DCL_PLATFORM_TYPE_GETTER(uint32_t, Align, align);
 };
@@ -78,19 +87,15 @@ public:
   Iterator end() { return const_cast<Iterator>(std::as_const(*this).end()); }
 
   DCL_ALWAYS_INLINE
-  const Iterator begin() const {
-    return const_cast<Iterator>(std::as_const(*this).begin());
-  }
+  const Iterator begin() const { return const_cast<Iterator>(cbegin()); }
 
   DCL_ALWAYS_INLINE
-  const Iterator end() const {
-    return const_cast<Iterator>(std::as_const(*this).end());
-  }
+  const Iterator end() const { return const_cast<Iterator>(cend()); }
 
   DCL_ALWAYS_INLINE
   ConstIterator cbegin() const {
     return reinterpret_cast<ConstIterator>(
-      getHeader()->getBase() + (uintptr_t)sizeof(getHeader()));
+      getHeader()->getBase() + sizeof(typename Target::FatHeaderTy));
   }
 
   DCL_ALWAYS_INLINE
@@ -105,12 +110,222 @@ public:
   }
 };
 
+#pragma mark - Fat Arch Index
+
+/// An arch of a fat file in host byte order, whichever of `fat_arch` and
+/// `fat_arch_64` it was read from.
+class FatArchEntry {
+public:
+  uint64_t offset;
+
+  uint64_t size;
+
+  cpu_type_t cputype;
+
+  cpu_subtype_t cpusubtype;
+
+  uint32_t align;
+};
+
+namespace details {
+
+template <typename ArchTy>
+class FatArchTarget {
+public:
+  using FatHeaderTy = fat_header;
+
+  using FatArchTy = ArchTy;
+};
+
+/// How well code of `cputype` and `cpusubtype` runs on a process of
+/// `processType` and `processSubtype`, after the grading of dyld: zero if it
+/// does not run at all, and the higher the better otherwise. A process
+/// subtype of `CPU_SUBTYPE_ANY` runs every subtype of its type equally well.
+DCL_ALWAYS_INLINE
+inline uint32_t GradeCPU(
+  cpu_type_t processType,
+  cpu_subtype_t processSubtype,
+  cpu_type_t cputype,
+  cpu_subtype_t cpusubtype) {
+  if (processType != cputype) {
+    return 0;
+  }
+  if (processSubtype == CPU_SUBTYPE_ANY) {
+    return 1;
+  }
+  processSubtype &= ~CPU_SUBTYPE_MASK;
+  cpusubtype &= ~CPU_SUBTYPE_MASK;
+  if (processSubtype == cpusubtype) {
+    return 3;
+  }
+  switch (cputype) {
+  case CPU_TYPE_X86_64:
+    // Haswell processes run plain x86_64 code, not the other way around.
+    return processSubtype == CPU_SUBTYPE_X86_64_H &&
+               cpusubtype == CPU_SUBTYPE_X86_64_ALL
+             ? 2
+             : 0;
+  case CPU_TYPE_ARM64:
+    // arm64e processes run arm64 code, but arm64 processes cannot
+    // authenticate pointers of arm64e code.
+    if (cpusubtype == CPU_SUBTYPE_ARM64E) {
+      return 0;
+    }
+    return cpusubtype == CPU_SUBTYPE_ARM64_ALL ? 2 : 1;
+  case CPU_TYPE_X86:
+    return cpusubtype == CPU_SUBTYPE_I386_ALL ? 1 : 0;
+  default:
+    return cpusubtype == 0 ? 1 : 0;
+  }
+}
+
+} // namespace details
+
+/// The archs of a fat file, swapped to host byte order once so that looking
+/// up a slice does not touch the fat header again.
+class FatArchIndex {
+
+private:
+  std::vector<FatArchEntry> _entries;
+
+public:
+  /// Replaces the contents of the index with the archs of the fat file of
+  /// `size` bytes at `bytes`. Returns false, leaving the index empty, if the
+  /// bytes are not a fat file or an arch lies out of them.
+  DCL_ALWAYS_INLINE
+  bool build(const void * bytes, size_t size) {
+    return build(bytes, size, size);
+  }
+
+  /// Builds the index from the first `headerSize` bytes of a fat file of
+  /// `fileSize` bytes, e.g. from its first page alone.
+  bool build(const void * header, size_t headerSize, uint64_t fileSize) {
+    _entries.clear();
+    if (!header || headerSize < sizeof(fat_header)) {
+      return false;
+    }
+    bool isValid = false;
+    switch (GetFormatWithBytes<FatMagic>(header)) {
+    case Format::LittleEndianess32Bit:
+      isValid = buildWith<fat_arch, Platform::LittleEndianess>(
+        header, headerSize, fileSize);
+      break;
+    case Format::BigEndianess32Bit:
+      isValid = buildWith<fat_arch, Platform::BigEndianess>(
+        header, headerSize, fileSize);
+      break;
+    case Format::LittleEndianess64Bit:
+      isValid = buildWith<fat_arch_64, Platform::LittleEndianess>(
+        header, headerSize, fileSize);
+      break;
+    case Format::BigEndianess64Bit:
+      isValid = buildWith<fat_arch_64, Platform::BigEndianess>(
+        header, headerSize, fileSize);
+      break;
+    case Format::Unknown:
+      break;
+    }
+    if (!isValid) {
+      _entries.clear();
+    }
+    return isValid;
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _entries.size(); }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _entries.empty(); }
+
+  DCL_ALWAYS_INLINE
+  const FatArchEntry& operator[](size_t index) const {
+    return _entries[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  const FatArchEntry * begin() const { return _entries.data(); }
+
+  DCL_ALWAYS_INLINE
+  const FatArchEntry * end() const {
+    return _entries.data() + _entries.size();
+  }
+
+  /// The first arch of `cputype`, or `nullptr`. Fat files have a handful of
+  /// archs at most, which are scanned without touching the file.
+  const FatArchEntry * find(cpu_type_t cputype) const {
+    for (const FatArchEntry& eachEntry : _entries) {
+      if (eachEntry.cputype == cputype) {
+        return &eachEntry;
+      }
+    }
+    return nullptr;
+  }
+
+  /// The arch of `cputype` and `cpusubtype`, ignoring the capability bits of
+  /// subtypes, or `nullptr`.
+  const FatArchEntry *
+  find(cpu_type_t cputype, cpu_subtype_t cpusubtype) const {
+    for (const FatArchEntry& eachEntry : _entries) {
+      if (
+        eachEntry.cputype == cputype &&
+        ((eachEntry.cpusubtype ^ cpusubtype) & ~CPU_SUBTYPE_MASK) == 0) {
+        return &eachEntry;
+      }
+    }
+    return nullptr;
+  }
+
+  /// The arch that runs best on a process of `cputype` and `cpusubtype`,
+  /// graded by `details::GradeCPU`, or `nullptr` if none runs. The first of
+  /// equally graded archs wins.
+  const FatArchEntry *
+  select(cpu_type_t cputype, cpu_subtype_t cpusubtype) const {
+    const FatArchEntry * best = nullptr;
+    uint32_t bestGrade = 0;
+    for (const FatArchEntry& eachEntry : _entries) {
+      uint32_t grade = details::GradeCPU(
+        cputype, cpusubtype, eachEntry.cputype, eachEntry.cpusubtype);
+      if (grade > bestGrade) {
+        best = &eachEntry;
+        bestGrade = grade;
+      }
+    }
+    return best;
+  }
+
+private:
+  template <typename ArchTy, typename ByteOrder>
+  bool
+  buildWith(const void * header, size_t headerSize, uint64_t fileSize) {
+    using HeaderTy = FatHeader<details::FatArchTarget<ArchTy>, ByteOrder>;
+    using ArchWrapperTy = FatArch<details::FatArchTarget<ArchTy>, ByteOrder>;
+    auto base = static_cast<const uint8_t *>(header);
+    uint32_t count = reinterpret_cast<const HeaderTy *>(base)->getArchCount();
+    if ((headerSize - sizeof(fat_header)) / sizeof(ArchTy) < count) {
+      return false;
+    }
+    std::vector<ArchTy> archs(count);
+    Platform::BulkSwapToHost(
+      reinterpret_cast<const ArchWrapperTy *>(base + sizeof(fat_header)),
+      count,
+      archs.data());
+    _entries.resize(count);
+    for (uint32_t index = 0; index < count; index++) {
+      const ArchTy& arch = archs[index];
+      if (arch.offset > fileSize || arch.size > fileSize - arch.offset) {
+        return false;
+      }
+      _entries[index] = FatArchEntry{
+        arch.offset, arch.size, arch.cputype, arch.cpusubtype, arch.align};
+    }
+    return true;
+  }
+};
+
 } // namespace Darwin
 
 } // namespace Binary
 
 } // namespace dcl
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_FAT_H
@@ -0,0 +1,81 @@
+//===--- FieldLayouts.h - Field Layouts of Darwin Structs -------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  Compile-time field descriptions of the Mach-O and fat structs which are
+//  stored in arrays, so that they can be swapped with
+//  `Platform::BulkSwapToHost`.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_FIELDLAYOUTS_H
+#define DCL_BINARY_DARWIN_FIELDLAYOUTS_H
+
+#include <dcl/Basic/Basic.h>
+#include <dcl/Binary/Darwin/ABI/Fat.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+#include <dcl/Binary/Darwin/ABI/Nlist.h>
+#include <dcl/Platform/BulkByteSwap.h>
+
+namespace dcl::Platform {
+
+#define DCL_DARWIN_FIELD_LAYOUT(STRUCT, ...)                                   \
+  template <>                                                                  \
+  class FieldLayoutOf<STRUCT> {                                                \
+  public:                                                                      \
+    using Type = FieldLayout<__VA_ARGS__>;                                     \
+    static_assert(Type::size == sizeof(STRUCT));                               \
+  };
+
+#pragma mark - Mach-O
+
+DCL_DARWIN_FIELD_LAYOUT(mach_header, Field<4, 7>)
+DCL_DARWIN_FIELD_LAYOUT(mach_header_64, Field<4, 8>)
+DCL_DARWIN_FIELD_LAYOUT(load_command, Field<4, 2>)
+DCL_DARWIN_FIELD_LAYOUT(
+  segment_command,
+  Field<4, 2>,
+  Field<1, 16>,
+  Field<4, 8>)
+DCL_DARWIN_FIELD_LAYOUT(
+  segment_command_64,
+  Field<4, 2>,
+  Field<1, 16>,
+  Field<8, 4>,
+  Field<4, 4>)
+DCL_DARWIN_FIELD_LAYOUT(section, Field<1, 32>, Field<4, 9>)
+DCL_DARWIN_FIELD_LAYOUT(section_64, Field<1, 32>, Field<8, 2>, Field<4, 8>)
+DCL_DARWIN_FIELD_LAYOUT(symtab_command, Field<4, 6>)
+DCL_DARWIN_FIELD_LAYOUT(dyld_info_command, Field<4, 12>)
+DCL_DARWIN_FIELD_LAYOUT(linkedit_data_command, Field<4, 4>)
+
+#pragma mark - Symbol Table
+
+DCL_DARWIN_FIELD_LAYOUT(
+  struct nlist,
+  Field<4>,
+  Field<1, 2>,
+  Field<2>,
+  Field<4>)
+DCL_DARWIN_FIELD_LAYOUT(nlist_64, Field<4>, Field<1, 2>, Field<2>, Field<8>)
+
+#pragma mark - Fat
+
+DCL_DARWIN_FIELD_LAYOUT(fat_header, Field<4, 2>)
+DCL_DARWIN_FIELD_LAYOUT(fat_arch, Field<4, 5>)
+DCL_DARWIN_FIELD_LAYOUT(fat_arch_64, Field<4, 2>, Field<8, 2>, Field<4, 2>)
+
+#undef DCL_DARWIN_FIELD_LAYOUT
+
+} // namespace dcl::Platform
+
+#endif // DCL_BINARY_DARWIN_FIELDLAYOUTS_H
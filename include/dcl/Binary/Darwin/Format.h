@@ -16,11 +16,9 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <cstdint>
-#include <mach-o/fat.h>
-#include <mach-o/loader.h>
+#include <dcl/Binary/Darwin/ABI/Fat.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
 
 namespace dcl {
 
@@ -102,6 +100,4 @@ static Format GetFormatWithBytes(const void * bytes) noexcept {
 
 } // namespace dcl
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_FORMAT_H
@@ -16,8 +16,6 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <dcl/Binary/Darwin/Traits.h>
 
 #include <utility>
@@ -205,6 +203,46 @@ public:
   }
 };
 
+/// Iterates the commands of one kind recorded in a `LoadCommandIndex`.
+template <typename Target, typename ByteOrder>
+class LoadCommandIndexIterator
+  : public ForwardIterator<LoadCommandIndexIterator<Target, ByteOrder>> {
+
+private:
+  uint8_t * _header;
+
+  const uint32_t * _offset;
+
+public:
+  using difference_type = typename ForwardIterator<
+    LoadCommandIndexIterator<Target, ByteOrder>>::difference_type;
+
+  DCL_ALWAYS_INLINE
+  LoadCommandIndexIterator(uint8_t * header, const uint32_t * offset)
+    : _header(header), _offset(offset) {}
+
+  DCL_ALWAYS_INLINE
+  LoadCommand<Target, ByteOrder> * get() {
+    return reinterpret_cast<LoadCommand<Target, ByteOrder> *>(
+      _header + *_offset);
+  }
+
+  DCL_ALWAYS_INLINE
+  LoadCommand<Target, ByteOrder> * const get() const {
+    return reinterpret_cast<LoadCommand<Target, ByteOrder> *>(
+      _header + *_offset);
+  }
+
+  DCL_ALWAYS_INLINE
+  void advance(difference_type distance) { _offset += distance; }
+
+  DCL_ALWAYS_INLINE
+  bool
+  isEqual(const LoadCommandIndexIterator<Target, ByteOrder>& other) const {
+    return _offset == other._offset;
+  }
+};
+
 template <typename Target, typename ByteOrder>
 class Section;
 
@@ -254,6 +292,4 @@ public:
 
 } // namespace dcl
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_ITERATORS_H
@@ -0,0 +1,190 @@
+//===--- LoadCommandIndex.h - Load Commands Indexed by Kind -----*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_LOADCOMMANDINDEX_H
+#define DCL_BINARY_DARWIN_LOADCOMMANDINDEX_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Iterators.h>
+#include <dcl/Binary/Darwin/MachO.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dcl::Binary::Darwin {
+
+namespace details {
+
+/// Load command kinds are small integers, optionally tagged with
+/// `LC_REQ_DYLD`. Both halves get 64 slots so that e.g. `LC_DYLD_INFO` and
+/// `LC_DYLD_INFO_ONLY` stay apart.
+DCL_CONSTEXPR
+static const size_t kLoadCommandSlotCount = 128;
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static size_t GetLoadCommandSlot(uint32_t command) {
+  uint32_t kind = command & ~LC_REQ_DYLD;
+  if (kind >= kLoadCommandSlotCount / 2) {
+    return kLoadCommandSlotCount;
+  }
+  return kind | ((command & LC_REQ_DYLD) ? kLoadCommandSlotCount / 2 : 0);
+}
+
+} // namespace details
+
+/// An index of the load commands of a Mach-O header, built in one pass.
+///
+/// The offsets of all commands are kept in a single flat array, grouped by
+/// kind and in file order within each kind. Looking up the commands of a
+/// kind is then a constant-time slice of that array. Commands of unknown
+/// kinds are not indexed, and walking stops at the first command that does
+/// not fit in `sizeofcmds`.
+template <typename Target, typename ByteOrder>
+class LoadCommandIndex {
+
+public:
+  using CommandKind = typename Target::LoadCommandKindTy;
+
+  using Iterator = LoadCommandIndexIterator<Target, ByteOrder>;
+
+  /// The commands of one kind.
+  class Range {
+
+  private:
+    Iterator _begin;
+
+    Iterator _end;
+
+  public:
+    DCL_ALWAYS_INLINE
+    Range(Iterator begin, Iterator end) : _begin(begin), _end(end) {}
+
+    DCL_ALWAYS_INLINE
+    Iterator begin() const { return _begin; }
+
+    DCL_ALWAYS_INLINE
+    Iterator end() const { return _end; }
+
+    DCL_ALWAYS_INLINE
+    bool empty() const { return _begin == _end; }
+  };
+
+private:
+  MachHeader<Target, ByteOrder> * _header;
+
+  /// `_starts[slot]` is where the offsets of that slot begin in `_offsets`.
+  std::array<uint32_t, details::kLoadCommandSlotCount + 1> _starts;
+
+  std::vector<uint32_t> _offsets;
+
+public:
+  explicit LoadCommandIndex(MachHeader<Target, ByteOrder> * header)
+    : _header(header), _starts{} {
+    auto base = reinterpret_cast<const uint8_t *>(header);
+    uint32_t numberOfCommands = header->getNumberOfCommands();
+    uint64_t offset = sizeof(MachHeader<Target, ByteOrder>);
+    uint64_t end = offset + header->getSizeOfCommands();
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint8_t> slots;
+    // `ncmds` is not trusted, but no more commands fit in `sizeofcmds`.
+    size_t capacity = std::min<size_t>(
+      numberOfCommands, header->getSizeOfCommands() / sizeof(load_command));
+    offsets.reserve(capacity);
+    slots.reserve(capacity);
+
+    for (uint32_t index = 0; index < numberOfCommands; index++) {
+      if (offset + sizeof(load_command) > end) {
+        break;
+      }
+      auto command =
+        reinterpret_cast<const LoadCommand<Target, ByteOrder> *>(base + offset);
+      uint32_t commandSize = command->getCommandSize();
+      if (commandSize < sizeof(load_command) || offset + commandSize > end) {
+        break;
+      }
+      size_t slot = details::GetLoadCommandSlot(
+        static_cast<uint32_t>(command->getCommand()));
+      if (slot < details::kLoadCommandSlotCount) {
+        offsets.push_back(static_cast<uint32_t>(offset));
+        slots.push_back(static_cast<uint8_t>(slot));
+        _starts[slot + 1]++;
+      }
+      offset += commandSize;
+    }
+
+    for (size_t slot = 0; slot < details::kLoadCommandSlotCount; slot++) {
+      _starts[slot + 1] += _starts[slot];
+    }
+
+    auto cursors = _starts;
+    _offsets.resize(offsets.size());
+    for (size_t index = 0; index < offsets.size(); index++) {
+      _offsets[cursors[slots[index]]++] = offsets[index];
+    }
+  }
+
+  DCL_ALWAYS_INLINE
+  MachHeader<Target, ByteOrder> * getHeader() const { return _header; }
+
+  /// The number of indexed commands.
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _offsets.size(); }
+
+  DCL_ALWAYS_INLINE
+  size_t count(CommandKind kind) const {
+    size_t slot = details::GetLoadCommandSlot(static_cast<uint32_t>(kind));
+    if (slot >= details::kLoadCommandSlotCount) {
+      return 0;
+    }
+    return _starts[slot + 1] - _starts[slot];
+  }
+
+  DCL_ALWAYS_INLINE
+  Range all(CommandKind kind) const {
+    size_t slot = details::GetLoadCommandSlot(static_cast<uint32_t>(kind));
+    if (slot >= details::kLoadCommandSlotCount) {
+      return Range{makeIterator(0), makeIterator(0)};
+    }
+    return Range{makeIterator(_starts[slot]), makeIterator(_starts[slot + 1])};
+  }
+
+  /// The first command of `kind` in file order viewed as `Command`, or
+  /// `nullptr` if there is none.
+  template <template <typename, typename> class Command = LoadCommand>
+  DCL_ALWAYS_INLINE
+  Command<Target, ByteOrder> * first(CommandKind kind) const {
+    if (count(kind) == 0) {
+      return nullptr;
+    }
+    size_t slot = details::GetLoadCommandSlot(static_cast<uint32_t>(kind));
+    return reinterpret_cast<Command<Target, ByteOrder> *>(
+      reinterpret_cast<uint8_t *>(_header) + _offsets[_starts[slot]]);
+  }
+
+private:
+  DCL_ALWAYS_INLINE
+  Iterator makeIterator(size_t position) const {
+    return Iterator{
+      reinterpret_cast<uint8_t *>(_header), _offsets.data() + position};
+  }
+};
+
+} // namespace dcl::Binary::Darwin
+
+#endif // DCL_BINARY_DARWIN_LOADCOMMANDINDEX_H
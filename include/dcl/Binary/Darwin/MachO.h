@@ -16,14 +16,13 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <dcl/Binary/Darwin/Targets.h>
 #include <dcl/Binary/Darwin/Traits.h>
 #include <dcl/Platform/TypeWrapper.h>
 
 #include <cstdint>
-#include <mach-o/loader.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+#include <dcl/Binary/Darwin/ABI/Nlist.h>
 
 namespace dcl {
 
@@ -164,7 +163,7 @@ class MachHeader
 public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, Magic, magic);
 
-  DCL_PLATFORM_TYPE_GETTER(uint32_t, NumberOfCommands, cnmds);
+  DCL_PLATFORM_TYPE_GETTER(uint32_t, NumberOfCommands, ncmds);
 
   DCL_PLATFORM_TYPE_GETTER(uint32_t, SizeOfCommands, sizeofcmds);
 
@@ -245,7 +244,7 @@ class DyldInfoCommand
 public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, RebaseOffset, rebase_off);
 
-  DCL_PLATFORM_TYPE_GETTER(uint32_t, RebaseSize, reabse_size);
+  DCL_PLATFORM_TYPE_GETTER(uint32_t, RebaseSize, rebase_size);
 
   DCL_PLATFORM_TYPE_GETTER(uint32_t, BindingInfoOffset, bind_off);
 
@@ -371,12 +370,44 @@ public:
   DCL_PLATFORM_TYPE_GETTER(uint32_t, DataSize, datasize);
 };
 
+#pragma mark - Symbols
+
+template <typename Target, typename ByteOrder>
+class Nlist
+  : public Platform::TypeWrapper<typename Target::NlistTy, ByteOrder> {
+
+public:
+  using PointerValueTy = typename Target::PointerValueTy;
+
+public:
+  DCL_PLATFORM_TYPE_GETTER(uint32_t, StringIndex, n_un.n_strx);
+
+  DCL_PLATFORM_TYPE_GETTER(uint8_t, Type, n_type);
+
+  DCL_PLATFORM_TYPE_GETTER(uint8_t, SectionIndex, n_sect);
+
+  DCL_PLATFORM_TYPE_GETTER(uint16_t, Description, n_desc);
+
+  DCL_PLATFORM_TYPE_GETTER(PointerValueTy, Value, n_value);
+
+  DCL_ALWAYS_INLINE
+  bool isDebugging() const { return (getType() & N_STAB) != 0; }
+
+  DCL_ALWAYS_INLINE
+  bool isExternal() const { return (getType() & N_EXT) != 0; }
+
+  /// Whether the symbol is defined in a section of this image, i.e. whether
+  /// its value is an address.
+  DCL_ALWAYS_INLINE
+  bool isDefinedInSection() const {
+    return !isDebugging() && (getType() & N_TYPE) == N_SECT;
+  }
+};
+
 } // namespace Darwin
 
 } // namespace Binary
 
 } // namespace dcl
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_MACHO_H
@@ -0,0 +1,314 @@
+//===--- MachOStream.h - Mach-O Read from a Stream --------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_MACHOSTREAM_H
+#define DCL_BINARY_DARWIN_MACHOSTREAM_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Fat.h>
+#include <dcl/Binary/Darwin/Format.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/MachOVerifier.h>
+#include <dcl/Binary/Darwin/MachOView.h>
+#include <dcl/IO/StreamReader.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace dcl::Binary::Darwin {
+
+/// Parses a Mach-O or fat file as it is read from an `IO::StreamReader`,
+/// e.g. from a pipe, without spilling it to disk first.
+///
+/// Only the fat header, then the Mach-O header and the load commands of one
+/// slice are buffered, which is a lookahead of `sizeofcmds` bytes at most.
+/// Ranges of the slice such as `__LINKEDIT` are fetched afterwards on
+/// demand, in increasing order of offset since the stream cannot go back.
+class MachOStream {
+
+private:
+  IO::StreamReader& _stream;
+
+  FatArchIndex _fatArchs;
+
+  /// The Mach-O header and the load commands of the slice.
+  std::vector<uint8_t> _header;
+
+  uint64_t _sliceOffset;
+
+  Format _format;
+
+public:
+  DCL_CONSTEXPR
+  static const size_t kChunkSize = 1024 * 1024;
+
+  /// Reads `stream`, which must outlive the parser, from its current
+  /// offset.
+  DCL_ALWAYS_INLINE
+  explicit MachOStream(IO::StreamReader& stream)
+    : _stream(stream), _sliceOffset(stream.getOffset()),
+      _format(Format::Unknown) {}
+
+  MachOStream(const MachOStream&) = delete;
+
+  MachOStream& operator=(const MachOStream&) = delete;
+
+#pragma mark - Reading Headers
+
+  /// Reads the Mach-O header and the load commands of the slice that runs
+  /// best on a process of `cputype` and `cpusubtype`, see
+  /// `FatArchIndex::select`, skipping the slices before it. Any CPU type
+  /// takes the first slice of the stream. Returns false if the stream is
+  /// not a Mach-O or fat file, no slice runs, or the load commands exceed
+  /// the lookahead or fail `MachOVerifier::verifyLoadCommands`.
+  bool readHeader(
+    cpu_type_t cputype = CPU_TYPE_ANY,
+    cpu_subtype_t cpusubtype = CPU_SUBTYPE_ANY) {
+    _header.clear();
+    _format = Format::Unknown;
+    auto magic = _stream.peek(sizeof(uint32_t));
+    if (!magic) {
+      return false;
+    }
+    bool isFat = GetFormatWithBytes<FatMagic>(magic) != Format::Unknown;
+    if (isFat) {
+      if (!readFatHeader(cputype, cpusubtype)) {
+        return false;
+      }
+    } else {
+      _fatArchs = FatArchIndex{};
+      _sliceOffset = _stream.getOffset();
+    }
+    if (!readMachHeader()) {
+      return false;
+    }
+    // The slice of a fat stream is selected by its arch already.
+    if (isFat || cputype == CPU_TYPE_ANY) {
+      return true;
+    }
+    if (!getView().selectSlice(cputype, cpusubtype)) {
+      _header.clear();
+      _format = Format::Unknown;
+      return false;
+    }
+    return true;
+  }
+
+  /// The format of the Mach-O header read, or `Format::Unknown`.
+  DCL_ALWAYS_INLINE
+  Format getFormat() const { return _format; }
+
+  /// The archs of a fat stream in host byte order, or none for a Mach-O
+  /// stream.
+  DCL_ALWAYS_INLINE
+  const FatArchIndex& getFatArchs() const { return _fatArchs; }
+
+  /// The offset of the slice in the stream.
+  DCL_ALWAYS_INLINE
+  uint64_t getSliceOffset() const { return _sliceOffset; }
+
+  DCL_ALWAYS_INLINE
+  const void * getHeaderBytes() const { return _header.data(); }
+
+  /// The size of the Mach-O header and the load commands.
+  DCL_ALWAYS_INLINE
+  size_t getHeaderSize() const { return _header.size(); }
+
+  /// A view of the Mach-O header and the load commands, which were verified
+  /// as read. Only they can be read through it, the ranges they refer to
+  /// are not buffered.
+  DCL_ALWAYS_INLINE
+  MachOView getView() {
+    return MachOView{_header.empty() ? nullptr : _header.data()};
+  }
+
+  /// The Mach-O header read, or `nullptr` if it has another format.
+  template <typename Target, typename ByteOrder>
+  DCL_ALWAYS_INLINE
+  MachHeader<Target, ByteOrder> * getHeader() {
+    if (_format != getFormatOf<Target, ByteOrder>()) {
+      return nullptr;
+    }
+    return reinterpret_cast<MachHeader<Target, ByteOrder> *>(_header.data());
+  }
+
+#pragma mark - Fetching Ranges
+
+  /// Reads [`offset`, `offset + size`) of the slice into `bytes`, skipping
+  /// the stream up to it. Returns false if the range was already passed or
+  /// the stream ends before it.
+  bool fetch(uint64_t offset, uint64_t size, std::vector<uint8_t>& bytes) {
+    bytes.clear();
+    if (_header.empty() || !_stream.skipTo(_sliceOffset + offset)) {
+      return false;
+    }
+    // Grows with the bytes read, such that a malformed size fails at the
+    // end of the stream rather than allocating all of it up front.
+    while (bytes.size() < size) {
+      size_t chunkSize = static_cast<size_t>(
+        std::min<uint64_t>(size - bytes.size(), kChunkSize));
+      bytes.resize(bytes.size() + chunkSize);
+      if (!_stream.read(bytes.data() + bytes.size() - chunkSize, chunkSize)) {
+        bytes.clear();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Fetches the contents of the segment named `name`, see `fetch`. The
+  /// file offset of the segment is stored to `fileOffset`, such that offsets
+  /// into it, e.g. of the symbol table into `__LINKEDIT`, can be rebased.
+  template <typename Target, typename ByteOrder>
+  bool fetchSegment(
+    const char * name, std::vector<uint8_t>& bytes, uint64_t& fileOffset) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    using SegmentTy = SegmentCommand<Target, ByteOrder>;
+    bytes.clear();
+    auto header = getHeader<Target, ByteOrder>();
+    if (!header) {
+      return false;
+    }
+    LoadCommandIndex<Target, ByteOrder> commands{header};
+    for (auto& eachCommand : commands.all(CommandKind::Semgent)) {
+      if (eachCommand.getCommandSize() < sizeof(SegmentTy)) {
+        continue;
+      }
+      auto segment = reinterpret_cast<SegmentTy *>(&eachCommand);
+      const char * segmentName = segment->getWrappedValue().segname;
+      if (std::strncmp(segmentName, name, sizeof(segment_command::segname))) {
+        continue;
+      }
+      fileOffset = segment->getFileOffset();
+      return fetch(fileOffset, segment->getFileSize(), bytes);
+    }
+    return false;
+  }
+
+  /// Fetches the contents of `__LINKEDIT`, see `fetchSegment`.
+  template <typename Target, typename ByteOrder>
+  DCL_ALWAYS_INLINE
+  bool fetchLinkEdit(std::vector<uint8_t>& bytes, uint64_t& fileOffset) {
+    return fetchSegment<Target, ByteOrder>("__LINKEDIT", bytes, fileOffset);
+  }
+
+private:
+  template <typename Target, typename ByteOrder>
+  DCL_ALWAYS_INLINE
+  static Format getFormatOf() {
+    bool is64Bit = sizeof(typename Target::MachHeaderTy) ==
+                   sizeof(mach_header_64);
+    if (std::is_same<ByteOrder, Platform::LittleEndianess>::value) {
+      return is64Bit ? Format::LittleEndianess64Bit
+                     : Format::LittleEndianess32Bit;
+    }
+    return is64Bit ? Format::BigEndianess64Bit : Format::BigEndianess32Bit;
+  }
+
+  bool readFatHeader(cpu_type_t cputype, cpu_subtype_t cpusubtype) {
+    auto bytes = _stream.peek(sizeof(fat_header));
+    if (!bytes) {
+      return false;
+    }
+    Format format = GetFormatWithBytes<FatMagic>(bytes);
+    bool is64Bit = format == Format::LittleEndianess64Bit ||
+                   format == Format::BigEndianess64Bit;
+    fat_header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    uint32_t archCount =
+      format == Format::LittleEndianess32Bit ||
+          format == Format::LittleEndianess64Bit
+        ? Platform::LittleEndianess::swapToHost(header.nfat_arch)
+        : Platform::BigEndianess::swapToHost(header.nfat_arch);
+    uint64_t headerSize = sizeof(fat_header) +
+                          uint64_t(archCount) *
+                            (is64Bit ? sizeof(fat_arch_64) : sizeof(fat_arch));
+    if (headerSize > _stream.getMaxLookahead()) {
+      return false;
+    }
+    bytes = _stream.peek(headerSize);
+    // The size of the stream is unknown.
+    if (!bytes || !_fatArchs.build(bytes, headerSize, UINT64_MAX)) {
+      return false;
+    }
+
+    const FatArchEntry * arch = nullptr;
+    if (cputype == CPU_TYPE_ANY) {
+      for (const FatArchEntry& eachArch : _fatArchs) {
+        if (!arch || eachArch.offset < arch->offset) {
+          arch = &eachArch;
+        }
+      }
+    } else {
+      arch = _fatArchs.select(cputype, cpusubtype);
+    }
+    if (!arch || arch->offset < headerSize) {
+      return false;
+    }
+    _sliceOffset = _stream.getOffset() + arch->offset;
+    return _stream.skipTo(_sliceOffset);
+  }
+
+  bool readMachHeader() {
+    auto bytes = _stream.peek(sizeof(mach_header));
+    if (!bytes) {
+      return false;
+    }
+    Format format = GetFormatWithBytes<MachOMagic>(bytes);
+    size_t headerSize = sizeof(mach_header);
+    mach_header header;
+    std::memcpy(&header, bytes, sizeof(header));
+    uint32_t sizeOfCommands = 0;
+    switch (format) {
+    case Format::LittleEndianess64Bit:
+      headerSize = sizeof(mach_header_64);
+      [[fallthrough]];
+    case Format::LittleEndianess32Bit:
+      sizeOfCommands =
+        Platform::LittleEndianess::swapToHost(header.sizeofcmds);
+      break;
+    case Format::BigEndianess64Bit:
+      headerSize = sizeof(mach_header_64);
+      [[fallthrough]];
+    case Format::BigEndianess32Bit:
+      sizeOfCommands = Platform::BigEndianess::swapToHost(header.sizeofcmds);
+      break;
+    case Format::Unknown:
+      return false;
+    }
+    uint64_t size = headerSize + uint64_t(sizeOfCommands);
+    if (size > _stream.getMaxLookahead()) {
+      return false;
+    }
+    bytes = _stream.peek(size);
+    if (!bytes || !MachOVerifier::verifyLoadCommands(bytes, size)) {
+      return false;
+    }
+    _header.assign(
+      static_cast<const uint8_t *>(bytes),
+      static_cast<const uint8_t *>(bytes) + size);
+    _format = format;
+    return _stream.skip(size);
+  }
+};
+
+} // namespace dcl::Binary::Darwin
+
+#endif // DCL_BINARY_DARWIN_MACHOSTREAM_H
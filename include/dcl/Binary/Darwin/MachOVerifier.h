@@ -0,0 +1,378 @@
+//===--- MachOVerifier.h - Mach-O Bounds Verification -----------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_MACHOVERIFIER_H
+#define DCL_BINARY_DARWIN_MACHOVERIFIER_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/Format.h>
+#include <dcl/Binary/Darwin/Targets.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <dcl/Binary/Darwin/ABI/Fat.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+
+namespace dcl::Binary::Darwin {
+
+namespace details {
+
+/// Whether [`offset`, `offset + size`) lies within [0, `limit`).
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static bool IsRangeInBounds(uint64_t offset, uint64_t size, uint64_t limit) {
+  return offset <= limit && size <= limit - offset;
+}
+
+/// Whether [`offset`, `offset + count * stride`) lies within [0, `limit`).
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static bool IsArrayInBounds(
+  uint64_t offset, uint64_t count, uint64_t stride, uint64_t limit) {
+  return offset <= limit && count <= (limit - offset) / stride;
+}
+
+} // namespace details
+
+/// Checks in one linear pass that every structure a Mach-O or fat file
+/// describes lies within the file: the fat archs and their slices, the load
+/// commands of each slice and the ranges of the segments, sections and link
+/// edit data they refer to.
+///
+/// Accessors of the file do not check bounds, hence a file from an untrusted
+/// source shall be read only once it is verified.
+class MachOVerifier {
+
+public:
+  /// Whether the `size` bytes at `bytes` are a well-formed Mach-O or fat
+  /// file.
+  static bool verify(const void * bytes, size_t size) {
+    if (!bytes || size < sizeof(uint32_t)) {
+      return false;
+    }
+    switch (GetFormatWithBytes<FatMagic>(bytes)) {
+    case Format::LittleEndianess32Bit:
+      return verifyFat<fat_arch, Platform::LittleEndianess>(bytes, size);
+    case Format::BigEndianess32Bit:
+      return verifyFat<fat_arch, Platform::BigEndianess>(bytes, size);
+    case Format::LittleEndianess64Bit:
+      return verifyFat<fat_arch_64, Platform::LittleEndianess>(bytes, size);
+    case Format::BigEndianess64Bit:
+      return verifyFat<fat_arch_64, Platform::BigEndianess>(bytes, size);
+    case Format::Unknown:
+      return verifyMachO(bytes, size);
+    }
+    return false;
+  }
+
+  /// Whether the `size` bytes at `bytes` are a well-formed Mach-O file,
+  /// which cannot be a fat one.
+  static bool verifyMachO(const void * bytes, size_t size) {
+    return verifyMachO(bytes, size, size);
+  }
+
+  /// Whether the `size` bytes at `bytes` are the header and the load
+  /// commands of a well-formed Mach-O file, e.g. buffered from a stream
+  /// ahead of the rest of the file. The file size is unknown, hence the
+  /// ranges the commands refer to are only checked not to overflow.
+  static bool verifyLoadCommands(const void * bytes, size_t size) {
+    return verifyMachO(bytes, size, UINT64_MAX);
+  }
+
+private:
+  template <typename Struct>
+  DCL_ALWAYS_INLINE
+  static Struct load(const uint8_t * bytes) {
+    Struct value;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+  }
+
+  /// Verifies the Mach-O file at `bytes`, whose header and load commands
+  /// lie in its first `size` bytes and whose ranges lie in its first
+  /// `imageSize` bytes.
+  static bool
+  verifyMachO(const void * bytes, size_t size, uint64_t imageSize) {
+    if (!bytes || size < sizeof(uint32_t)) {
+      return false;
+    }
+    auto begin = static_cast<const uint8_t *>(bytes);
+    switch (GetFormatWithBytes<MachOMagic>(bytes)) {
+    case Format::LittleEndianess32Bit:
+      return verifyImage<Remote<uint32_t>, Platform::LittleEndianess>(
+        begin, size, imageSize);
+    case Format::BigEndianess32Bit:
+      return verifyImage<Remote<uint32_t>, Platform::BigEndianess>(
+        begin, size, imageSize);
+    case Format::LittleEndianess64Bit:
+      return verifyImage<Remote<uint64_t>, Platform::LittleEndianess>(
+        begin, size, imageSize);
+    case Format::BigEndianess64Bit:
+      return verifyImage<Remote<uint64_t>, Platform::BigEndianess>(
+        begin, size, imageSize);
+    case Format::Unknown:
+      return false;
+    }
+    return false;
+  }
+
+  template <typename ArchTy, typename ByteOrder>
+  static bool verifyFat(const void * bytes, size_t size) {
+    auto begin = static_cast<const uint8_t *>(bytes);
+    if (size < sizeof(fat_header)) {
+      return false;
+    }
+    auto header = load<fat_header>(begin);
+    uint32_t archCount = ByteOrder::swapToHost(header.nfat_arch);
+    if (!details::IsArrayInBounds(
+          sizeof(fat_header), archCount, sizeof(ArchTy), size)) {
+      return false;
+    }
+    for (uint32_t index = 0; index < archCount; index++) {
+      auto arch =
+        load<ArchTy>(begin + sizeof(fat_header) + index * sizeof(ArchTy));
+      uint64_t offset = ByteOrder::swapToHost(arch.offset);
+      uint64_t archSize = ByteOrder::swapToHost(arch.size);
+      if (
+        !details::IsRangeInBounds(offset, archSize, size) ||
+        !verifyMachO(begin + offset, archSize)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  template <typename Target, typename ByteOrder>
+  static bool
+  verifyImage(const uint8_t * begin, size_t size, uint64_t imageSize) {
+    using MachHeaderTy = typename Target::MachHeaderTy;
+    if (size < sizeof(MachHeaderTy)) {
+      return false;
+    }
+    auto header = load<MachHeaderTy>(begin);
+    uint32_t commandCount = ByteOrder::swapToHost(header.ncmds);
+    uint64_t commandsSize = ByteOrder::swapToHost(header.sizeofcmds);
+    if (!details::IsRangeInBounds(
+          sizeof(MachHeaderTy), commandsSize, size)) {
+      return false;
+    }
+
+    const uint8_t * command = begin + sizeof(MachHeaderTy);
+    uint64_t remaining = commandsSize;
+    for (uint32_t index = 0; index < commandCount; index++) {
+      if (remaining < sizeof(load_command)) {
+        return false;
+      }
+      auto loadCommand = load<load_command>(command);
+      uint32_t commandSize = ByteOrder::swapToHost(loadCommand.cmdsize);
+      if (
+        commandSize < sizeof(load_command) || commandSize % 4 != 0 ||
+        commandSize > remaining) {
+        return false;
+      }
+      if (!verifyCommand<Target, ByteOrder>(
+            ByteOrder::swapToHost(loadCommand.cmd),
+            command,
+            commandSize,
+            imageSize)) {
+        return false;
+      }
+      command += commandSize;
+      remaining -= commandSize;
+    }
+    return true;
+  }
+
+  /// Verifies a load command of `commandSize` bytes at `command`, in an
+  /// image of `imageSize` bytes.
+  template <typename Target, typename ByteOrder>
+  static bool verifyCommand(
+    uint32_t kind,
+    const uint8_t * command,
+    uint32_t commandSize,
+    uint64_t imageSize) {
+    using SegmentCommandTy = typename Target::SegmentCommandTy;
+    using SectionTy = typename Target::SectionTy;
+    using NlistTy = typename Target::NlistTy;
+    using B = ByteOrder;
+
+    switch (kind) {
+    case LC_SEGMENT:
+    case LC_SEGMENT_64: {
+      if (kind != (sizeof(SegmentCommandTy) == sizeof(segment_command_64)
+                     ? LC_SEGMENT_64
+                     : LC_SEGMENT)) {
+        return false;
+      }
+      if (commandSize < sizeof(SegmentCommandTy)) {
+        return false;
+      }
+      auto segment = load<SegmentCommandTy>(command);
+      uint32_t sectionCount = B::swapToHost(segment.nsects);
+      if (
+        !details::IsRangeInBounds(
+          B::swapToHost(segment.fileoff),
+          B::swapToHost(segment.filesize),
+          imageSize) ||
+        !details::IsArrayInBounds(
+          sizeof(SegmentCommandTy),
+          sectionCount,
+          sizeof(SectionTy),
+          commandSize)) {
+        return false;
+      }
+      for (uint32_t index = 0; index < sectionCount; index++) {
+        auto section = load<SectionTy>(
+          command + sizeof(SegmentCommandTy) + index * sizeof(SectionTy));
+        if (!verifySection<ByteOrder>(section, imageSize)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case LC_SYMTAB: {
+      if (commandSize < sizeof(symtab_command)) {
+        return false;
+      }
+      auto symtab = load<symtab_command>(command);
+      return details::IsArrayInBounds(
+               B::swapToHost(symtab.symoff),
+               B::swapToHost(symtab.nsyms),
+               sizeof(NlistTy),
+               imageSize) &&
+             details::IsRangeInBounds(
+               B::swapToHost(symtab.stroff),
+               B::swapToHost(symtab.strsize),
+               imageSize);
+    }
+    case LC_DYSYMTAB: {
+      if (commandSize < sizeof(dysymtab_command)) {
+        return false;
+      }
+      auto dysymtab = load<dysymtab_command>(command);
+      return details::IsArrayInBounds(
+        B::swapToHost(dysymtab.indirectsymoff),
+        B::swapToHost(dysymtab.nindirectsyms),
+        sizeof(uint32_t),
+        imageSize);
+    }
+    case LC_DYLD_INFO:
+    case LC_DYLD_INFO_ONLY: {
+      if (commandSize < sizeof(dyld_info_command)) {
+        return false;
+      }
+      auto info = load<dyld_info_command>(command);
+      return details::IsRangeInBounds(
+               B::swapToHost(info.rebase_off),
+               B::swapToHost(info.rebase_size),
+               imageSize) &&
+             details::IsRangeInBounds(
+               B::swapToHost(info.bind_off),
+               B::swapToHost(info.bind_size),
+               imageSize) &&
+             details::IsRangeInBounds(
+               B::swapToHost(info.weak_bind_off),
+               B::swapToHost(info.weak_bind_size),
+               imageSize) &&
+             details::IsRangeInBounds(
+               B::swapToHost(info.lazy_bind_off),
+               B::swapToHost(info.lazy_bind_size),
+               imageSize) &&
+             details::IsRangeInBounds(
+               B::swapToHost(info.export_off),
+               B::swapToHost(info.export_size),
+               imageSize);
+    }
+    case LC_CODE_SIGNATURE:
+    case LC_SEGMENT_SPLIT_INFO:
+    case LC_FUNCTION_STARTS:
+    case LC_DATA_IN_CODE:
+    case LC_DYLIB_CODE_SIGN_DRS:
+    case LC_LINKER_OPTIMIZATION_HINT:
+    case LC_DYLD_EXPORTS_TRIE:
+    case LC_DYLD_CHAINED_FIXUPS: {
+      if (commandSize < sizeof(linkedit_data_command)) {
+        return false;
+      }
+      auto data = load<linkedit_data_command>(command);
+      return details::IsRangeInBounds(
+        B::swapToHost(data.dataoff), B::swapToHost(data.datasize), imageSize);
+    }
+    case LC_ID_DYLIB:
+    case LC_LOAD_DYLIB:
+    case LC_LOAD_WEAK_DYLIB:
+    case LC_REEXPORT_DYLIB:
+    case LC_LAZY_LOAD_DYLIB:
+    case LC_LOAD_UPWARD_DYLIB: {
+      if (commandSize < sizeof(dylib_command)) {
+        return false;
+      }
+      auto dylib = load<dylib_command>(command);
+      return verifyString<ByteOrder>(
+        command, commandSize, sizeof(dylib_command), dylib.dylib.name);
+    }
+    case LC_RPATH: {
+      if (commandSize < sizeof(rpath_command)) {
+        return false;
+      }
+      auto rpath = load<rpath_command>(command);
+      return verifyString<ByteOrder>(
+        command, commandSize, sizeof(rpath_command), rpath.path);
+    }
+    default:
+      return true;
+    }
+  }
+
+  template <typename ByteOrder, typename SectionTy>
+  static bool verifySection(const SectionTy& section, uint64_t imageSize) {
+    switch (ByteOrder::swapToHost(section.flags) & SECTION_TYPE) {
+    case S_ZEROFILL:
+    case S_GB_ZEROFILL:
+    case S_THREAD_LOCAL_ZEROFILL:
+      return true;
+    default:
+      break;
+    }
+    uint32_t offset = ByteOrder::swapToHost(section.offset);
+    if (offset == 0) {
+      return true;
+    }
+    return details::IsRangeInBounds(
+      offset, ByteOrder::swapToHost(section.size), imageSize);
+  }
+
+  /// Verifies that `string` points past the fixed part of its command and
+  /// is terminated within the command.
+  template <typename ByteOrder>
+  static bool verifyString(
+    const uint8_t * command,
+    uint32_t commandSize,
+    size_t fixedSize,
+    const union lc_str& string) {
+    uint32_t offset = ByteOrder::swapToHost(string.offset);
+    if (offset < fixedSize || offset >= commandSize) {
+      return false;
+    }
+    return std::memchr(command + offset, '\0', commandSize - offset) !=
+           nullptr;
+  }
+};
+
+} // namespace dcl::Binary::Darwin
+
+#endif // DCL_BINARY_DARWIN_MACHOVERIFIER_H
@@ -15,17 +15,24 @@
 #define DCL_BINARY_DARWIN_MACHOVIEW_H
 
 #include <dcl/Basic/Basic.h>
-
-#if DCL_TARGET_OS_DARWIN
+#include <dcl/Basic/ThreadPool.h>
 
 #include <dcl/Binary/Darwin/Fat.h>
 #include <dcl/Binary/Darwin/Format.h>
 #include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/MachOVerifier.h>
+#include <dcl/IO/File.h>
+#include <dcl/IO/MappedRange.h>
 #include <dcl/Platform/TypeWrapper.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iterator>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace dcl::Binary::Darwin {
 
@@ -98,6 +105,34 @@ public:
 
   DCL_ALWAYS_INLINE
   const MachHeader<Target, Endianess> * getHeader() const { return &_header_; }
+
+  /// Copies the `LC_UUID` of the image to `uuid`. Returns false if the
+  /// image has none.
+  bool copyUUID(uint8_t (&uuid)[16]) const {
+    auto base = reinterpret_cast<const uint8_t *>(&_header_);
+    uint64_t offset = sizeof(_header_);
+    uint64_t end = offset + _header_.getSizeOfCommands();
+    for (uint32_t index = 0; index < _header_.getNumberOfCommands(); index++) {
+      if (offset + sizeof(load_command) > end) {
+        return false;
+      }
+      auto command =
+        reinterpret_cast<const LoadCommand<Target, Endianess> *>(base + offset);
+      uint32_t commandSize = command->getCommandSize();
+      if (commandSize < sizeof(load_command) || offset + commandSize > end) {
+        return false;
+      }
+      if (
+        command->getCommand() == CommandKind::UUID &&
+        commandSize >= sizeof(uuid_command)) {
+        std::memcpy(
+          uuid, base + offset + offsetof(uuid_command, uuid), sizeof(uuid));
+        return true;
+      }
+      offset += commandSize;
+    }
+    return false;
+  }
 };
 
 #pragma mark - Fat
@@ -282,35 +317,47 @@ private:
     DCL_ALWAYS_INLINE
     Format getFatFormat() const { return _format; }
 
-  public:
+    /// Invokes `body` with the `Fat` of the header, or returns `otherwise`
+    /// for an unrecognized header.
+    ///
+    /// The word size of a fat format is the one of its archs, i.e. whether
+    /// they are `fat_arch_64`s, regardless of the Mach-O files they hold.
+    template <typename Body, typename Result>
     DCL_ALWAYS_INLINE
-    Format getMachOFormat() const {
-      // FIXME: fat format is in 64-bit does not mean mach-O is in 64-bit.
-      // format.
+    Result withFat(Body&& body, Result otherwise) const {
       switch (getFatFormat()) {
-      case Format::LittleEndianess64Bit: {
-        auto fat =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header);
-        return fat.getMachOFormatAt(_index);
-      }
-      case Format::LittleEndianess32Bit: {
-        auto fat =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header);
-        return fat.getMachOFormatAt(_index);
-      }
-      case Format::BigEndianess64Bit: {
-        auto fat =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header);
-        return fat.getMachOFormatAt(_index);
-      }
-      case Format::BigEndianess32Bit: {
-        auto fat =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header);
-        return fat.getMachOFormatAt(_index);
-      }
+      case Format::LittleEndianess64Bit:
+        return body(
+          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header));
+      case Format::LittleEndianess32Bit:
+        return body(
+          Fat<details::File<uint32_t>, Platform::LittleEndianess>(_header));
+      case Format::BigEndianess64Bit:
+        return body(
+          Fat<details::File<uint64_t>, Platform::BigEndianess>(_header));
+      case Format::BigEndianess32Bit:
+        return body(
+          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header));
       case Format::Unknown:
-        return Format::Unknown;
+        return otherwise;
       }
+      return otherwise;
+    }
+
+  public:
+    DCL_ALWAYS_INLINE
+    Format getMachOFormat() const {
+      return withFat(
+        [&](auto fat) { return fat.getMachOFormatAt(_index); },
+        Format::Unknown);
+    }
+
+    /// The header of the Mach-O file in the slice.
+    DCL_ALWAYS_INLINE
+    void * getMachOBytes() const {
+      return withFat(
+        [&](auto fat) { return fat.getMachHeaderAt(_index); },
+        static_cast<void *>(nullptr));
     }
 
     template <typename Target, typename Endianess>
@@ -323,63 +370,17 @@ private:
     template <typename Target, typename Endianess>
     DCL_ALWAYS_INLINE
     const MachO<Target, Endianess> * getMachO() const {
-      switch (getFatFormat()) {
-      case Format::LittleEndianess64Bit: {
-        auto fat =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header);
-        return fat.getMachHeaderAt<Target, Endianess>(_index);
-      }
-      case Format::LittleEndianess32Bit: {
-        auto fat =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header);
-        return fat.getMachHeaderAt<Target, Endianess>(_index);
-      }
-      case Format::BigEndianess64Bit: {
-        auto fat =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header);
-        return fat.getMachHeaderAt<Target, Endianess>(_index);
-      }
-      case Format::BigEndianess32Bit: {
-        auto fat =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header);
-        return fat.getMachHeaderAt<Target, Endianess>(_index);
-      }
-      default:
-        return nullptr;
-      }
+      return withFat(
+        [&](const auto& fat) {
+          return fat.template getMachHeaderAt<Target, Endianess>(_index);
+        },
+        static_cast<const MachO<Target, Endianess> *>(nullptr));
     }
 
     DCL_ALWAYS_INLINE
     IteratorFat end() const {
-      uint32_t archCount;
-      switch (getFatFormat()) {
-      case Format::LittleEndianess64Bit: {
-        archCount =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header)
-            .getArchCount();
-        break;
-      }
-      case Format::LittleEndianess32Bit: {
-        archCount =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header)
-            .getArchCount();
-        break;
-      }
-      case Format::BigEndianess64Bit: {
-        archCount =
-          Fat<details::File<uint64_t>, Platform::LittleEndianess>(_header)
-            .getArchCount();
-        break;
-      }
-      case Format::BigEndianess32Bit: {
-        archCount =
-          Fat<details::File<uint32_t>, Platform::BigEndianess>(_header)
-            .getArchCount();
-        break;
-      }
-      case Format::Unknown:
-        archCount = 0;
-      }
+      uint32_t archCount = withFat(
+        [](auto fat) { return uint32_t(fat.getArchCount()); }, uint32_t(0));
       return IteratorFat(_header, _format, archCount, nullptr);
     }
   };
@@ -432,6 +433,9 @@ private:
       return GetFormatWithBytes<MachOMagic>(_header);
     }
 
+    DCL_ALWAYS_INLINE
+    void * getMachOBytes() const { return _header; }
+
     template <typename Target, typename Endianess>
     DCL_ALWAYS_INLINE
     MachO<Target, Endianess> * getMachO() {
@@ -493,22 +497,23 @@ private:
     SliceKind kind;
 
   public:
+    /// Iterates no slices if `header` is null or of an unrecognized magic.
     DCL_ALWAYS_INLINE
-    explicit VariantIterator(void * header) {
+    explicit VariantIterator(void * header)
+      : machO(IteratorMachO(header).end()), kind(SliceKind::MachO) {
+      if (!header) {
+        return;
+      }
       uint32_t magic = *reinterpret_cast<uint32_t *>(header);
       if (
         magic == MH_MAGIC || magic == MH_CIGAM || magic == MH_MAGIC_64 ||
         magic == MH_CIGAM_64) {
         machO = IteratorMachO(header);
-        kind = SliceKind::MachO;
       } else if (
         magic == FAT_MAGIC || magic == FAT_CIGAM || magic == FAT_MAGIC_64 ||
         magic == FAT_CIGAM_64) {
         fat = IteratorFat(header);
         kind = SliceKind::Fat;
-      } else {
-        // Unrecognized magic;
-        exit(1);
       }
     }
 
@@ -633,6 +638,74 @@ public:
         return _machO.getMachO<Target, Endianess>();
       }
     }
+
+    /// Invokes `visitor` with the `MachO<Remote<W>, E>` of the slice, such
+    /// that a generic lambda is instantiated once per format and the format
+    /// is resolved once per slice. Returns false without invoking `visitor`
+    /// if the format is unrecognized.
+    template <typename Visitor>
+    DCL_ALWAYS_INLINE
+    bool visit(Visitor&& visitor) {
+      return visitMachO(getMachOBytes(), std::forward<Visitor>(visitor));
+    }
+
+    template <typename Visitor>
+    DCL_ALWAYS_INLINE
+    bool visit(Visitor&& visitor) const {
+      return visitMachO(
+        static_cast<const void *>(getMachOBytes()),
+        std::forward<Visitor>(visitor));
+    }
+
+  private:
+    DCL_ALWAYS_INLINE
+    void * getMachOBytes() const {
+      switch (_kind) {
+      case SliceKind::Fat:
+        return _fat.getMachOBytes();
+      case SliceKind::MachO:
+        return _machO.getMachOBytes();
+      }
+      return nullptr;
+    }
+
+    /// `Bytes` is either `void` or `const void`, and so is the constness of
+    /// the `MachO` that `visitor` is invoked with.
+    template <typename Bytes, typename Visitor>
+    DCL_ALWAYS_INLINE
+    static bool visitMachO(Bytes * bytes, Visitor&& visitor) {
+      using Big = Platform::BigEndianess;
+      using Little = Platform::LittleEndianess;
+      if (!bytes) {
+        return false;
+      }
+      switch (GetFormatWithBytes<MachOMagic>(bytes)) {
+      case Format::LittleEndianess32Bit:
+        visitor(*cast<Remote<uint32_t>, Little>(bytes));
+        return true;
+      case Format::BigEndianess32Bit:
+        visitor(*cast<Remote<uint32_t>, Big>(bytes));
+        return true;
+      case Format::LittleEndianess64Bit:
+        visitor(*cast<Remote<uint64_t>, Little>(bytes));
+        return true;
+      case Format::BigEndianess64Bit:
+        visitor(*cast<Remote<uint64_t>, Big>(bytes));
+        return true;
+      case Format::Unknown:
+        return false;
+      }
+      return false;
+    }
+
+    template <typename Target, typename Endianess, typename Bytes>
+    DCL_ALWAYS_INLINE
+    static auto cast(Bytes * bytes) {
+      using MachOTy = MachO<Target, Endianess>;
+      using ResultTy = typename std::
+        conditional<std::is_const<Bytes>::value, const MachOTy, MachOTy>::type;
+      return reinterpret_cast<ResultTy *>(bytes);
+    }
   };
 
   class Iterator : public std::iterator<std::forward_iterator_tag, Slice> {
@@ -683,9 +756,58 @@ public:
 private:
   void * _address;
 
+  size_t _size;
+
+  bool _isVerified;
+
+  FatArchIndex _fatArchs;
+
 public:
+  /// The size of the buffer of a view made without one.
+  DCL_CONSTEXPR
+  static const size_t kUnknownSize = SIZE_MAX;
+
+  /// Views a buffer of unknown size, which is trusted to be well-formed.
+  DCL_ALWAYS_INLINE
+  explicit MachOView(void * buffer)
+    : _address(buffer), _size(kUnknownSize), _isVerified(false) {
+    _fatArchs.build(buffer, _size);
+  }
+
+  /// Views `size` bytes at `buffer`, which are verified once by
+  /// `MachOVerifier`. A view of a malformed buffer has no slices, otherwise
+  /// the slices are read without any further bounds checking.
+  DCL_ALWAYS_INLINE
+  MachOView(void * buffer, size_t size)
+    : _address(buffer), _size(size),
+      _isVerified(MachOVerifier::verify(buffer, size)) {
+    if (_isVerified) {
+      _fatArchs.build(buffer, size);
+    }
+  }
+
+  /// Views the contents of `file`, which must outlive the view.
+  DCL_ALWAYS_INLINE
+  explicit MachOView(IO::File& file)
+    : MachOView(file.getBytes(), file.getSize()) {}
+
+  /// Views the contents of `range`, e.g. a slice of a fat file mapped on
+  /// its own, which must outlive the view.
+  DCL_ALWAYS_INLINE
+  explicit MachOView(IO::MappedRange& range)
+    : MachOView(range.getBytes(), range.getSize()) {}
+
+#pragma mark - Verification
+
+  /// Whether the view was made with a size and its buffer passed
+  /// verification.
+  DCL_ALWAYS_INLINE
+  bool isVerified() const { return _isVerified; }
+
+  /// Whether the slices can be read, i.e. whether the buffer is either
+  /// verified or trusted.
   DCL_ALWAYS_INLINE
-  explicit MachOView(void * buffer) : _address(buffer) {}
+  bool isValid() const { return _isVerified || _size == kUnknownSize; }
 
 #pragma mark - Accessing Raw Bytes
 
@@ -697,6 +819,10 @@ public:
   DCL_ALWAYS_INLINE
   const void * getBytes() const { return _address; }
 
+  /// The size of the buffer, or `kUnknownSize`.
+  DCL_ALWAYS_INLINE
+  size_t getSize() const { return _size; }
+
 #pragma mark - Accessing Slices
 
   using value_type = Slice;
@@ -717,10 +843,149 @@ public:
   const Iterator end() const { return cend(); }
 
   DCL_ALWAYS_INLINE
-  ConstIterator cbegin() const { return Iterator::makeBegin(_address); }
+  ConstIterator cbegin() const { return Iterator::makeBegin(getSlices()); }
+
+  DCL_ALWAYS_INLINE
+  ConstIterator cend() const { return Iterator::makeEnd(getSlices()); }
+
+private:
+  DCL_ALWAYS_INLINE
+  void * getSlices() const { return isValid() ? _address : nullptr; }
+
+public:
+
+#pragma mark - Visiting Slices
+
+  /// Invokes `visitor` with the `MachO<Remote<W>, E>` of each slice in
+  /// order, see `Slice::visit`. Returns false if any slice is of an
+  /// unrecognized format.
+  template <typename Visitor>
+  bool visit(Visitor&& visitor) {
+    bool isRecognized = true;
+    for (auto eachSlice : *this) {
+      isRecognized &= eachSlice.visit(visitor);
+    }
+    return isRecognized;
+  }
+
+  template <typename Visitor>
+  bool visit(Visitor&& visitor) const {
+    bool isRecognized = true;
+    for (const auto eachSlice : *this) {
+      isRecognized &= eachSlice.visit(visitor);
+    }
+    return isRecognized;
+  }
+
+  /// Copies the `LC_UUID` of the first slice that has one to `uuid`, e.g.
+  /// to key caches of images. Returns false if no slice has one.
+  bool copyUUID(uint8_t (&uuid)[16]) const {
+    bool isCopied = false;
+    visit([&](const auto& machO) {
+      if (!isCopied) {
+        isCopied = machO.copyUUID(uuid);
+      }
+    });
+    return isCopied;
+  }
+
+#pragma mark - Processing Slices in Parallel
+
+  /// Invokes `body` with each slice on up to `threadCount` threads of the
+  /// shared `ThreadPool`, the calling one included. Zero picks every thread
+  /// of the pool. Slices are disjoint, hence `body` only has to be safe to
+  /// run concurrently with itself.
+  ///
+  /// Returns what `body` returns for each slice in slice order, or nothing
+  /// if it returns `void`.
+  template <typename Body>
+  auto forEachSliceParallel(Body&& body, unsigned threadCount = 0) const {
+    using ResultTy = std::invoke_result_t<Body&, Slice&>;
+
+    std::vector<Slice> slices;
+    for (auto eachSlice : *this) {
+      slices.push_back(eachSlice);
+    }
+    ThreadPool& pool = ThreadPool::getShared();
+
+    if constexpr (std::is_void<ResultTy>::value) {
+      pool.forEachIndex(
+        slices.size(),
+        [&](size_t index) { body(slices[index]); },
+        threadCount);
+    } else {
+      // Neither `std::vector<bool>` nor results without a default value can
+      // be written to concurrently.
+      std::vector<std::optional<ResultTy>> results(slices.size());
+      pool.forEachIndex(
+        slices.size(),
+        [&](size_t index) { results[index].emplace(body(slices[index])); },
+        threadCount);
+      std::vector<ResultTy> gathered;
+      gathered.reserve(results.size());
+      for (auto& eachResult : results) {
+        gathered.push_back(std::move(*eachResult));
+      }
+      return gathered;
+    }
+  }
+
+#pragma mark - Accessing Fat Archs
+
+  /// The archs of a fat file in host byte order, or none for a Mach-O file.
+  DCL_ALWAYS_INLINE
+  const FatArchIndex& getFatArchs() const { return _fatArchs; }
+
+  /// The first fat arch of `cputype`, or `nullptr`.
+  DCL_ALWAYS_INLINE
+  const FatArchEntry * findFatArch(cpu_type_t cputype) const {
+    return _fatArchs.find(cputype);
+  }
 
+  /// The bytes of the slice of `arch`, which must be one of `getFatArchs`.
   DCL_ALWAYS_INLINE
-  ConstIterator cend() const { return Iterator::makeEnd(_address); }
+  void * getSliceBytes(const FatArchEntry& arch) const {
+    return static_cast<uint8_t *>(_address) + arch.offset;
+  }
+
+#pragma mark - Selecting Slices
+
+  /// The Mach-O header of the slice that runs best on a process of
+  /// `cputype` and `cpusubtype`, see `FatArchIndex::select`, or `nullptr`.
+  ///
+  /// Slices of a fat file are selected from its archs alone, hence the
+  /// other slices are not touched.
+  void * selectSlice(
+    cpu_type_t cputype, cpu_subtype_t cpusubtype = CPU_SUBTYPE_ANY) const {
+    if (!isValid()) {
+      return nullptr;
+    }
+    if (!_fatArchs.empty()) {
+      const FatArchEntry * arch = _fatArchs.select(cputype, cpusubtype);
+      return arch ? getSliceBytes(*arch) : nullptr;
+    }
+    mach_header header;
+    switch (GetFormatWithBytes<MachOMagic>(_address)) {
+    case Format::LittleEndianess32Bit:
+    case Format::LittleEndianess64Bit:
+      std::memcpy(&header, _address, sizeof(header));
+      header.cputype = Platform::LittleEndianess::swapToHost(header.cputype);
+      header.cpusubtype =
+        Platform::LittleEndianess::swapToHost(header.cpusubtype);
+      break;
+    case Format::BigEndianess32Bit:
+    case Format::BigEndianess64Bit:
+      std::memcpy(&header, _address, sizeof(header));
+      header.cputype = Platform::BigEndianess::swapToHost(header.cputype);
+      header.cpusubtype = Platform::BigEndianess::swapToHost(header.cpusubtype);
+      break;
+    case Format::Unknown:
+      return nullptr;
+    }
+    uint32_t grade = details::GradeCPU(
+      cputype, cpusubtype, header.cputype, header.cpusubtype);
+    return grade > 0 ? _address : nullptr;
+  }
 
 #pragma mark - Accessing MachO Slice
 
@@ -746,6 +1011,4 @@ public:
 
 } // namespace dcl::Binary::Darwin
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_MACHOVIEW_H
@@ -0,0 +1,367 @@
+//===--- SymbolTable.h - Symbol Table and Symbolication ---------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_BINARY_DARWIN_SYMBOLTABLE_H
+#define DCL_BINARY_DARWIN_SYMBOLTABLE_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/Utilities.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <numeric>
+#include <string_view>
+#include <vector>
+
+namespace dcl::Binary::Darwin {
+
+namespace details {
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static uint64_t MixSymbolNameHash(uint64_t value) {
+  value ^= value >> 31;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return value;
+}
+
+/// Hashes a symbol name eight bytes at a time.
+DCL_ALWAYS_INLINE
+inline uint64_t HashSymbolName(std::string_view name) {
+  const char * bytes = name.data();
+  size_t length = name.size();
+  uint64_t hash = 0x9e3779b97f4a7c15ULL ^ length;
+  for (; length >= sizeof(uint64_t); length -= sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes, sizeof(uint64_t));
+    hash = MixSymbolNameHash(hash ^ word);
+    bytes += sizeof(uint64_t);
+  }
+  uint64_t word = 0;
+  std::memcpy(&word, bytes, length);
+  return MixSymbolNameHash(hash ^ word);
+}
+
+/// An open-addressing hash table from symbol names to symbol table indices.
+/// Each slot holds the 32-bit index and the upper half of the name's hash,
+/// so most mismatches are rejected without touching the string table.
+class SymbolNameTable {
+
+public:
+  DCL_CONSTEXPR
+  static const uint32_t kEmpty = UINT32_MAX;
+
+private:
+  class Slot {
+  public:
+    uint32_t tag;
+
+    uint32_t index;
+  };
+
+  std::vector<Slot> _slots;
+
+  size_t _mask = 0;
+
+public:
+  /// Reserves room for `count` names at a load factor of at most one half.
+  DCL_ALWAYS_INLINE
+  void reserve(size_t count) {
+    size_t capacity = 16;
+    while (capacity < count * 2) {
+      capacity *= 2;
+    }
+    _slots.assign(capacity, Slot{0, kEmpty});
+    _mask = capacity - 1;
+  }
+
+  /// Inserts `index` under `name` unless the name is already present. Names
+  /// are compared through `getName(index)`.
+  template <typename GetName>
+  DCL_ALWAYS_INLINE
+  void insert(std::string_view name, uint32_t index, GetName&& getName) {
+    uint64_t hash = HashSymbolName(name);
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    for (size_t position = hash & _mask;; position = (position + 1) & _mask) {
+      Slot& slot = _slots[position];
+      if (slot.index == kEmpty) {
+        slot = Slot{tag, index};
+        return;
+      }
+      if (slot.tag == tag && getName(slot.index) == name) {
+        return;
+      }
+    }
+  }
+
+  /// The index stored under `name`, or `kEmpty`.
+  template <typename GetName>
+  DCL_ALWAYS_INLINE
+  uint32_t find(std::string_view name, GetName&& getName) const {
+    if (_slots.empty()) {
+      return kEmpty;
+    }
+    uint64_t hash = HashSymbolName(name);
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    for (size_t position = hash & _mask;; position = (position + 1) & _mask) {
+      const Slot& slot = _slots[position];
+      if (slot.index == kEmpty) {
+        return kEmpty;
+      }
+      if (slot.tag == tag && getName(slot.index) == name) {
+        return slot.index;
+      }
+    }
+  }
+};
+
+} // namespace details
+
+/// A view of the `nlist` entries and the string table described by
+/// `LC_SYMTAB`.
+///
+/// Names point into the string table and are never copied. An index of the
+/// defined symbols sorted by address, and a hash index of all non-debugging
+/// symbols by name, are each built on first use and then shared by all later
+/// lookups, from any thread.
+template <typename Target, typename ByteOrder>
+class SymbolTable {
+
+public:
+  using PointerValueTy = typename Target::PointerValueTy;
+
+  using SymbolTy = Nlist<Target, ByteOrder>;
+
+  using Iterator = const SymbolTy *;
+
+private:
+  const SymbolTy * _symbols;
+
+  uint32_t _symbolCount;
+
+  const char * _strings;
+
+  uint32_t _stringTableSize;
+
+  mutable std::once_flag _addressIndexOnce;
+
+  /// The addresses of the defined symbols in ascending order, each once.
+  mutable std::vector<PointerValueTy> _addresses;
+
+  /// `_addressSymbols[i]` is the index of the symbol at `_addresses[i]`.
+  mutable std::vector<uint32_t> _addressSymbols;
+
+  mutable std::once_flag _nameIndexOnce;
+
+  mutable details::SymbolNameTable _names;
+
+public:
+  /// Creates a view of the symbol table of the image at `image`, which must
+  /// be `imageSize` bytes long. Entries and strings which lie outside of the
+  /// image are dropped.
+  SymbolTable(
+    const void * image,
+    size_t imageSize,
+    const SymbolTableCommand<Target, ByteOrder>& command)
+    : _symbols(nullptr), _symbolCount(0), _strings(nullptr),
+      _stringTableSize(0) {
+    initialize(image, imageSize, command);
+  }
+
+  /// Creates a view of the symbol table of the image whose load commands are
+  /// indexed by `commands`. The image must be `imageSize` bytes long.
+  SymbolTable(
+    const LoadCommandIndex<Target, ByteOrder>& commands, size_t imageSize)
+    : _symbols(nullptr), _symbolCount(0), _strings(nullptr),
+      _stringTableSize(0) {
+    using CommandKind = typename Target::LoadCommandKindTy;
+    auto command =
+      commands.template first<SymbolTableCommand>(CommandKind::StabSymbolTable);
+    if (command) {
+      initialize(commands.getHeader(), imageSize, *command);
+    }
+  }
+
+  SymbolTable(const SymbolTable&) = delete;
+
+  SymbolTable& operator=(const SymbolTable&) = delete;
+
+#pragma mark - Accessing Symbols
+
+  DCL_ALWAYS_INLINE
+  uint32_t getSymbolCount() const { return _symbolCount; }
+
+  DCL_ALWAYS_INLINE
+  const SymbolTy& getSymbol(uint32_t index) const {
+    DCLAssert(index < _symbolCount);
+    return _symbols[index];
+  }
+
+  DCL_ALWAYS_INLINE
+  Iterator begin() const { return _symbols; }
+
+  DCL_ALWAYS_INLINE
+  Iterator end() const { return _symbols + _symbolCount; }
+
+  /// The name of `symbol`, or an empty string if its string index is out of
+  /// the string table. The view never extends past the string table.
+  DCL_ALWAYS_INLINE
+  std::string_view getName(const SymbolTy& symbol) const {
+    uint32_t stringIndex = symbol.getStringIndex();
+    if (stringIndex >= _stringTableSize) {
+      return {};
+    }
+    const char * name = _strings + stringIndex;
+    return {name, strnlen(name, _stringTableSize - stringIndex)};
+  }
+
+  /// The first non-debugging symbol named `name`, or `nullptr`.
+  const SymbolTy * findSymbol(std::string_view name) const {
+    std::call_once(_nameIndexOnce, [this] { buildNameIndex(); });
+    uint32_t index = _names.find(name, [this](uint32_t index) {
+      return getName(_symbols[index]);
+    });
+    return index == details::SymbolNameTable::kEmpty ? nullptr
+                                                       : &_symbols[index];
+  }
+
+#pragma mark - Symbolication
+
+  /// The defined symbol with the greatest address not greater than
+  /// `address`, or `nullptr` if `address` precedes every defined symbol.
+  const SymbolTy * lookup(PointerValueTy address) const {
+    buildAddressIndexIfNeeded();
+    size_t position = details::FindLastNotGreater(
+      _addresses.data(), _addresses.size(), address);
+    if (position == _addresses.size()) {
+      return nullptr;
+    }
+    return &_symbols[_addressSymbols[position]];
+  }
+
+  /// Looks up `count` addresses at once, writing the result for
+  /// `addresses[i]` to `symbols[i]` as `lookup` would. The queries are sorted
+  /// and then answered with one merge pass over the address index.
+  void symbolicate(
+    const PointerValueTy * addresses,
+    size_t count,
+    const SymbolTy ** symbols) const {
+    buildAddressIndexIfNeeded();
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+      return addresses[lhs] < addresses[rhs];
+    });
+
+    size_t position = 0;
+    size_t indexSize = _addresses.size();
+    for (size_t eachQuery : order) {
+      PointerValueTy address = addresses[eachQuery];
+      while (position + 1 < indexSize && _addresses[position + 1] <= address) {
+        position++;
+      }
+      if (indexSize == 0 || _addresses[position] > address) {
+        symbols[eachQuery] = nullptr;
+      } else {
+        symbols[eachQuery] = &_symbols[_addressSymbols[position]];
+      }
+    }
+  }
+
+private:
+  void initialize(
+    const void * image,
+    size_t imageSize,
+    const SymbolTableCommand<Target, ByteOrder>& command) {
+    auto base = static_cast<const uint8_t *>(image);
+    uint64_t symbolOffset = command.getSymbolTableOffset();
+    if (symbolOffset <= imageSize) {
+      uint64_t fitting = (imageSize - symbolOffset) / sizeof(SymbolTy);
+      _symbols = reinterpret_cast<const SymbolTy *>(base + symbolOffset);
+      _symbolCount = static_cast<uint32_t>(std::min<uint64_t>(
+        command.getNumberOfSymbolTableEntries(), fitting));
+    }
+    uint64_t stringOffset = command.getStringTableOffset();
+    if (stringOffset <= imageSize) {
+      _strings = reinterpret_cast<const char *>(base + stringOffset);
+      _stringTableSize = static_cast<uint32_t>(std::min<uint64_t>(
+        command.getStringTableSize(), imageSize - stringOffset));
+    }
+  }
+
+  void buildNameIndex() const {
+    auto getIndexedName = [this](uint32_t index) {
+      return getName(_symbols[index]);
+    };
+    _names.reserve(_symbolCount);
+    for (uint32_t index = 0; index < _symbolCount; index++) {
+      if (_symbols[index].isDebugging()) {
+        continue;
+      }
+      std::string_view name = getName(_symbols[index]);
+      if (!name.empty()) {
+        _names.insert(name, index, getIndexedName);
+      }
+    }
+  }
+
+  void buildAddressIndexIfNeeded() const {
+    std::call_once(_addressIndexOnce, [this] { buildAddressIndex(); });
+  }
+
+  /// Where several symbols share an address an external one is preferred,
+  /// then the first in table order.
+  void buildAddressIndex() const {
+    std::vector<uint32_t> defined;
+    for (uint32_t index = 0; index < _symbolCount; index++) {
+      if (_symbols[index].isDefinedInSection()) {
+        defined.push_back(index);
+      }
+    }
+    std::sort(defined.begin(), defined.end(), [&](uint32_t lhs, uint32_t rhs) {
+      const SymbolTy& lhsSymbol = _symbols[lhs];
+      const SymbolTy& rhsSymbol = _symbols[rhs];
+      if (lhsSymbol.getValue() != rhsSymbol.getValue()) {
+        return lhsSymbol.getValue() < rhsSymbol.getValue();
+      }
+      if (lhsSymbol.isExternal() != rhsSymbol.isExternal()) {
+        return lhsSymbol.isExternal();
+      }
+      return lhs < rhs;
+    });
+
+    _addresses.reserve(defined.size());
+    _addressSymbols.reserve(defined.size());
+    for (uint32_t eachIndex : defined) {
+      PointerValueTy address = _symbols[eachIndex].getValue();
+      if (!_addresses.empty() && _addresses.back() == address) {
+        continue;
+      }
+      _addresses.push_back(address);
+      _addressSymbols.push_back(eachIndex);
+    }
+  }
+};
+
+} // namespace dcl::Binary::Darwin
+
+#endif // DCL_BINARY_DARWIN_SYMBOLTABLE_H
@@ -16,12 +16,10 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <cstddef>
-#include <mach-o/fixup-chains.h>
-#include <mach-o/loader.h>
-#include <mach-o/nlist.h>
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+#include <dcl/Binary/Darwin/ABI/Nlist.h>
 
 namespace dcl::Binary::Darwin {
 
@@ -127,6 +125,4 @@ public:
 
 } // namespace dcl::Binary::Darwin
 
-#endif // DCL_TARGET_OS_DARWIN
-
 #endif // DCL_BINARY_DARWIN_TARGETS_H
@@ -16,13 +16,11 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
 #include <cstdint>
 #include <iterator>
-#include <mach-o/fixup-chains.h>
-#include <mach-o/loader.h>
-#include <mach-o/nlist.h>
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+#include <dcl/Binary/Darwin/ABI/Nlist.h>
 
 namespace dcl::Binary::Darwin {
 
@@ -156,8 +154,21 @@ public:
   using CategoryTy = std::random_access_iterator_tag;
 };
 
-} // namespace dcl::Binary::Darwin
+template <typename Target, typename ByteOrder>
+class LoadCommandIndexIterator;
 
-#endif // DCL_TARGET_OS_DARWIN
+template <typename Target, typename ByteOrder>
+class IteratorTraits<LoadCommandIndexIterator<Target, ByteOrder>> {
+public:
+  using ValueTy = LoadCommand<Target, ByteOrder>;
+  using DifferenceTy = ptrdiff_t;
+  using PointerTy = typename std::add_pointer<ValueTy>::type;
+  using ConstPointerTy = typename std::add_const<PointerTy>::type;
+  using ReferenceTy = typename std::add_lvalue_reference<ValueTy>::type;
+  using ConstReferenceTy = typename std::add_const<ReferenceTy>::type;
+  using CategoryTy = std::forward_iterator_tag;
+};
+
+} // namespace dcl::Binary::Darwin
 
 #endif // DCL_BINARY_DARWIN_TRAITS_H
@@ -16,8 +16,7 @@
 
 #include <dcl/Basic/Basic.h>
 
-#if DCL_TARGET_OS_DARWIN
-
+#include <cstddef>
 #include <cstdint>
 
 namespace dcl::Binary::Darwin {
@@ -63,8 +62,84 @@ static intptr_t readSleb128(const uint8_t *& p, const uint8_t * end) {
   return result;
 }
 
-} // namespace dcl::Binary::Darwin
+/// Decodes the ULEB128 at `p` into `value` and moves `p` past it. Unlike
+/// `readUleb128`, returns false rather than aborting if the number runs past
+/// `end` or does not fit in 64 bits, in which case `p` is left as it was.
+DCL_ALWAYS_INLINE
+inline bool
+tryReadUleb128(const uint8_t *& p, const uint8_t * end, uint64_t& value) {
+  const uint8_t * cursor = p;
+  uint64_t result = 0;
+  unsigned bit = 0;
+  while (true) {
+    if (cursor == end) {
+      return false;
+    }
+    uint64_t slice = *cursor & 0x7f;
+    if (bit > 63 || (bit == 63 && slice > 1)) {
+      return false;
+    }
+    result |= slice << bit;
+    bit += 7;
+    if (!(*cursor++ & 0x80)) {
+      break;
+    }
+  }
+  p = cursor;
+  value = result;
+  return true;
+}
+
+/// Decodes the SLEB128 at `p` into `value` and moves `p` past it, see
+/// `tryReadUleb128`.
+DCL_ALWAYS_INLINE
+inline bool
+tryReadSleb128(const uint8_t *& p, const uint8_t * end, int64_t& value) {
+  const uint8_t * cursor = p;
+  uint64_t result = 0;
+  unsigned bit = 0;
+  uint8_t byte;
+  do {
+    if (cursor == end || bit > 63) {
+      return false;
+    }
+    byte = *cursor++;
+    result |= uint64_t(byte & 0x7f) << bit;
+    bit += 7;
+  } while (byte & 0x80);
+  // sign extend negative numbers
+  if ((byte & 0x40) != 0 && bit < 64) {
+    result |= UINT64_MAX << bit;
+  }
+  p = cursor;
+  value = static_cast<int64_t>(result);
+  return true;
+}
+
+namespace details {
 
-#endif // DCL_TARGET_OS_DARWIN
+/// Returns the index of the last of `count` ascending `keys` that is not
+/// greater than `key`, or `count` if there is none. The loop has a fixed trip
+/// count for a given `count` and its only data-dependent step compiles to a
+/// conditional move.
+template <typename T>
+DCL_ALWAYS_INLINE
+inline size_t FindLastNotGreater(const T * keys, size_t count, T key) {
+  if (count == 0) {
+    return 0;
+  }
+  const T * base = keys;
+  size_t length = count;
+  while (length > 1) {
+    size_t half = length / 2;
+    base = base[half] <= key ? base + half : base;
+    length -= half;
+  }
+  return *base <= key ? static_cast<size_t>(base - keys) : count;
+}
+
+} // namespace details
+
+} // namespace dcl::Binary::Darwin
 
 #endif // DCL_BINARY_DARWIN_UTILITIES_H
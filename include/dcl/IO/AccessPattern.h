@@ -0,0 +1,40 @@
+//===--- AccessPattern.h - IO Access Patterns -------------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_ACCESSPATTERN_H
+#define DCL_IO_ACCESSPATTERN_H
+
+#include <dcl/Basic/Basic.h>
+
+namespace dcl {
+
+namespace IO {
+
+/// How the contents of a file are going to be accessed, which the kernel
+/// takes as a hint for read-ahead and page reclamation.
+enum class AccessPattern : uint8_t {
+  /// No hint.
+  Normal,
+  /// From lower to higher offsets, hence the kernel reads ahead eagerly.
+  Sequential,
+  /// In no particular order, hence the kernel does not read ahead.
+  Random,
+  /// Soon and entirely, hence the kernel reads the whole file ahead.
+  WillNeed,
+};
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_ACCESSPATTERN_H
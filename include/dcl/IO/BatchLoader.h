@@ -0,0 +1,125 @@
+//===--- BatchLoader.h - Batched Loading of File Headers --------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_BATCHLOADER_H
+#define DCL_IO_BATCHLOADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <dcl/Basic/Basic.h>
+
+namespace dcl {
+
+namespace IO {
+
+/// How a `BatchLoader` issues its reads.
+enum class BatchMethod : uint8_t {
+  /// `IOURing` where the kernel supports it, `ThreadPool` otherwise.
+  Automatic,
+  /// Submits the opens, the stats and the reads of many files at once
+  /// through one io_uring.
+  IOURing,
+  /// Opens, stats and reads each file with `pread` on the shared
+  /// `ThreadPool`.
+  ThreadPool,
+};
+
+/// The outcome of loading the header of one file.
+class BatchEntry {
+public:
+  /// The size of the whole file.
+  uint64_t fileSize;
+
+  /// The number of bytes loaded, which is less than the header size for
+  /// smaller files.
+  size_t size;
+
+  /// The `errno` of the operation that failed, or zero.
+  int error;
+
+  DCL_ALWAYS_INLINE
+  bool isLoaded() const { return error == 0; }
+};
+
+/// Loads the first bytes of many files at once, e.g. to triage the magic
+/// and the headers of a corpus, without opening and mapping each of them
+/// in turn.
+///
+/// The headers are read into one buffer owned by the loader, which is
+/// reused by subsequent loads.
+class BatchLoader {
+
+private:
+  size_t _headerSize;
+
+  std::vector<uint8_t> _buffer;
+
+  std::vector<BatchEntry> _entries;
+
+  BatchMethod _method;
+
+public:
+  DCL_CONSTEXPR
+  static const size_t kDefaultHeaderSize = 64 * 1024;
+
+  /// Loads up to `headerSize` bytes of each file.
+  explicit BatchLoader(size_t headerSize = kDefaultHeaderSize) noexcept
+    : _headerSize(headerSize), _method(BatchMethod::Automatic) {}
+
+  /// Replaces the contents of the loader with the headers of the `count`
+  /// files at `paths`, read with `method` on up to `threadCount` threads.
+  /// Zero picks every thread of the shared pool. Returns whether every file
+  /// was loaded; the others have an error.
+  bool load(
+    const char * const * paths,
+    size_t count,
+    BatchMethod method = BatchMethod::Automatic,
+    unsigned threadCount = 0);
+
+  /// The method the last load used, never `BatchMethod::Automatic` once
+  /// something was loaded.
+  DCL_ALWAYS_INLINE
+  BatchMethod getMethod() const { return _method; }
+
+  DCL_ALWAYS_INLINE
+  size_t getHeaderSize() const { return _headerSize; }
+
+  DCL_ALWAYS_INLINE
+  size_t size() const { return _entries.size(); }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const { return _entries.empty(); }
+
+  DCL_ALWAYS_INLINE
+  const BatchEntry& operator[](size_t index) const { return _entries[index]; }
+
+  /// The header of file `index`, `_entries[index].size` bytes long.
+  DCL_ALWAYS_INLINE
+  const void * getBytes(size_t index) const {
+    return _buffer.data() + index * _headerSize;
+  }
+
+private:
+  bool loadWithIOURing(const char * const * paths, size_t count);
+
+  void loadWithThreadPool(
+    const char * const * paths, size_t count, unsigned threadCount);
+};
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_BATCHLOADER_H
@@ -19,6 +19,9 @@
 #include <memory>
 
 #include <dcl/Basic/Basic.h>
+#include <dcl/IO/AccessPattern.h>
+#include <dcl/IO/MappedRange.h>
+#include <dcl/IO/MappingOptions.h>
 #include <dcl/IO/Permissions.h>
 
 namespace dcl {
@@ -40,7 +43,13 @@ private:
 #endif
 
 public:
-  explicit File(const char * path, Permissions permissions) noexcept;
+  /// Maps the file at `path` as `options` tells, advising the kernel of
+  /// `pattern`.
+  explicit File(
+    const char * path,
+    Permissions permissions,
+    AccessPattern pattern = AccessPattern::Normal,
+    MappingOptions options = MappingOptions::None) noexcept;
 
   ~File() noexcept;
 
@@ -70,6 +79,8 @@ public:
 #pragma mark - Accessing File Contents
 
 public:
+  /// The contents of the file, or `nullptr` if the file is not mapped as a
+  /// whole.
   DCL_ALWAYS_INLINE
   void * getBytes() noexcept { return _buffer; }
 
@@ -88,6 +99,30 @@ public:
   DCL_ALWAYS_INLINE
   int getFd() const noexcept { return _fd; }
 
+  /// Whether the file is open, whether it is mapped or not.
+  DCL_ALWAYS_INLINE
+  bool isOpen() const noexcept { return _fd != -1; }
+
+  /// Maps [`offset`, `offset + length`) of the file on its own, see
+  /// `MappedRange`.
+  DCL_ALWAYS_INLINE
+  MappedRange mapRange(size_t offset, size_t length) const noexcept {
+    return MappedRange{*this, offset, length};
+  }
+
+#pragma mark - Advising Access
+
+public:
+  /// Advises the kernel that the contents are going to be accessed in
+  /// `pattern` from now on. Returns false if the advice is not taken.
+  bool advise(AccessPattern pattern) noexcept;
+
+  /// Starts reading [`offset`, `offset + length`) ahead without waiting for
+  /// it, e.g. `__LINKEDIT` or a slice before parsing it. The range is
+  /// clamped to the file. Returns false if it lies out of the file or the
+  /// advice is not taken.
+  bool prefetch(size_t offset, size_t length) noexcept;
+
 #if DEBUG
   DCL_ALWAYS_INLINE
   char * getPath() noexcept { return _path; }
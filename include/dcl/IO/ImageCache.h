@@ -0,0 +1,207 @@
+//===--- ImageCache.h - Cache of Mapped Images ------------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_IMAGECACHE_H
+#define DCL_IO_IMAGECACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <dcl/Basic/Basic.h>
+#include <dcl/IO/File.h>
+
+namespace dcl {
+
+namespace IO {
+
+/// The `LC_UUID` of a Mach-O image.
+using ImageUUID = std::array<uint8_t, 16>;
+
+/// An image mapped by an `ImageCache`, which stays mapped for as long as a
+/// handle to it is held, even once the cache evicted it.
+class CachedImage {
+
+  friend class ImageCache;
+
+private:
+  File _file;
+
+  std::string _path;
+
+  int64_t _modificationTime;
+
+  ImageUUID _uuid;
+
+  bool _hasUUID;
+
+public:
+  DCL_ALWAYS_INLINE
+  CachedImage(File&& file, std::string path, int64_t modificationTime)
+    : _file(std::move(file)), _path(std::move(path)),
+      _modificationTime(modificationTime), _uuid{}, _hasUUID(false) {}
+
+  DCL_ALWAYS_INLINE
+  const void * getBytes() const { return _file.getBytes(); }
+
+  DCL_ALWAYS_INLINE
+  size_t getSize() const { return _file.getSize(); }
+
+  DCL_ALWAYS_INLINE
+  const std::string& getPath() const { return _path; }
+
+  /// The modification time of the file when it was mapped, in nanoseconds
+  /// since the epoch.
+  DCL_ALWAYS_INLINE
+  int64_t getModificationTime() const { return _modificationTime; }
+
+  DCL_ALWAYS_INLINE
+  bool hasUUID() const { return _hasUUID; }
+
+  DCL_ALWAYS_INLINE
+  const ImageUUID& getUUID() const { return _uuid; }
+};
+
+/// Keeps recently used images mapped, such that opening the same image
+/// again neither reopens nor remaps it.
+///
+/// Images are looked up by path, and are remapped once the file at the path
+/// is modified, or by the UUID `UUIDReader` reads from them. The images
+/// the cache keeps take `getBudget()` bytes at most, beyond which the least
+/// recently used ones are evicted. Handles are shared, hence an image in
+/// use stays mapped until its last handle is released, whether it was
+/// evicted or not.
+///
+/// Safe to use from several threads at once.
+class ImageCache {
+
+public:
+  using Handle = std::shared_ptr<const CachedImage>;
+
+  /// Reads the UUID of the image of `size` bytes at `bytes`, e.g. with
+  /// `Binary::Darwin::MachOView::copyUUID`. Returns false if it has none.
+  using UUIDReader =
+    std::function<bool(const void * bytes, size_t size, ImageUUID& uuid)>;
+
+private:
+  using ImageList = std::list<std::shared_ptr<CachedImage>>;
+
+  mutable std::mutex _mutex;
+
+  /// The images from the most to the least recently used.
+  ImageList _images;
+
+  std::unordered_map<std::string, ImageList::iterator> _imagesByPath;
+
+  std::map<ImageUUID, ImageList::iterator> _imagesByUUID;
+
+  size_t _budget;
+
+  size_t _size;
+
+  UUIDReader _readUUID;
+
+  size_t _hitCount;
+
+  size_t _missCount;
+
+public:
+  /// Keeps images of up to `budget` bytes in total mapped, reading their
+  /// UUIDs with `readUUID` if any.
+  explicit ImageCache(size_t budget, UUIDReader readUUID = nullptr)
+    : _budget(budget), _size(0), _readUUID(std::move(readUUID)),
+      _hitCount(0), _missCount(0) {}
+
+  ImageCache(const ImageCache&) = delete;
+
+  ImageCache& operator=(const ImageCache&) = delete;
+
+#pragma mark - Looking Up Images
+
+public:
+  /// The image at `path`, mapped read-only unless it is cached and the file
+  /// was not modified since, or `nullptr` if it cannot be mapped.
+  Handle open(const char * path);
+
+  /// The cached image of `uuid`, or `nullptr`. Images are only found by
+  /// their UUIDs once they were opened by path.
+  Handle find(const ImageUUID& uuid);
+
+#pragma mark - Managing Capacity
+
+public:
+  /// Evicts the least recently used images until the cached ones fit in
+  /// `budget` bytes.
+  void setBudget(size_t budget);
+
+  /// Evicts every image.
+  void clear();
+
+  DCL_ALWAYS_INLINE
+  size_t getBudget() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _budget;
+  }
+
+  /// The number of bytes of the cached images.
+  DCL_ALWAYS_INLINE
+  size_t getSize() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _size;
+  }
+
+  /// The number of cached images.
+  DCL_ALWAYS_INLINE
+  size_t getCount() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _images.size();
+  }
+
+  /// The number of lookups answered from the cache.
+  DCL_ALWAYS_INLINE
+  size_t getHitCount() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _hitCount;
+  }
+
+  /// The number of lookups that mapped an image or found nothing.
+  DCL_ALWAYS_INLINE
+  size_t getMissCount() const {
+    std::lock_guard<std::mutex> lock{_mutex};
+    return _missCount;
+  }
+
+private:
+  /// Marks `image` as the most recently used. `_mutex` must be held.
+  void touch(ImageList::iterator image);
+
+  /// Forgets `image`. `_mutex` must be held.
+  void evict(ImageList::iterator image);
+
+  /// Evicts the least recently used images until the cached ones fit in the
+  /// budget. `_mutex` must be held.
+  void evictOverBudget();
+};
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_IMAGECACHE_H
@@ -0,0 +1,112 @@
+//===--- MappedRange.h - Mapped Window of a File ----------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_MAPPEDRANGE_H
+#define DCL_IO_MAPPEDRANGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <dcl/Basic/Basic.h>
+
+namespace dcl {
+
+namespace IO {
+
+class File;
+
+/// A read-only mapping of [`offset`, `offset + size`) of a file, e.g. one
+/// slice of a fat file, which takes no address space for the rest of it.
+///
+/// The mapping starts at the page boundary below `offset`, yet the bytes and
+/// size it exposes are the ones of the requested range.
+///
+/// A move-only resource.
+class MappedRange {
+
+private:
+  void * _mapping;
+
+  size_t _mappingSize;
+
+  size_t _offset;
+
+  size_t _size;
+
+public:
+  /// An empty range.
+  DCL_ALWAYS_INLINE
+  MappedRange() noexcept
+    : _mapping(nullptr), _mappingSize(0), _offset(0), _size(0) {}
+
+  /// Maps [`offset`, `offset + length`) of `file`, clamped to the end of
+  /// it. The range is empty if `offset` lies out of the file or the mapping
+  /// fails.
+  MappedRange(const File& file, size_t offset, size_t length) noexcept;
+
+  ~MappedRange() noexcept;
+
+  MappedRange(const MappedRange&) = delete;
+
+  MappedRange& operator=(const MappedRange&) = delete;
+
+  DCL_ALWAYS_INLINE
+  MappedRange(MappedRange&& another) noexcept : MappedRange() {
+    *this = std::move(another);
+  }
+
+  DCL_ALWAYS_INLINE
+  MappedRange& operator=(MappedRange&& another) noexcept {
+    std::swap(_mapping, another._mapping);
+    std::swap(_mappingSize, another._mappingSize);
+    std::swap(_offset, another._offset);
+    std::swap(_size, another._size);
+    return *this;
+  }
+
+#pragma mark - Accessing Range Contents
+
+public:
+  /// The byte at `getOffset()` of the file, or `nullptr` if the range is
+  /// empty.
+  DCL_ALWAYS_INLINE
+  void * getBytes() noexcept {
+    return const_cast<void *>(std::as_const(*this).getBytes());
+  }
+
+  DCL_ALWAYS_INLINE
+  const void * getBytes() const noexcept {
+    if (!_mapping) {
+      return nullptr;
+    }
+    // The mapping is the range preceded by less than a page.
+    return static_cast<const uint8_t *>(_mapping) + _mappingSize - _size;
+  }
+
+  DCL_ALWAYS_INLINE
+  size_t getSize() const noexcept { return _size; }
+
+  /// The offset of the range in the file.
+  DCL_ALWAYS_INLINE
+  size_t getOffset() const noexcept { return _offset; }
+
+  DCL_ALWAYS_INLINE
+  bool empty() const noexcept { return _size == 0; }
+};
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_MAPPEDRANGE_H
@@ -0,0 +1,69 @@
+//===--- MappingOptions.h - File Mapping Options ----------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_MAPPINGOPTIONS_H
+#define DCL_IO_MAPPINGOPTIONS_H
+
+#include <dcl/Basic/Basic.h>
+
+#include <type_traits>
+
+namespace dcl {
+
+namespace IO {
+
+/// How a `File` maps its contents.
+enum class MappingOptions : uint8_t {
+
+  /// Maps the whole file, shared with other mappings of it.
+  None = 0x0,
+  /// Opens the file without mapping it, such that only the windows mapped
+  /// with `File::mapRange` take address space.
+  Deferred = 0x1,
+  /// Maps the file copy-on-write and writable whatever the permissions, such
+  /// that writes, e.g. fixups, never reach the file.
+  Private = 0x2,
+  /// Faults the whole mapping in up front instead of page by page.
+  Populate = 0x4,
+  /// Advises the kernel to back the mapping with transparent huge pages
+  /// where it supports them.
+  HugePages = 0x8,
+
+};
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+MappingOptions operator|(MappingOptions l, MappingOptions r) noexcept {
+  using UnderlyingTy = std::underlying_type<MappingOptions>::type;
+  return MappingOptions(UnderlyingTy(l) | UnderlyingTy(r));
+}
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+MappingOptions operator&(MappingOptions l, MappingOptions r) noexcept {
+  using UnderlyingTy = std::underlying_type<MappingOptions>::type;
+  return MappingOptions(UnderlyingTy(l) & UnderlyingTy(r));
+}
+
+/// Whether `options` has every option of `option`.
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+bool HasMappingOptions(MappingOptions options, MappingOptions option) noexcept {
+  return (options & option) == option;
+}
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_MAPPINGOPTIONS_H
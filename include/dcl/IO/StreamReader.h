@@ -0,0 +1,143 @@
+//===--- StreamReader.h - Buffered Stream of Bytes --------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_IO_STREAMREADER_H
+#define DCL_IO_STREAMREADER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <dcl/Basic/Basic.h>
+
+namespace dcl {
+
+namespace IO {
+
+/// Reads the bytes of a descriptor which can neither be sought nor mapped,
+/// e.g. a pipe or the standard input, from the front to the back.
+///
+/// Bytes ahead of the current offset are buffered on demand so that they
+/// can be parsed in place, up to a bounded lookahead. Consumed bytes are
+/// gone, hence a stream can only be read forward.
+///
+/// A move-only resource. The descriptor is not owned.
+class StreamReader {
+
+private:
+  int _fd;
+
+  std::vector<uint8_t> _buffer;
+
+  /// The buffered bytes are [`_begin`, `_end`) of `_buffer`.
+  size_t _begin;
+
+  size_t _end;
+
+  /// The offset in the stream of the byte at `_begin`.
+  uint64_t _offset;
+
+  size_t _maxLookahead;
+
+  bool _isAtEnd;
+
+  int _error;
+
+public:
+  DCL_CONSTEXPR
+  static const size_t kDefaultBufferSize = 64 * 1024;
+
+  DCL_CONSTEXPR
+  static const size_t kDefaultMaxLookahead = 16 * 1024 * 1024;
+
+  /// Reads `fd`, `bufferSize` bytes at a time, buffering no more than
+  /// `maxLookahead` bytes ahead.
+  explicit StreamReader(
+    int fd,
+    size_t bufferSize = kDefaultBufferSize,
+    size_t maxLookahead = kDefaultMaxLookahead) noexcept;
+
+  StreamReader(const StreamReader&) = delete;
+
+  StreamReader& operator=(const StreamReader&) = delete;
+
+  DCL_ALWAYS_INLINE
+  StreamReader(StreamReader&& another) noexcept : StreamReader(-1, 0, 0) {
+    *this = std::move(another);
+  }
+
+  DCL_ALWAYS_INLINE
+  StreamReader& operator=(StreamReader&& another) noexcept {
+    std::swap(_fd, another._fd);
+    std::swap(_buffer, another._buffer);
+    std::swap(_begin, another._begin);
+    std::swap(_end, another._end);
+    std::swap(_offset, another._offset);
+    std::swap(_maxLookahead, another._maxLookahead);
+    std::swap(_isAtEnd, another._isAtEnd);
+    std::swap(_error, another._error);
+    return *this;
+  }
+
+#pragma mark - Reading Bytes
+
+public:
+  /// The offset in the stream of the next byte to read.
+  DCL_ALWAYS_INLINE
+  uint64_t getOffset() const noexcept { return _offset; }
+
+  DCL_ALWAYS_INLINE
+  int getFd() const noexcept { return _fd; }
+
+  DCL_ALWAYS_INLINE
+  size_t getMaxLookahead() const noexcept { return _maxLookahead; }
+
+  /// Whether every byte of the stream was read.
+  DCL_ALWAYS_INLINE
+  bool isAtEnd() const noexcept { return _isAtEnd && _begin == _end; }
+
+  /// The `errno` of the read of the descriptor that failed, or zero. Once a
+  /// read fails, nothing past the buffered bytes can be read.
+  DCL_ALWAYS_INLINE
+  int getError() const noexcept { return _error; }
+
+  /// The next `length` bytes without consuming them, or `nullptr` if the
+  /// stream ends before them or they exceed the lookahead. The bytes stay
+  /// valid until the stream is read again.
+  const void * peek(size_t length) noexcept;
+
+  /// Consumes the next `length` bytes into `destination`. Returns false if
+  /// the stream ends or fails before them.
+  bool read(void * destination, size_t length) noexcept;
+
+  /// Consumes the next `length` bytes without keeping them.
+  bool skip(size_t length) noexcept;
+
+  /// Consumes the bytes up to `offset`. Returns false if `offset` was
+  /// already consumed or the stream ends before it.
+  DCL_ALWAYS_INLINE
+  bool skipTo(uint64_t offset) noexcept {
+    return offset >= _offset && skip(offset - _offset);
+  }
+
+private:
+  /// Buffers at least `length` bytes if the stream has them.
+  bool fill(size_t length) noexcept;
+};
+
+} // namespace IO
+
+} // namespace dcl
+
+#endif // DCL_IO_STREAMREADER_H
@@ -0,0 +1,330 @@
+//===--- BulkByteSwap.h - Bulk Byte Swapping of Struct Arrays ---*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  Converts whole arrays of cross-endian structs into host byte order.
+//
+//  The layout of a struct is described at compile time with `FieldLayout`.
+//  From it a byte-shuffle table is generated which repeats every
+//  lcm(sizeof(struct), 16) bytes. The array is then permuted 16 bytes (SSSE3,
+//  NEON) or 32 bytes (AVX2) at a time, so the cost is that of a copy.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DCL_PLATFORM_BULKBYTESWAP_H
+#define DCL_PLATFORM_BULKBYTESWAP_H
+
+#include <dcl/Basic/Basic.h>
+#include <dcl/Platform/ByteOrder.h>
+#include <dcl/Platform/TypeWrapper.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <type_traits>
+
+#if !DCL_COMPILER_IS_MSVC && (defined(__x86_64__) || defined(__i386__))
+#define DCL_BULK_BYTE_SWAP_X86 DCL_HAS_TARGET_ATTRIBUTE
+#else
+#define DCL_BULK_BYTE_SWAP_X86 0
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define DCL_BULK_BYTE_SWAP_NEON 1
+#else
+#define DCL_BULK_BYTE_SWAP_NEON 0
+#endif
+
+#if DCL_BULK_BYTE_SWAP_X86
+#include <immintrin.h>
+#endif
+
+#if DCL_BULK_BYTE_SWAP_NEON
+#include <arm_neon.h>
+#endif
+
+namespace dcl::Platform {
+
+#pragma mark - Field Layout
+
+/// `Count` consecutive fields of `Width` bytes each. A width of 1 describes
+/// bytes that are never swapped, such as `char segname[16]`.
+template <size_t Width, size_t Count = 1>
+class Field {
+public:
+  static_assert(Width == 1 || Width == 2 || Width == 4 || Width == 8);
+
+  DCL_CONSTEXPR
+  static const size_t width = Width;
+
+  DCL_CONSTEXPR
+  static const size_t count = Count;
+
+  DCL_CONSTEXPR
+  static const size_t size = Width * Count;
+};
+
+/// The compile-time description of a struct, as a list of `Field`s in
+/// declaration order. The fields must cover the struct without padding.
+template <typename... Fields>
+class FieldLayout {
+public:
+  DCL_CONSTEXPR
+  static const size_t size = (Fields::size + ... + 0);
+
+  using SwapIndicesTy = std::array<uint16_t, size>;
+
+  /// The source offset of each destination byte of one swapped struct.
+  DCL_CONSTEXPR
+  static SwapIndicesTy makeSwapIndices() {
+    SwapIndicesTy indices{};
+    size_t offset = 0;
+    (appendSwapIndices<Fields>(indices, offset), ...);
+    return indices;
+  }
+
+  /// Whether every field sits at a multiple of its own width, and the struct
+  /// size is a multiple of the widest field. This guarantees that no field of
+  /// an array of such structs straddles a 16-byte boundary.
+  DCL_CONSTEXPR
+  static bool isNaturallyAligned() {
+    size_t offset = 0;
+    size_t maxWidth = 1;
+    bool aligned = true;
+    ((aligned = aligned && offset % Fields::width == 0,
+      offset += Fields::size,
+      maxWidth = Fields::width > maxWidth ? Fields::width : maxWidth),
+     ...);
+    return aligned && size % maxWidth == 0;
+  }
+
+private:
+  template <typename F>
+  DCL_CONSTEXPR
+  static void appendSwapIndices(SwapIndicesTy& indices, size_t& offset) {
+    for (size_t element = 0; element < F::count; element++) {
+      for (size_t byte = 0; byte < F::width; byte++) {
+        indices[offset + byte] =
+          static_cast<uint16_t>(offset + F::width - 1 - byte);
+      }
+      offset += F::width;
+    }
+  }
+};
+
+/// Specialize with `using Type = FieldLayout<...>;` for each wrapped struct
+/// that is swapped in bulk.
+template <typename Wrapped>
+class FieldLayoutOf;
+
+#pragma mark - Shuffle Tables
+
+namespace details {
+
+template <typename Layout>
+class BulkByteSwapTable {
+public:
+  static_assert(Layout::size > 0);
+  static_assert(
+    Layout::isNaturallyAligned(),
+    "Fields must be naturally aligned to be swapped in bulk.");
+
+  DCL_CONSTEXPR
+  static const size_t kChunkSize = 16;
+
+  /// The shuffle pattern repeats after this many bytes.
+  DCL_CONSTEXPR
+  static const size_t kPeriod = std::lcm(Layout::size, kChunkSize);
+
+  DCL_CONSTEXPR
+  static const size_t kChunkCount = kPeriod / kChunkSize;
+
+  using TableTy = std::array<uint8_t, 2 * kPeriod>;
+
+  /// Chunk-relative `pshufb`/`tbl` indices for one period, stored twice so
+  /// that a 32-byte window may start at any chunk of the first period.
+  DCL_CONSTEXPR
+  static TableTy makeTable() {
+    TableTy table{};
+    auto indices = Layout::makeSwapIndices();
+    for (size_t position = 0; position < kPeriod; position++) {
+      size_t structOffset = position % Layout::size;
+      size_t source = position - structOffset + indices[structOffset];
+      size_t chunkBase = position - position % kChunkSize;
+      table[position] = static_cast<uint8_t>(source - chunkBase);
+      table[position + kPeriod] = table[position];
+    }
+    return table;
+  }
+
+  DCL_CONSTEXPR
+  static const TableTy kTable = makeTable();
+};
+
+template <typename Layout>
+DCL_ALWAYS_INLINE
+inline void BulkByteSwapScalar(
+  const uint8_t * source,
+  uint8_t * destination,
+  size_t position,
+  size_t size) {
+  using Table = BulkByteSwapTable<Layout>;
+  uint8_t chunk[Table::kChunkSize];
+  for (; position < size; position += Table::kChunkSize) {
+    size_t length = size - position < Table::kChunkSize
+                      ? size - position
+                      : Table::kChunkSize;
+    std::memcpy(chunk, source + position, length);
+    const uint8_t * shuffle = &Table::kTable[position % Table::kPeriod];
+    for (size_t byte = 0; byte < length; byte++) {
+      destination[position + byte] = chunk[shuffle[byte]];
+    }
+  }
+}
+
+#if DCL_BULK_BYTE_SWAP_X86
+
+template <typename Layout>
+DCL_TARGET("avx2")
+static size_t
+BulkByteSwapAVX2(const uint8_t * source, uint8_t * destination, size_t size) {
+  using Table = BulkByteSwapTable<Layout>;
+  size_t position = 0;
+  size_t chunk = 0;
+  for (; position + 32 <= size; position += 32) {
+    __m256i shuffle = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(
+      &Table::kTable[chunk * Table::kChunkSize]));
+    __m256i value =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + position));
+    _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(destination + position),
+      _mm256_shuffle_epi8(value, shuffle));
+    chunk = (chunk + 2) % Table::kChunkCount;
+  }
+  return position;
+}
+
+template <typename Layout>
+DCL_TARGET("ssse3")
+static size_t
+BulkByteSwapSSSE3(const uint8_t * source, uint8_t * destination, size_t size) {
+  using Table = BulkByteSwapTable<Layout>;
+  size_t position = 0;
+  size_t chunk = 0;
+  for (; position + 16 <= size; position += 16) {
+    __m128i shuffle = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+      &Table::kTable[chunk * Table::kChunkSize]));
+    __m128i value =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + position));
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i *>(destination + position),
+      _mm_shuffle_epi8(value, shuffle));
+    chunk += 1;
+    if (chunk == Table::kChunkCount) {
+      chunk = 0;
+    }
+  }
+  return position;
+}
+
+#endif // DCL_BULK_BYTE_SWAP_X86
+
+#if DCL_BULK_BYTE_SWAP_NEON
+
+template <typename Layout>
+DCL_ALWAYS_INLINE
+inline size_t
+BulkByteSwapNEON(const uint8_t * source, uint8_t * destination, size_t size) {
+  using Table = BulkByteSwapTable<Layout>;
+  size_t position = 0;
+  size_t chunk = 0;
+  for (; position + 16 <= size; position += 16) {
+    uint8x16_t shuffle = vld1q_u8(&Table::kTable[chunk * Table::kChunkSize]);
+    uint8x16_t value = vld1q_u8(source + position);
+    vst1q_u8(destination + position, vqtbl1q_u8(value, shuffle));
+    chunk += 1;
+    if (chunk == Table::kChunkCount) {
+      chunk = 0;
+    }
+  }
+  return position;
+}
+
+#endif // DCL_BULK_BYTE_SWAP_NEON
+
+} // namespace details
+
+#pragma mark - Bulk Byte Swapping
+
+/// Byte-swaps `count` structs described by `Layout` from `source` into
+/// `destination`. The buffers may be identical but must not otherwise
+/// overlap.
+template <typename Layout>
+DCL_ALWAYS_INLINE
+inline void
+BulkByteSwap(const void * source, void * destination, size_t count) {
+  auto sourceBytes = static_cast<const uint8_t *>(source);
+  auto destinationBytes = static_cast<uint8_t *>(destination);
+  size_t size = count * Layout::size;
+  size_t position = 0;
+
+#if DCL_BULK_BYTE_SWAP_X86
+#if defined(__AVX2__)
+  position =
+    details::BulkByteSwapAVX2<Layout>(sourceBytes, destinationBytes, size);
+#else
+  static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+  static const bool hasSSSE3 = __builtin_cpu_supports("ssse3");
+  if (hasAVX2) {
+    position =
+      details::BulkByteSwapAVX2<Layout>(sourceBytes, destinationBytes, size);
+  } else if (hasSSSE3) {
+    position =
+      details::BulkByteSwapSSSE3<Layout>(sourceBytes, destinationBytes, size);
+  }
+#endif
+#elif DCL_BULK_BYTE_SWAP_NEON
+  position =
+    details::BulkByteSwapNEON<Layout>(sourceBytes, destinationBytes, size);
+#endif
+
+  // The vector loops stop on a 16-byte boundary, which is where the scalar
+  // loop expects each of its chunks to start.
+  details::BulkByteSwapScalar<Layout>(
+    sourceBytes, destinationBytes, position, size);
+}
+
+/// Converts `count` wrapped structs, e.g. an array of `FatArch` or `Section`,
+/// into a host byte order copy of their underlying structs in `destination`.
+/// Structs already in host byte order are copied as is.
+template <typename Wrapper>
+DCL_ALWAYS_INLINE
+inline void BulkSwapToHost(
+  const Wrapper * source,
+  size_t count,
+  typename Wrapper::WrappedTy * destination) {
+  using Wrapped = typename Wrapper::WrappedTy;
+  using Layout = typename FieldLayoutOf<Wrapped>::Type;
+  static_assert(sizeof(Wrapper) == sizeof(Wrapped));
+  static_assert(Layout::size == sizeof(Wrapped));
+  if constexpr (std::is_same_v<typename Wrapper::ByteOrderTy, HostByteOrder>) {
+    std::memmove(destination, source, count * sizeof(Wrapped));
+  } else {
+    BulkByteSwap<Layout>(source, destination, count);
+  }
+}
+
+} // namespace dcl::Platform
+
+#endif // DCL_PLATFORM_BULKBYTESWAP_H
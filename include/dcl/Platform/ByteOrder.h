@@ -16,8 +16,18 @@
 
 #include <dcl/Basic/Basic.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
+
+#if __has_include(<bit>)
+#include <bit>
+#endif
+
+#if DCL_COMPILER_IS_MSVC
+#include <stdlib.h>
+#endif
 
 namespace dcl::Platform {
 
@@ -26,22 +36,22 @@ namespace details {
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapLittleToHost(ResultTy x);
+static DCL_CONSTEXPR ResultTy SwapLittleToHost(ResultTy x);
 
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapBigToHost(ResultTy x);
+static DCL_CONSTEXPR ResultTy SwapBigToHost(ResultTy x);
 
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapHostToLittle(ResultTy x);
+static DCL_CONSTEXPR ResultTy SwapHostToLittle(ResultTy x);
 
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapHostToBig(ResultTy x);
+static DCL_CONSTEXPR ResultTy SwapHostToBig(ResultTy x);
 
 } // namespace details
 
@@ -53,14 +63,14 @@ class LittleEndianess {
 public:
   template <typename ResultTy>
   DCL_ALWAYS_INLINE
-  static ResultTy swapToHost(ResultTy x) {
+  static DCL_CONSTEXPR ResultTy swapToHost(ResultTy x) {
     static_assert(std::numeric_limits<ResultTy>::is_integer);
     return details::SwapLittleToHost(x);
   }
 
   template <typename ResultTy>
   DCL_ALWAYS_INLINE
-  static ResultTy swapFromHost(ResultTy x) {
+  static DCL_CONSTEXPR ResultTy swapFromHost(ResultTy x) {
     static_assert(std::numeric_limits<ResultTy>::is_integer);
     return details::SwapHostToLittle(x);
   }
@@ -71,97 +81,161 @@ class BigEndianess {
 public:
   template <typename ResultTy>
   DCL_ALWAYS_INLINE
-  static ResultTy swapToHost(ResultTy x) {
+  static DCL_CONSTEXPR ResultTy swapToHost(ResultTy x) {
     static_assert(std::numeric_limits<ResultTy>::is_integer);
     return details::SwapBigToHost(x);
   }
 
   template <typename ResultTy>
   DCL_ALWAYS_INLINE
-  static ResultTy swapFromHost(ResultTy x) {
+  static DCL_CONSTEXPR ResultTy swapFromHost(ResultTy x) {
     static_assert(std::numeric_limits<ResultTy>::is_integer);
     return details::SwapHostToBig(x);
   }
 };
 
-#if __LITTLE_ENDIAN__
-using HostByteOrder = LittleEndianess;
-#endif
-#if __BIG_ENDIAN__
-using HostByteOrder = BigEndianess;
+#pragma mark - Host Byte Order
+
+#if defined(__cpp_lib_endian)
+DCL_CONSTEXPR
+static const bool kHostIsLittleEndian =
+  std::endian::native == std::endian::little;
+#elif defined(DCL_LITTLE_ENDIAN)
+DCL_CONSTEXPR
+static const bool kHostIsLittleEndian = true;
+#elif defined(DCL_BIG_ENDIAN)
+DCL_CONSTEXPR
+static const bool kHostIsLittleEndian = false;
+#else
+#error "Unknown host byte order: std::endian is unavailable and neither \
+__LITTLE_ENDIAN__/__BIG_ENDIAN__ nor __BYTE_ORDER__ is defined."
 #endif
 
+using HostByteOrder =
+  std::conditional_t<kHostIsLittleEndian, LittleEndianess, BigEndianess>;
+
 #pragma mark - Implementation Details
 
 namespace details {
 
+template <size_t Size>
+class UnsignedOfSize;
+
+template <>
+class UnsignedOfSize<1> {
+public:
+  using Type = uint8_t;
+};
+
+template <>
+class UnsignedOfSize<2> {
+public:
+  using Type = uint16_t;
+};
+
+template <>
+class UnsignedOfSize<4> {
+public:
+  using Type = uint32_t;
+};
+
+template <>
+class UnsignedOfSize<8> {
+public:
+  using Type = uint64_t;
+};
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static uint8_t ByteSwap(uint8_t x) noexcept { return x; }
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static uint16_t ByteSwap(uint16_t x) noexcept {
+#if __has_builtin(__builtin_bswap16) || DCL_GNUC_PREREQ(4, 8, 0)
+  return __builtin_bswap16(x);
+#elif DCL_COMPILER_IS_MSVC
+  return _byteswap_ushort(x);
+#else
+  return static_cast<uint16_t>((x << 8) | (x >> 8));
+#endif
+}
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static uint32_t ByteSwap(uint32_t x) noexcept {
+#if __has_builtin(__builtin_bswap32) || DCL_GNUC_PREREQ(4, 3, 0)
+  return __builtin_bswap32(x);
+#elif DCL_COMPILER_IS_MSVC
+  return _byteswap_ulong(x);
+#else
+  return ((x & 0x000000ffU) << 24) | ((x & 0x0000ff00U) << 8) |
+         ((x & 0x00ff0000U) >> 8) | ((x & 0xff000000U) >> 24);
+#endif
+}
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static uint64_t ByteSwap(uint64_t x) noexcept {
+#if __has_builtin(__builtin_bswap64) || DCL_GNUC_PREREQ(4, 3, 0)
+  return __builtin_bswap64(x);
+#elif DCL_COMPILER_IS_MSVC
+  return _byteswap_uint64(x);
+#else
+  return (static_cast<uint64_t>(ByteSwap(static_cast<uint32_t>(x))) << 32) |
+         ByteSwap(static_cast<uint32_t>(x >> 32));
+#endif
+}
+
+/// Swaps any integral or enumeration type through the unsigned integer of the
+/// same width, so signed, 8-bit, `long` and `long long` types all resolve to
+/// one of the four intrinsic-backed overloads above.
 template <typename ResultTy>
-DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapLittleToHost(ResultTy x) { return ResultTy(); }
+DCL_CONSTEXPR
+static ResultTy ByteSwapAny(ResultTy x) noexcept {
+  using UnsignedTy = typename UnsignedOfSize<sizeof(ResultTy)>::Type;
+  return static_cast<ResultTy>(ByteSwap(static_cast<UnsignedTy>(x)));
+}
+
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapBigToHost(ResultTy x) { return ResultTy(); }
+static DCL_CONSTEXPR ResultTy SwapLittleToHost(ResultTy x) {
+  if constexpr (kHostIsLittleEndian) {
+    return x;
+  } else {
+    return ByteSwapAny(x);
+  }
+}
+
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapHostToLittle(ResultTy x) { return ResultTy(); }
+static DCL_CONSTEXPR ResultTy SwapBigToHost(ResultTy x) {
+  if constexpr (kHostIsLittleEndian) {
+    return ByteSwapAny(x);
+  } else {
+    return x;
+  }
+}
+
 template <typename ResultTy>
 DCL_UNUSED
 DCL_ALWAYS_INLINE
-static ResultTy SwapHostToBig(ResultTy x) { return ResultTy(); }
-
-} // namespace details
-
-#pragma mark - Implementations for Darwin
+static DCL_CONSTEXPR ResultTy SwapHostToLittle(ResultTy x) {
+  return SwapLittleToHost(x);
+}
 
-#ifdef DCL_TARGET_OS_DARWIN
-
-#include <libkern/OSByteOrder.h>
-
-namespace details {
-template <>
-DCL_ALWAYS_INLINE
-uint16_t SwapLittleToHost(uint16_t x) { return OSSwapLittleToHostInt16(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint32_t SwapLittleToHost(uint32_t x) { return OSSwapLittleToHostInt32(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint64_t SwapLittleToHost(uint64_t x) { return OSSwapLittleToHostInt64(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint16_t SwapBigToHost(uint16_t x) { return OSSwapBigToHostInt16(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint32_t SwapBigToHost(uint32_t x) { return OSSwapBigToHostInt32(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint64_t SwapBigToHost(uint64_t x) { return OSSwapBigToHostInt64(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint16_t SwapHostToLittle(uint16_t x) { return OSSwapHostToLittleInt16(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint32_t SwapHostToLittle(uint32_t x) { return OSSwapHostToLittleInt32(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint64_t SwapHostToLittle(uint64_t x) { return OSSwapHostToLittleInt64(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint16_t SwapHostToBig(uint16_t x) { return OSSwapHostToBigInt16(x); }
-template <>
-DCL_ALWAYS_INLINE
-uint32_t SwapHostToBig(uint32_t x) { return OSSwapHostToBigInt32(x); }
-template <>
+template <typename ResultTy>
+DCL_UNUSED
 DCL_ALWAYS_INLINE
-uint64_t SwapHostToBig(uint64_t x) { return OSSwapHostToBigInt64(x); }
+static DCL_CONSTEXPR ResultTy SwapHostToBig(ResultTy x) {
+  return SwapBigToHost(x);
+}
 
 } // namespace details
 
-#endif // DCL_TARGET_OS_DARWIN
-
 } // namespace dcl::Platform
 
 #endif // DCL_PLATFORM_BYTEORDER_H
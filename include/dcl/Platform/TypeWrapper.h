@@ -16,6 +16,8 @@
 
 #include <dcl/Basic/Basic.h>
 #include <dcl/Platform/ByteOrder.h>
+
+#include <type_traits>
 #include <utility>
 
 namespace dcl::Platform {
@@ -27,6 +29,10 @@ private:
   Wrapped _wrappedValue;
 
 public:
+  using WrappedTy = Wrapped;
+
+  using ByteOrderTy = ByteOrder;
+
   DCL_ALWAYS_INLINE
   DCL_CONSTEXPR
   explicit TypeWrapper(Wrapped wrappedValue) noexcept
@@ -61,22 +67,24 @@ public:
 #define DCL_PLATFORM_TYPE_GETTER(TYPE, NAME, MEMBER)                           \
   DCL_ALWAYS_INLINE                                                            \
   TYPE get##NAME() const {                                                     \
-    if (std::is_same<ByteOrder, dcl::Platform::HostByteOrder>()) {             \
+    if constexpr (std::is_same_v<ByteOrder, dcl::Platform::HostByteOrder>) {   \
       return static_cast<TYPE>(this->getWrappedValue().MEMBER);                \
+    } else {                                                                   \
+      return static_cast<TYPE>(                                                \
+        ByteOrder::swapToHost(this->getWrappedValue().MEMBER));                \
     }                                                                          \
-    return static_cast<TYPE>(                                                  \
-      ByteOrder::swapToHost(this->getWrappedValue().MEMBER));                  \
   }
 
 #define DCL_PLATFORM_TYPE_SETTER(TYPE, NAME, MEMBER)                           \
   DCL_ALWAYS_INLINE                                                            \
   void set##NAME(TYPE x) {                                                     \
     using MemberTy = decltype(this->getWrappedValue().MEMBER);                 \
-    if (std::is_same<ByteOrder, dcl::Platform::HostByteOrder>()) {             \
+    if constexpr (std::is_same_v<ByteOrder, dcl::Platform::HostByteOrder>) {   \
       this->getWrappedValue().MEMBER = static_cast<MemberTy>(x);               \
+    } else {                                                                   \
+      this->getWrappedValue().MEMBER =                                         \
+        ByteOrder::swapFromHost(static_cast<MemberTy>(x));                     \
     }                                                                          \
-    this->getWrappedValue().MEMBER =                                           \
-      static_cast<MemberTy>(ByteOrder::swapFromHost(x));                       \
   }
 
 #define DCL_PLATFORM_TYPE_ACCESSOR(TYPE, NAME, MEMBER)                         \
@@ -0,0 +1,122 @@
+//===--- ThreadPool.cpp - Reusable Worker Threads ---------------*- C++ -*-===//
+//
+// This source file is part of the DCL open source project
+//
+// Copyright (c) 2022 Li Yu-Long and the DCL project authors
+// Licensed under Apache 2.0 License
+//
+// See https://github.com/dcl-project/dcl/LICENSE.txt for license information
+// See https://github.com/dcl-project/dcl/graphs/contributors for the list of
+// DCL project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include <dcl/Basic/ThreadPool.h>
+
+#include <algorithm>
+
+namespace dcl {
+
+ThreadPool::ThreadPool(unsigned threadCount)
+  : _isBusy(false), _work(nullptr), _context(nullptr), _count(0),
+    _nextIndex(0), _helperCount(0), _busyHelperCount(0), _generation(0),
+    _isStopping(false) {
+  if (threadCount == 0) {
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+  _workers.reserve(threadCount - 1);
+  for (unsigned index = 1; index < threadCount; index++) {
+    _workers.emplace_back([this, index]() { runWorker(index - 1); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _isStopping = true;
+  }
+  _wakeCondition.notify_all();
+  for (std::thread& eachWorker : _workers) {
+    eachWorker.join();
+  }
+}
+
+ThreadPool& ThreadPool::getShared() {
+  static ThreadPool shared;
+  return shared;
+}
+
+void ThreadPool::run(
+  size_t count,
+  unsigned threadCount,
+  WorkFn work,
+  void * context) {
+  if (threadCount == 0 || threadCount > getThreadCount()) {
+    threadCount = getThreadCount();
+  }
+  auto helperCount =
+    static_cast<unsigned>(std::min<size_t>(threadCount - 1, count));
+  bool isIdle = false;
+  if (helperCount == 0 || !_isBusy.compare_exchange_strong(isIdle, true)) {
+    for (size_t index = 0; index < count; index++) {
+      work(context, index);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _work = work;
+    _context = context;
+    _count = count;
+    _nextIndex.store(0, std::memory_order_relaxed);
+    _helperCount = helperCount;
+    _busyHelperCount = helperCount;
+    _generation++;
+  }
+  _wakeCondition.notify_all();
+  drain();
+  {
+    std::unique_lock<std::mutex> lock{_mutex};
+    _doneCondition.wait(lock, [this]() { return _busyHelperCount == 0; });
+    _work = nullptr;
+    _context = nullptr;
+  }
+  _isBusy.store(false);
+}
+
+void ThreadPool::drain() {
+  for (;;) {
+    size_t index = _nextIndex.fetch_add(1, std::memory_order_relaxed);
+    if (index >= _count) {
+      return;
+    }
+    _work(_context, index);
+  }
+}
+
+void ThreadPool::runWorker(unsigned workerIndex) {
+  uint64_t generation = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock{_mutex};
+      _wakeCondition.wait(lock, [&]() {
+        return _isStopping ||
+               (_generation != generation && workerIndex < _helperCount);
+      });
+      if (_isStopping) {
+        return;
+      }
+      generation = _generation;
+    }
+    drain();
+    {
+      std::lock_guard<std::mutex> lock{_mutex};
+      if (--_busyHelperCount == 0) {
+        _doneCondition.notify_one();
+      }
+    }
+  }
+}
+
+} // namespace dcl
@@ -0,0 +1,421 @@
+#include <dcl/IO/BatchLoader.h>
+
+#include <dcl/Basic/ThreadPool.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+
+// BSD system includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+
+// Opens, stats and closes through the ring need Linux 5.6, whose headers
+// are the first to define `IO_URING_OP_SUPPORTED`. The running kernel may
+// still be older, hence the opcodes are probed for before use. liburing is
+// not required, the ring is driven through the system calls directly.
+#if defined(IO_URING_OP_SUPPORTED) && defined(STATX_SIZE) &&                   \
+  defined(__NR_io_uring_setup) && defined(__NR_io_uring_register)
+#define DCL_HAS_IO_URING 1
+#else
+#define DCL_HAS_IO_URING 0
+#endif
+
+namespace dcl {
+
+namespace IO {
+
+namespace {
+
+/// Loads the header of the file at `path` into `bytes`.
+static void loadHeader(
+  const char *path, uint8_t *bytes, size_t headerSize,
+  BatchEntry &entry) noexcept {
+  entry = BatchEntry{0, 0, 0};
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    entry.error = errno;
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) == -1) {
+    entry.error = errno;
+    close(fd);
+    return;
+  }
+  entry.fileSize = static_cast<uint64_t>(st.st_size);
+
+  while (entry.size < headerSize) {
+    ssize_t count = pread(
+      fd,
+      bytes + entry.size,
+      headerSize - entry.size,
+      static_cast<off_t>(entry.size));
+    if (count == -1 && errno == EINTR) {
+      continue;
+    }
+    if (count == -1) {
+      entry.error = errno;
+      break;
+    }
+    if (count == 0) {
+      break;
+    }
+    entry.size += static_cast<size_t>(count);
+  }
+  close(fd);
+}
+
+#if DCL_HAS_IO_URING
+
+/// An io_uring whose submissions are all waited for at once.
+class Ring {
+
+private:
+  int _fd = -1;
+
+  uint8_t *_sq = nullptr;
+
+  size_t _sqSize = 0;
+
+  uint8_t *_cq = nullptr;
+
+  size_t _cqSize = 0;
+
+  io_uring_sqe *_sqes = nullptr;
+
+  size_t _sqesSize = 0;
+
+  unsigned _entries = 0;
+
+  unsigned _pending = 0;
+
+  io_uring_params _params{};
+
+public:
+  Ring() = default;
+
+  Ring(const Ring &) = delete;
+
+  Ring &operator=(const Ring &) = delete;
+
+  ~Ring() noexcept {
+    if (_sqes) {
+      munmap(_sqes, _sqesSize);
+    }
+    if (_cq && _cq != _sq) {
+      munmap(_cq, _cqSize);
+    }
+    if (_sq) {
+      munmap(_sq, _sqSize);
+    }
+    if (_fd != -1) {
+      close(_fd);
+    }
+  }
+
+  /// Sets the ring up with room for `entries` submissions. Fails where
+  /// io_uring is not supported or not allowed, or may drop completions.
+  bool setup(unsigned entries) noexcept {
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &_params));
+    if (fd < 0) {
+      return false;
+    }
+    _fd = fd;
+    _entries = _params.sq_entries;
+    if (!(_params.features & IORING_FEAT_NODROP)) {
+      return false;
+    }
+
+    _sqSize = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+    _cqSize =
+      _params.cq_off.cqes + _params.cq_entries * sizeof(io_uring_cqe);
+    bool isSingleMapping = _params.features & IORING_FEAT_SINGLE_MMAP;
+    if (isSingleMapping) {
+      _sqSize = _cqSize = std::max(_sqSize, _cqSize);
+    }
+
+    _sq = map(_sqSize, IORING_OFF_SQ_RING);
+    if (!_sq) {
+      return false;
+    }
+    _cq = isSingleMapping ? _sq : map(_cqSize, IORING_OFF_CQ_RING);
+    _sqesSize = _params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = reinterpret_cast<io_uring_sqe *>(map(_sqesSize, IORING_OFF_SQES));
+    return _cq && _sqes;
+  }
+
+  DCL_ALWAYS_INLINE
+  unsigned getEntries() const noexcept { return _entries; }
+
+  /// Whether the kernel supports every opcode of `opcodes`. Kernels older
+  /// than probing, i.e. than Linux 5.6, support none of them.
+  bool supports(std::initializer_list<uint8_t> opcodes) noexcept {
+    const unsigned probeCount = 256;
+    std::vector<uint8_t> bytes(
+      sizeof(io_uring_probe) + probeCount * sizeof(io_uring_probe_op));
+    auto probe = reinterpret_cast<io_uring_probe *>(bytes.data());
+    long result = syscall(
+      __NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, probeCount);
+    if (result < 0) {
+      return false;
+    }
+    return std::all_of(opcodes.begin(), opcodes.end(), [&](uint8_t opcode) {
+      return opcode <= probe->last_op &&
+             (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+    });
+  }
+
+  /// Queues a cleared submission, to be submitted by `run`.
+  io_uring_sqe *push(uint64_t userData) noexcept {
+    unsigned tail = *at(_sq, _params.sq_off.tail) + _pending;
+    unsigned index = tail & *at(_sq, _params.sq_off.ring_mask);
+    io_uring_sqe *sqe = &_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = userData;
+    at(_sq, _params.sq_off.array)[index] = index;
+    _pending++;
+    return sqe;
+  }
+
+  /// Submits the queued submissions and hands each of their completions to
+  /// `body`. Returns false if the ring fails.
+  template <typename Body>
+  bool run(Body &&body) noexcept {
+    unsigned count = _pending;
+    unsigned *sqTail = at(_sq, _params.sq_off.tail);
+    __atomic_store_n(sqTail, *sqTail + count, __ATOMIC_RELEASE);
+    _pending = 0;
+
+    unsigned *cqHead = at(_cq, _params.cq_off.head);
+    unsigned *cqTail = at(_cq, _params.cq_off.tail);
+    unsigned cqMask = *at(_cq, _params.cq_off.ring_mask);
+    auto cqes = reinterpret_cast<io_uring_cqe *>(_cq + _params.cq_off.cqes);
+
+    unsigned submitted = 0;
+    unsigned completed = 0;
+    while (completed < count) {
+      long result = syscall(
+        __NR_io_uring_enter,
+        _fd,
+        count - submitted,
+        1,
+        IORING_ENTER_GETEVENTS,
+        nullptr,
+        0);
+      if (result < 0 && errno != EINTR) {
+        return false;
+      }
+      if (result > 0) {
+        submitted += static_cast<unsigned>(result);
+      }
+
+      unsigned head = *cqHead;
+      unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+      for (; head != tail; head++, completed++) {
+        body(cqes[head & cqMask]);
+      }
+      __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+    return true;
+  }
+
+private:
+  uint8_t *map(size_t size, off_t offset) noexcept {
+    void *mapping = mmap(
+      0, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, offset);
+    return mapping == MAP_FAILED ? nullptr : static_cast<uint8_t *>(mapping);
+  }
+
+  DCL_ALWAYS_INLINE
+  static unsigned *at(uint8_t *ring, uint32_t offset) noexcept {
+    return reinterpret_cast<unsigned *>(ring + offset);
+  }
+};
+
+DCL_CONSTEXPR
+static const unsigned kRingEntries = 256;
+
+#endif
+
+} // namespace
+
+bool BatchLoader::load(
+  const char *const *paths,
+  size_t count,
+  BatchMethod method,
+  unsigned threadCount) {
+  _buffer.resize(count * _headerSize);
+  _entries.assign(count, BatchEntry{0, 0, 0});
+
+  if (method != BatchMethod::ThreadPool && loadWithIOURing(paths, count)) {
+    _method = BatchMethod::IOURing;
+  } else {
+    loadWithThreadPool(paths, count, threadCount);
+    _method = BatchMethod::ThreadPool;
+  }
+
+  return std::all_of(_entries.begin(), _entries.end(), [](auto &entry) {
+    return entry.isLoaded();
+  });
+}
+
+bool BatchLoader::loadWithIOURing(const char *const *paths, size_t count) {
+#if DCL_HAS_IO_URING
+  Ring ring;
+  if (!ring.setup(kRingEntries)) {
+    return false;
+  }
+  if (!ring.supports({IORING_OP_OPENAT,
+                      IORING_OP_STATX,
+                      IORING_OP_READ,
+                      IORING_OP_CLOSE})) {
+    return false;
+  }
+
+  // Opening and stating take a submission each.
+  size_t batchSize = ring.getEntries() / 2;
+  std::vector<int> fds(batchSize);
+  std::vector<struct statx> stats(batchSize);
+  std::vector<uint8_t> isAtEnd(batchSize);
+
+  for (size_t first = 0; first < count; first += batchSize) {
+    size_t last = std::min(count, first + batchSize);
+    std::fill(fds.begin(), fds.end(), -1);
+    for (size_t index = first; index < last; index++) {
+      size_t slot = index - first;
+      io_uring_sqe *open = ring.push(slot * 2);
+      open->opcode = IORING_OP_OPENAT;
+      open->fd = AT_FDCWD;
+      open->addr = reinterpret_cast<uintptr_t>(paths[index]);
+      open->open_flags = O_RDONLY | O_CLOEXEC;
+
+      io_uring_sqe *stat = ring.push(slot * 2 + 1);
+      stat->opcode = IORING_OP_STATX;
+      stat->fd = AT_FDCWD;
+      stat->addr = reinterpret_cast<uintptr_t>(paths[index]);
+      stat->len = STATX_SIZE;
+      stat->off = reinterpret_cast<uintptr_t>(&stats[slot]);
+    }
+    bool isRun = ring.run([&](const io_uring_cqe &cqe) {
+      size_t slot = cqe.user_data / 2;
+      BatchEntry &entry = _entries[first + slot];
+      if (cqe.user_data % 2 == 0) {
+        fds[slot] = cqe.res;
+        if (cqe.res < 0) {
+          entry.error = -cqe.res;
+        }
+      } else if (cqe.res < 0) {
+        entry.error = entry.error ? entry.error : -cqe.res;
+      } else {
+        entry.fileSize = stats[slot].stx_size;
+      }
+    });
+    if (!isRun) {
+      // Closes what was opened before the ring failed.
+      for (int eachFd : fds) {
+        if (eachFd >= 0) {
+          close(eachFd);
+        }
+      }
+      return false;
+    }
+
+    // Reads until the header is full or the file ends, as `loadHeader`
+    // does, resubmitting short reads for the remainder.
+    std::fill(isAtEnd.begin(), isAtEnd.end(), false);
+    bool hasReads = true;
+    while (isRun && hasReads) {
+      hasReads = false;
+      for (size_t index = first; index < last; index++) {
+        size_t slot = index - first;
+        BatchEntry &entry = _entries[index];
+        if (
+          fds[slot] < 0 || entry.error || isAtEnd[slot] ||
+          entry.size == _headerSize) {
+          continue;
+        }
+        io_uring_sqe *read = ring.push(slot);
+        read->opcode = IORING_OP_READ;
+        read->fd = fds[slot];
+        read->addr = reinterpret_cast<uintptr_t>(_buffer.data()) +
+                     index * _headerSize + entry.size;
+        read->len = static_cast<uint32_t>(_headerSize - entry.size);
+        read->off = entry.size;
+        hasReads = true;
+      }
+      if (!hasReads) {
+        break;
+      }
+      isRun = ring.run([&](const io_uring_cqe &cqe) {
+        BatchEntry &entry = _entries[first + cqe.user_data];
+        if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+          return;
+        }
+        if (cqe.res < 0) {
+          entry.error = -cqe.res;
+        } else if (cqe.res == 0) {
+          isAtEnd[cqe.user_data] = true;
+        } else {
+          entry.size += static_cast<size_t>(cqe.res);
+        }
+      });
+    }
+
+    for (size_t index = first; index < last; index++) {
+      size_t slot = index - first;
+      if (fds[slot] < 0) {
+        continue;
+      }
+      io_uring_sqe *close = ring.push(slot);
+      close->opcode = IORING_OP_CLOSE;
+      close->fd = fds[slot];
+    }
+    bool isClosed =
+      ring.run([&](const io_uring_cqe &cqe) { fds[cqe.user_data] = -1; });
+    if (!isClosed) {
+      // Closes what the ring did not before it failed.
+      for (int eachFd : fds) {
+        if (eachFd >= 0) {
+          close(eachFd);
+        }
+      }
+    }
+    if (!isRun || !isClosed) {
+      return false;
+    }
+  }
+  return true;
+#else
+  (void)paths;
+  (void)count;
+  return false;
+#endif
+}
+
+void BatchLoader::loadWithThreadPool(
+  const char *const *paths, size_t count, unsigned threadCount) {
+  ThreadPool::getShared().forEachIndex(
+    count,
+    [&](size_t index) {
+      loadHeader(
+        paths[index],
+        _buffer.data() + index * _headerSize,
+        _headerSize,
+        _entries[index]);
+    },
+    threadCount);
+}
+
+} // namespace IO
+
+} // namespace dcl
@@ -1,6 +1,9 @@
 
 #include <dcl/IO/File.h>
 
+#include <algorithm>
+#include <climits>
+
 // BSD system includes
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -16,8 +19,6 @@ namespace {
 DCL_ALWAYS_INLINE
 DCL_CONSTEXPR
 static uint32_t makeFlags(Permissions permissions) noexcept {
-  uint32_t flags = O_RDONLY;
-
   if (permissions == Permissions::Read) {
     return O_RDONLY;
   }
@@ -27,7 +28,7 @@ static uint32_t makeFlags(Permissions permissions) noexcept {
   }
   
   if (permissions == (Permissions::Write | Permissions::Read)) {
-    return O_RDONLY | O_WRONLY;
+    return O_RDWR;
   }
 
   return O_RDONLY;
@@ -53,9 +54,82 @@ static int makeProt(Permissions permissions) noexcept {
   return prot;
 }
 
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static int makeMemoryAdvice(AccessPattern pattern) noexcept {
+  switch (pattern) {
+  case AccessPattern::Normal:
+    return MADV_NORMAL;
+  case AccessPattern::Sequential:
+    return MADV_SEQUENTIAL;
+  case AccessPattern::Random:
+    return MADV_RANDOM;
+  case AccessPattern::WillNeed:
+    return MADV_WILLNEED;
+  }
+  return MADV_NORMAL;
+}
+
+/// Advises the page cache of the file, which read-ahead through `read` and
+/// through faults of other mappings of the file benefit from.
+static bool adviseFile(
+  int fd, AccessPattern pattern, size_t offset, size_t length) noexcept {
+#if defined(POSIX_FADV_NORMAL)
+  int advice = POSIX_FADV_NORMAL;
+  switch (pattern) {
+  case AccessPattern::Normal:
+    advice = POSIX_FADV_NORMAL;
+    break;
+  case AccessPattern::Sequential:
+    advice = POSIX_FADV_SEQUENTIAL;
+    break;
+  case AccessPattern::Random:
+    advice = POSIX_FADV_RANDOM;
+    break;
+  case AccessPattern::WillNeed:
+    advice = POSIX_FADV_WILLNEED;
+    break;
+  }
+  return posix_fadvise(fd, offset, length, advice) == 0;
+#elif defined(F_RDADVISE)
+  // Darwin has no `posix_fadvise`, only an explicit read-ahead.
+  if (pattern != AccessPattern::WillNeed) {
+    return true;
+  }
+  struct radvisory advisory;
+  advisory.ra_offset = static_cast<off_t>(offset);
+  advisory.ra_count = static_cast<int>(std::min<size_t>(length, INT_MAX));
+  return fcntl(fd, F_RDADVISE, &advisory) != -1;
+#else
+  return true;
+#endif
+}
+
+DCL_ALWAYS_INLINE
+DCL_CONSTEXPR
+static int makeMapFlags(MappingOptions options) noexcept {
+  int flags = MAP_SHARED;
+
+  if (HasMappingOptions(options, MappingOptions::Private)) {
+    flags = MAP_PRIVATE;
+  }
+
+#if defined(MAP_POPULATE)
+  if (HasMappingOptions(options, MappingOptions::Populate)) {
+    flags |= MAP_POPULATE;
+  }
+#endif
+
+  return flags;
+}
+
 } // namespace
 
-File::File(const char *path, Permissions permissions) noexcept {
+File::File(
+  const char *path,
+  Permissions permissions,
+  AccessPattern pattern,
+  MappingOptions options) noexcept {
   int fd = open(path, makeFlags(permissions), nullptr);
 
 #if DEBUG
@@ -74,24 +148,96 @@ File::File(const char *path, Permissions permissions) noexcept {
   struct stat st;
   rc = fstat(fd, &st);
   size_t size = static_cast<size_t>(st.st_size);
-  int prot = 0;
 
-  void *header = mmap(0, size, makeProt(permissions), MAP_SHARED, fd, 0);
+  if (HasMappingOptions(options, MappingOptions::Deferred)) {
+    _fd = fd;
+    _size = size;
+    _buffer = nullptr;
+    if (pattern != AccessPattern::Normal) {
+      advise(pattern);
+    }
+    return;
+  }
+
+  int prot = makeProt(permissions);
+  if (HasMappingOptions(options, MappingOptions::Private)) {
+    // Copy-on-write pages are writable even if the file is not.
+    prot |= PROT_READ | PROT_WRITE;
+  }
+
+  void *header = mmap(0, size, prot, makeMapFlags(options), fd, 0);
+  if (header == MAP_FAILED) {
+    close(fd);
+    _fd = -1;
+    _size = 0;
+    _buffer = nullptr;
+    return;
+  }
 
   _fd = fd;
   _size = size;
   _buffer = header;
+
+#if defined(MADV_HUGEPAGE)
+  if (HasMappingOptions(options, MappingOptions::HugePages)) {
+    // Only an advice, the mapping works all the same without.
+    madvise(header, size, MADV_HUGEPAGE);
+  }
+#endif
+
+#if !defined(MAP_POPULATE)
+  if (HasMappingOptions(options, MappingOptions::Populate)) {
+    madvise(header, size, MADV_WILLNEED);
+  }
+#endif
+
+  if (pattern != AccessPattern::Normal) {
+    advise(pattern);
+  }
+}
+
+bool File::advise(AccessPattern pattern) noexcept {
+  if (_fd == -1) {
+    return false;
+  }
+
+  bool isAdvised =
+    !_buffer || madvise(_buffer, _size, makeMemoryAdvice(pattern)) == 0;
+  // Zero length stands for the whole file.
+  isAdvised &= adviseFile(_fd, pattern, 0, 0);
+  return isAdvised;
+}
+
+bool File::prefetch(size_t offset, size_t length) noexcept {
+  if (_fd == -1 || offset >= _size) {
+    return false;
+  }
+
+  length = std::min(length, _size - offset);
+  // `madvise` takes page aligned addresses only.
+  size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t alignedOffset = offset & ~(pageSize - 1);
+  length += offset - alignedOffset;
+
+  bool isAdvised = true;
+  if (_buffer) {
+    uint8_t *begin = static_cast<uint8_t *>(_buffer) + alignedOffset;
+    isAdvised = madvise(begin, length, MADV_WILLNEED) == 0;
+  }
+  isAdvised &= adviseFile(_fd, AccessPattern::WillNeed, alignedOffset, length);
+  return isAdvised;
 }
 
 File::~File() noexcept {
-  if (!_buffer) {
-    DCLAssert(_fd == -1);
+  if (_fd == -1) {
+    DCLAssert(!_buffer);
     return;
   }
 
-  DCLAssert(_fd != -1);
-  int result = munmap(_buffer, _size);
-  result = close(_fd);
+  if (_buffer) {
+    munmap(_buffer, _size);
+  }
+  close(_fd);
 }
 
 } // namespace IO
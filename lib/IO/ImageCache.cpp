@@ -0,0 +1,139 @@
+#include <dcl/IO/ImageCache.h>
+
+#include <iterator>
+
+// BSD system includes
+#include <sys/stat.h>
+
+namespace dcl {
+
+namespace IO {
+
+namespace {
+
+/// The modification time in `st`, in nanoseconds since the epoch.
+int64_t getModificationTime(const struct stat &st) noexcept {
+#if defined(__APPLE__)
+  const struct timespec &time = st.st_mtimespec;
+#else
+  const struct timespec &time = st.st_mtim;
+#endif
+  return int64_t(time.tv_sec) * 1000000000 + time.tv_nsec;
+}
+
+} // namespace
+
+ImageCache::Handle ImageCache::open(const char *path) {
+  struct stat st;
+  if (stat(path, &st) == -1) {
+    std::lock_guard<std::mutex> lock{_mutex};
+    _missCount++;
+    return nullptr;
+  }
+
+  std::string key{path};
+  {
+    std::lock_guard<std::mutex> lock{_mutex};
+    auto found = _imagesByPath.find(key);
+    if (found != _imagesByPath.end()) {
+      const CachedImage &image = **found->second;
+      if (
+        image._modificationTime == getModificationTime(st) &&
+        image.getSize() == static_cast<size_t>(st.st_size)) {
+        _hitCount++;
+        touch(found->second);
+        return _images.front();
+      }
+      // The file was modified since it was mapped.
+      evict(found->second);
+    }
+    _missCount++;
+  }
+
+  // Mapping and reading the UUID are done without holding the lock, which
+  // lets other images be looked up in the meantime.
+  File file{path, Permissions::Read};
+  struct stat mappedStat;
+  if (!file.getBytes() || fstat(file.getFd(), &mappedStat) == -1) {
+    return nullptr;
+  }
+  auto image = std::make_shared<CachedImage>(
+    std::move(file), key, getModificationTime(mappedStat));
+  if (_readUUID) {
+    image->_hasUUID =
+      _readUUID(image->getBytes(), image->getSize(), image->_uuid);
+  }
+
+  std::lock_guard<std::mutex> lock{_mutex};
+  auto found = _imagesByPath.find(key);
+  if (found != _imagesByPath.end()) {
+    // Another thread mapped the same file meanwhile.
+    evict(found->second);
+  }
+  _images.push_front(image);
+  _imagesByPath[key] = _images.begin();
+  if (image->_hasUUID) {
+    _imagesByUUID[image->_uuid] = _images.begin();
+  }
+  _size += image->getSize();
+  evictOverBudget();
+  return image;
+}
+
+ImageCache::Handle ImageCache::find(const ImageUUID &uuid) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  auto found = _imagesByUUID.find(uuid);
+  if (found == _imagesByUUID.end()) {
+    _missCount++;
+    return nullptr;
+  }
+  _hitCount++;
+  touch(found->second);
+  return _images.front();
+}
+
+void ImageCache::setBudget(size_t budget) {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _budget = budget;
+  evictOverBudget();
+}
+
+void ImageCache::clear() {
+  std::lock_guard<std::mutex> lock{_mutex};
+  _images.clear();
+  _imagesByPath.clear();
+  _imagesByUUID.clear();
+  _size = 0;
+}
+
+void ImageCache::touch(ImageList::iterator image) {
+  // Splicing keeps the iterators of the indices valid.
+  _images.splice(_images.begin(), _images, image);
+}
+
+void ImageCache::evict(ImageList::iterator image) {
+  const CachedImage &evicted = **image;
+  auto byPath = _imagesByPath.find(evicted._path);
+  if (byPath != _imagesByPath.end() && byPath->second == image) {
+    _imagesByPath.erase(byPath);
+  }
+  if (evicted._hasUUID) {
+    // Another image of the same UUID may have replaced it in the index.
+    auto byUUID = _imagesByUUID.find(evicted._uuid);
+    if (byUUID != _imagesByUUID.end() && byUUID->second == image) {
+      _imagesByUUID.erase(byUUID);
+    }
+  }
+  _size -= evicted.getSize();
+  _images.erase(image);
+}
+
+void ImageCache::evictOverBudget() {
+  while (_size > _budget && !_images.empty()) {
+    evict(std::prev(_images.end()));
+  }
+}
+
+} // namespace IO
+
+} // namespace dcl
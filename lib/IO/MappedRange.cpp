@@ -0,0 +1,53 @@
+#include <dcl/IO/File.h>
+#include <dcl/IO/MappedRange.h>
+
+#include <algorithm>
+
+// BSD system includes
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace dcl {
+
+namespace IO {
+
+MappedRange::MappedRange(
+  const File& file, size_t offset, size_t length) noexcept
+  : MappedRange() {
+  if (file.getFd() == -1 || offset >= file.getSize() || length == 0) {
+    return;
+  }
+
+  size_t size = std::min(length, file.getSize() - offset);
+  size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t alignedOffset = offset & ~(pageSize - 1);
+  size_t mappingSize = offset - alignedOffset + size;
+
+  void * mapping = mmap(
+    0,
+    mappingSize,
+    PROT_READ,
+    MAP_SHARED,
+    file.getFd(),
+    static_cast<off_t>(alignedOffset));
+  if (mapping == MAP_FAILED) {
+    return;
+  }
+
+  _mapping = mapping;
+  _mappingSize = mappingSize;
+  _offset = offset;
+  _size = size;
+}
+
+MappedRange::~MappedRange() noexcept {
+  if (!_mapping) {
+    return;
+  }
+
+  munmap(_mapping, _mappingSize);
+}
+
+} // namespace IO
+
+} // namespace dcl
@@ -0,0 +1,112 @@
+#include <dcl/IO/StreamReader.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+// BSD system includes
+#include <unistd.h>
+
+namespace dcl {
+
+namespace IO {
+
+namespace {
+
+/// Reads up to `length` bytes, retrying interrupted reads. Returns the
+/// number of bytes read, zero at the end of the stream, or -1 with `errno`
+/// set on failure.
+ssize_t readSome(int fd, void *destination, size_t length) noexcept {
+  while (true) {
+    ssize_t count = ::read(fd, destination, length);
+    if (count >= 0 || errno != EINTR) {
+      return count;
+    }
+  }
+}
+
+} // namespace
+
+StreamReader::StreamReader(
+  int fd, size_t bufferSize, size_t maxLookahead) noexcept
+  : _fd(fd), _buffer(bufferSize), _begin(0), _end(0), _offset(0),
+    _maxLookahead(maxLookahead), _isAtEnd(fd == -1), _error(0) {}
+
+const void *StreamReader::peek(size_t length) noexcept {
+  if (length > _maxLookahead || !fill(length)) {
+    return nullptr;
+  }
+  return _buffer.data() + _begin;
+}
+
+bool StreamReader::read(void *destination, size_t length) noexcept {
+  auto bytes = static_cast<uint8_t *>(destination);
+  size_t buffered = std::min(length, _end - _begin);
+  std::memcpy(bytes, _buffer.data() + _begin, buffered);
+  _begin += buffered;
+  _offset += buffered;
+
+  // The rest bypasses the buffer.
+  size_t copied = buffered;
+  while (copied < length && !_isAtEnd && _error == 0) {
+    ssize_t count = readSome(_fd, bytes + copied, length - copied);
+    if (count < 0) {
+      _error = errno;
+      break;
+    }
+    if (count == 0) {
+      _isAtEnd = true;
+      break;
+    }
+    copied += count;
+    _offset += count;
+  }
+  return copied == length;
+}
+
+bool StreamReader::skip(size_t length) noexcept {
+  while (length > 0) {
+    if (_begin == _end && !fill(1)) {
+      return false;
+    }
+    size_t buffered = std::min(length, _end - _begin);
+    _begin += buffered;
+    _offset += buffered;
+    length -= buffered;
+  }
+  return true;
+}
+
+bool StreamReader::fill(size_t length) noexcept {
+  while (_end - _begin < length) {
+    if (_isAtEnd || _error != 0) {
+      return false;
+    }
+    if (_buffer.size() - _begin < length || _end == _buffer.size()) {
+      // Move the buffered bytes to the front, growing the buffer if they
+      // cannot fit together with the bytes to come.
+      std::memmove(_buffer.data(), _buffer.data() + _begin, _end - _begin);
+      _end -= _begin;
+      _begin = 0;
+      if (_buffer.size() < length) {
+        _buffer.resize(std::max(length, _buffer.size() * 2));
+      }
+    }
+    ssize_t count =
+      readSome(_fd, _buffer.data() + _end, _buffer.size() - _end);
+    if (count < 0) {
+      _error = errno;
+      return false;
+    }
+    if (count == 0) {
+      _isAtEnd = true;
+      return false;
+    }
+    _end += count;
+  }
+  return true;
+}
+
+} // namespace IO
+
+} // namespace dcl
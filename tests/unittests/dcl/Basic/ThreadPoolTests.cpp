@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Basic/ThreadPool.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace dcl;
+
+TEST(ThreadPool, visits_every_index_once) {
+  ThreadPool pool{4};
+  EXPECT_EQ(pool.getThreadCount(), 4);
+  for (size_t count : {0, 1, 3, 1000}) {
+    std::vector<std::atomic<int>> visits(count);
+    pool.forEachIndex(count, [&](size_t index) { visits[index]++; });
+    for (size_t index = 0; index < count; index++) {
+      EXPECT_EQ(visits[index], 1) << index;
+    }
+  }
+}
+
+TEST(ThreadPool, reuses_its_threads) {
+  ThreadPool pool{4};
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  for (int round = 0; round < 100; round++) {
+    pool.forEachIndex(64, [&](size_t) {
+      std::lock_guard<std::mutex> lock{mutex};
+      threads.insert(std::this_thread::get_id());
+    });
+  }
+  EXPECT_LE(threads.size(), 4);
+}
+
+TEST(ThreadPool, limits_threads) {
+  ThreadPool pool{4};
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+  pool.forEachIndex(
+    1000,
+    [&](size_t) {
+      std::lock_guard<std::mutex> lock{mutex};
+      threads.insert(std::this_thread::get_id());
+    },
+    1);
+  ASSERT_EQ(threads.size(), 1);
+  EXPECT_EQ(*threads.begin(), std::this_thread::get_id());
+}
+
+TEST(ThreadPool, runs_nested_loops_inline) {
+  ThreadPool pool{4};
+  std::atomic<size_t> total{0};
+  pool.forEachIndex(8, [&](size_t) {
+    pool.forEachIndex(8, [&](size_t) { total++; });
+  });
+  EXPECT_EQ(total, 64);
+}
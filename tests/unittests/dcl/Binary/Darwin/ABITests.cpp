@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/ABI/Fat.h>
+#include <dcl/Binary/Darwin/ABI/FixupChains.h>
+#include <dcl/Binary/Darwin/ABI/Loader.h>
+#include <dcl/Binary/Darwin/ABI/Nlist.h>
+
+TEST(ABI, mach_o_layouts) {
+  EXPECT_EQ(sizeof(mach_header), 28);
+  EXPECT_EQ(sizeof(mach_header_64), 32);
+  EXPECT_EQ(sizeof(load_command), 8);
+  EXPECT_EQ(sizeof(segment_command), 56);
+  EXPECT_EQ(sizeof(segment_command_64), 72);
+  EXPECT_EQ(sizeof(section), 68);
+  EXPECT_EQ(sizeof(section_64), 80);
+  EXPECT_EQ(sizeof(symtab_command), 24);
+  EXPECT_EQ(sizeof(dyld_info_command), 48);
+  EXPECT_EQ(sizeof(linkedit_data_command), 16);
+}
+
+TEST(ABI, fat_layouts) {
+  EXPECT_EQ(sizeof(fat_header), 8);
+  EXPECT_EQ(sizeof(fat_arch), 20);
+  EXPECT_EQ(sizeof(fat_arch_64), 32);
+}
+
+TEST(ABI, nlist_layouts) {
+  EXPECT_EQ(sizeof(struct nlist), 12);
+  EXPECT_EQ(sizeof(nlist_64), 16);
+}
+
+TEST(ABI, fixup_chains_layouts) {
+  EXPECT_EQ(__MACH_O_FIXUP_CHAINS__, 6);
+  EXPECT_EQ(sizeof(dyld_chained_fixups_header), 28);
+  EXPECT_EQ(sizeof(dyld_chained_starts_in_segment), 24);
+  EXPECT_EQ(sizeof(dyld_chained_ptr_64_bind), 8);
+  EXPECT_EQ(sizeof(dyld_chained_ptr_arm64e_auth_bind), 8);
+  EXPECT_EQ(sizeof(dyld_chained_ptr_32_rebase), 4);
+  EXPECT_EQ(sizeof(dyld_chained_import), 4);
+  EXPECT_EQ(sizeof(dyld_chained_import_addend), 8);
+  EXPECT_EQ(sizeof(dyld_chained_import_addend64), 16);
+}
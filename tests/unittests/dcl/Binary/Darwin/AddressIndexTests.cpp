@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/AddressIndex.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+using namespace dcl::Binary::Darwin;
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+
+TEST(AddressIndex, find_last_not_greater) {
+  uint64_t keys[] = {10, 20, 30, 40, 50};
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 5, 5), 5);
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 5, 10), 0);
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 5, 29), 1);
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 5, 50), 4);
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 5, 99), 4);
+  EXPECT_EQ(details::FindLastNotGreater<uint64_t>(keys, 0, 99), 0);
+}
+
+TEST(AddressIndex, empty_swift) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  AddressIndex<Target, ByteOrder> index{commands};
+
+  EXPECT_EQ(index.getSegmentCount(), 4);
+  EXPECT_EQ(index.getSectionCount(), 5);
+
+  auto text = index.segmentFor(0x100003fa8);
+  ASSERT_NE(text, nullptr);
+  EXPECT_EQ(text->getVirtualMemoryAddress(), 0x100000000);
+  EXPECT_EQ(index.segmentFor(0x0)->getVirtualMemorySize(), 0x100000000);
+  EXPECT_EQ(index.segmentFor(0x10000c000), nullptr);
+
+  auto textSection = index.sectionFor(0x100003fac);
+  ASSERT_NE(textSection, nullptr);
+  EXPECT_EQ(textSection->getFileOffset(), 0x3fa8);
+  EXPECT_EQ(index.sectionFor(0x100003f00), nullptr);
+  EXPECT_EQ(index.sectionFor(0x100004004)->getFileOffset(), 0x4000);
+
+  uint64_t fileOffset = 0;
+  EXPECT_TRUE(index.vmToFileOffset(0x100004010, fileOffset));
+  EXPECT_EQ(fileOffset, 0x4010);
+  EXPECT_FALSE(index.vmToFileOffset(0x1000, fileOffset));
+  EXPECT_FALSE(index.vmToFileOffset(0x100008300, fileOffset));
+
+  uint64_t address = 0;
+  EXPECT_TRUE(index.fileOffsetToVm(0x8010, address));
+  EXPECT_EQ(address, 0x100008010);
+  EXPECT_TRUE(index.fileOffsetToVm(0x0, address));
+  EXPECT_EQ(address, 0x100000000);
+  EXPECT_FALSE(index.fileOffsetToVm(0x9000, address));
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/Dyld/BindTable.h>
+#include <dcl/Binary/Darwin/Dyld/DyldInfo.h>
+
+#include <iterator>
+#include <vector>
+
+using namespace dcl::Binary::Darwin::Dyld;
+
+// Four segments of a page each.
+static const SegmentSizes kSegments{std::vector<uint64_t>(4, 0x1000)};
+
+// clang-format off
+static const uint8_t kBinds[] = {
+  /* 0x00 */ BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 1,
+  /* 0x01 */ BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'a', 0x00,
+  /* 0x05 */ BIND_OPCODE_SET_TYPE_IMM | BIND_TYPE_POINTER,
+  /* 0x06 */ BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 2, 0x10,
+  /* 0x08 */ BIND_OPCODE_DO_BIND,
+  /* 0x09 */ BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM |
+               BIND_SYMBOL_FLAGS_WEAK_IMPORT, '_', 'b', 0x00,
+  /* 0x0d */ BIND_OPCODE_SET_ADDEND_SLEB, 0x7c,
+  /* 0x0f */ BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB, 0x08,
+  /* 0x11 */ BIND_OPCODE_DO_BIND_ADD_ADDR_IMM_SCALED | 2,
+  /* 0x12 */ BIND_OPCODE_SET_DYLIB_SPECIAL_IMM | 0x0e,
+  /* 0x13 */ BIND_OPCODE_SET_ADDEND_SLEB, 0x00,
+  /* 0x15 */ BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB, 0x03, 0x08,
+  /* 0x18 */ BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB, 0x01,
+  /* 0x1a */ BIND_OPCODE_ADD_ADDR_ULEB, 0x80, 0x01,
+  /* 0x1d */ BIND_OPCODE_DO_BIND,
+  /* 0x1e */ BIND_OPCODE_DONE,
+  /* 0x1f */ BIND_OPCODE_DO_BIND,
+};
+// clang-format on
+
+TEST(BindTable, interprets_every_opcode) {
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  ASSERT_TRUE(interpreter.interpret(
+    kBinds, kBinds + sizeof(kBinds), BindStreamKind::Regular, table));
+  ASSERT_EQ(table.size(), 7);
+  EXPECT_FALSE(table.isThreaded());
+
+  const uint64_t offsets[] = {0x10, 0x18, 0x28, 0x40, 0x50, 0x60, 0xf0};
+  const int64_t addends[] = {0, -4, -4, 0, 0, 0, 0};
+  const int64_t ordinals[] = {1, 1, 1, -2, -2, -2, 1};
+  for (size_t index = 0; index < table.size(); index++) {
+    EXPECT_EQ(table.getSegmentIndex(index), 2);
+    EXPECT_EQ(table.getSegmentOffset(index), offsets[index]) << index;
+    EXPECT_EQ(table.getAddend(index), addends[index]) << index;
+    EXPECT_EQ(table.getLibraryOrdinal(index), ordinals[index]) << index;
+    EXPECT_EQ(table.getType(index), BIND_TYPE_POINTER);
+  }
+  EXPECT_EQ(table.getSymbolName(0), "_a");
+  EXPECT_EQ(table.getSymbolNameOffset(0), 0x02);
+  EXPECT_EQ(table.getSymbolFlags(0), 0);
+  EXPECT_EQ(table.getSymbolName(6), "_b");
+  EXPECT_EQ(table.getSymbolFlags(6), BIND_SYMBOL_FLAGS_WEAK_IMPORT);
+  EXPECT_EQ(table.getLibraryOrdinals(), (std::vector<int64_t>{0, 1, -2}));
+}
+
+TEST(BindTable, lazy_streams_continue_after_done) {
+  // clang-format off
+  const uint8_t lazy[] = {
+    BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0x00,
+    BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 1,
+    BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'x', 0x00,
+    BIND_OPCODE_DO_BIND,
+    BIND_OPCODE_DONE,
+    BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0x08,
+    BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 2,
+    BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'y', 0x00,
+    BIND_OPCODE_DO_BIND,
+    BIND_OPCODE_DONE,
+  };
+  // clang-format on
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  ASSERT_TRUE(interpreter.interpret(
+    lazy, lazy + sizeof(lazy), BindStreamKind::Lazy, table));
+  ASSERT_EQ(table.size(), 2);
+  EXPECT_EQ(table.getSymbolName(1), "_y");
+  EXPECT_EQ(table.getSegmentOffset(1), 0x08);
+  EXPECT_EQ(table.getLibraryOrdinal(1), 2);
+}
+
+TEST(BindTable, threaded) {
+  // clang-format off
+  const uint8_t threaded[] = {
+    BIND_OPCODE_THREADED |
+      BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB, 0x02,
+    BIND_OPCODE_SET_DYLIB_ORDINAL_IMM | 1,
+    BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'x', 0x00,
+    BIND_OPCODE_DO_BIND,
+    BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM, '_', 'y', 0x00,
+    BIND_OPCODE_DO_BIND,
+    BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 3, 0x20,
+    BIND_OPCODE_THREADED | BIND_SUBOPCODE_THREADED_APPLY,
+    BIND_OPCODE_DONE,
+  };
+  // clang-format on
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  ASSERT_TRUE(interpreter.interpret(
+    threaded, threaded + sizeof(threaded), BindStreamKind::Regular, table));
+  EXPECT_TRUE(table.isThreaded());
+  ASSERT_EQ(table.size(), 2);
+  EXPECT_EQ(table.getSymbolName(0), "_x");
+  EXPECT_EQ(table.getSymbolName(1), "_y");
+  ASSERT_EQ(table.getThreadedChainStartCount(), 1);
+  EXPECT_EQ(table.getThreadedChainStartSegmentIndex(0), 3);
+  EXPECT_EQ(table.getThreadedChainStartSegmentOffset(0), 0x20);
+}
+
+TEST(BindTable, rejects_bind_without_symbol) {
+  const uint8_t binds[] = {BIND_OPCODE_DO_BIND, BIND_OPCODE_DONE};
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  EXPECT_FALSE(interpreter.interpret(
+    binds, binds + sizeof(binds), BindStreamKind::Regular, table));
+  EXPECT_TRUE(table.empty());
+}
+
+TEST(BindTable, rejects_malformed_operands) {
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  auto interpret = [&](std::vector<uint8_t> binds) {
+    return interpreter.interpret(
+      binds.data(),
+      binds.data() + binds.size(),
+      BindStreamKind::Regular,
+      table);
+  };
+  const uint8_t symbol = BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM;
+
+  // Numbers that run past the end of the stream.
+  EXPECT_FALSE(interpret({BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB, 0x80}));
+  EXPECT_FALSE(interpret({BIND_OPCODE_SET_ADDEND_SLEB, 0xFF}));
+  EXPECT_FALSE(interpret({BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB, 0x80}));
+  EXPECT_FALSE(interpret({BIND_OPCODE_ADD_ADDR_ULEB, 0x80, 0x80}));
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_DO_BIND_ADD_ADDR_ULEB, 0x80}));
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB,
+     0x01, 0x80}));
+  EXPECT_FALSE(interpret(
+    {BIND_OPCODE_THREADED |
+       BIND_SUBOPCODE_THREADED_SET_BIND_ORDINAL_TABLE_SIZE_ULEB,
+     0x80}));
+
+  // One opcode asking for 2^63 binds.
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB,
+     0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0x00}));
+  EXPECT_TRUE(table.empty());
+}
+
+TEST(BindTable, rejects_binds_out_of_their_segment) {
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  auto interpret = [&](std::vector<uint8_t> binds) {
+    return interpreter.interpret(
+      binds.data(),
+      binds.data() + binds.size(),
+      BindStreamKind::Regular,
+      table);
+  };
+  const uint8_t symbol = BIND_OPCODE_SET_SYMBOL_TRAILING_FLAGS_IMM;
+
+  // The last pointer of a segment, and the one past it.
+  EXPECT_TRUE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1,
+     0xF8, 0x1F, BIND_OPCODE_DO_BIND}));
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1,
+     0xF8, 0x1F, BIND_OPCODE_DO_BIND, BIND_OPCODE_DO_BIND}));
+  EXPECT_EQ(table.size(), 1);
+
+  // A segment the image does not have.
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 4,
+     0x00, BIND_OPCODE_DO_BIND}));
+
+  // One opcode asking for 2^29 binds, which fails before recording any.
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB,
+     0x80, 0x80, 0x80, 0x80, 0x02, 0x00}));
+  EXPECT_TRUE(table.empty());
+
+  // A run whose skips take it out of the segment.
+  EXPECT_FALSE(interpret(
+    {symbol, '_', 'a', 0x00, BIND_OPCODE_DO_BIND_ULEB_TIMES_SKIPPING_ULEB,
+     0x02, 0x80, 0x20}));
+  EXPECT_TRUE(table.empty());
+}
+
+TEST(BindTable, rejects_too_many_library_ordinals) {
+  std::vector<uint8_t> binds;
+  for (uint32_t ordinal = 1; ordinal <= 0x10000; ordinal++) {
+    binds.push_back(BIND_OPCODE_SET_DYLIB_ORDINAL_ULEB);
+    uint32_t value = ordinal;
+    do {
+      binds.push_back((value & 0x7F) | (value >= 0x80 ? 0x80 : 0));
+      value >>= 7;
+    } while (value != 0);
+  }
+  BindOpcodeInterpreter interpreter{8, kSegments};
+  BindTable table;
+  // Ordinal 0 and the first 0xFFFF others take every index.
+  EXPECT_FALSE(interpreter.interpret(
+    binds.data(), binds.data() + binds.size(), BindStreamKind::Regular, table));
+  EXPECT_EQ(table.getLibraryOrdinals().size(), 0x10000);
+}
+
+TEST(BindOpcodeIterator, skips_operands) {
+  BindOpcodeStream stream{kBinds, kBinds + 0x1f};
+  EXPECT_EQ(std::distance(stream.begin(), stream.end()), 16);
+}
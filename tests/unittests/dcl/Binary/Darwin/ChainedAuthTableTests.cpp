@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include "ChainedFixupsTestSupport.h"
+
+#include <dcl/Binary/Darwin/Dyld/ChainedAuthTable.h>
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupApplier.h>
+#include <dcl/Binary/Darwin/Dyld/DyldFixupChains.h>
+
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Dyld;
+using namespace dcl::Binary::Darwin::Dyld::Testing;
+
+using Applier = ChainedFixupApplier<Target, ByteOrder>;
+
+static const uint64_t kAuth = uint64_t(1) << 63;
+
+static const uint64_t kBind = uint64_t(1) << 62;
+
+static uint64_t MakeAuthBits(
+  uint16_t diversity, bool hasAddressDiversity, PointerAuthKey key) {
+  return kAuth | (uint64_t(diversity) << 32) |
+         (uint64_t(hasAddressDiversity) << 48) | (uint64_t(key) << 49);
+}
+
+static uint64_t MakeNext(uint64_t next) { return next << 51; }
+
+// A `DYLD_CHAINED_PTR_ARM64E` payload for a single segment of two pages.
+static std::vector<uint64_t> MakeArm64ePayload() {
+  return MakePayload(DYLD_CHAINED_PTR_ARM64E, kPageSize, 0, {0x00, 0x08}, 2);
+}
+
+static std::vector<uint64_t> MakeImage() {
+  std::vector<uint64_t> image(32);
+  image[16] =
+    0x3000 | MakeAuthBits(0x1234, true, PointerAuthKey::DA) | MakeNext(1);
+  image[17] = 0x100004000 | (uint64_t(0x80) << 43) | MakeNext(1);
+  image[18] = 1 | kBind | MakeAuthBits(0x55, false, PointerAuthKey::IB);
+  image[25] = 0x10 | MakeAuthBits(0, false, PointerAuthKey::IA);
+  return image;
+}
+
+TEST(ChainedAuthTable, collects_authenticated_pointers) {
+  auto payload = MakeArm64ePayload();
+  auto image = MakeImage();
+  Walker walker = MakeWalker(payload, image);
+
+  ChainedAuthTable table;
+  ASSERT_TRUE(table.build(walker));
+  ASSERT_EQ(table.size(), 3);
+
+  EXPECT_EQ(table[0].segmentOffset, 0x00);
+  EXPECT_FALSE(table[0].isBind);
+  EXPECT_EQ(table[0].target, 0x3000);
+  EXPECT_EQ(table[0].diversity, 0x1234);
+  EXPECT_TRUE(table[0].hasAddressDiversity);
+  EXPECT_EQ(table[0].key, PointerAuthKey::DA);
+
+  EXPECT_EQ(table[1].segmentOffset, 0x10);
+  EXPECT_TRUE(table[1].isBind);
+  EXPECT_EQ(table[1].target, 1);
+  EXPECT_EQ(table[1].diversity, 0x55);
+  EXPECT_FALSE(table[1].hasAddressDiversity);
+  EXPECT_EQ(table[1].key, PointerAuthKey::IB);
+
+  EXPECT_EQ(table[2].segmentOffset, kPageSize + 0x08);
+  EXPECT_EQ(table[2].key, PointerAuthKey::IA);
+
+  EXPECT_EQ(table.find(0, 0x10), &table[1]);
+  EXPECT_EQ(table.find(0, 0x08), nullptr);
+  EXPECT_EQ(table.find(1, 0x00), nullptr);
+}
+
+TEST(ChainedAuthTable, discriminators) {
+  ChainedAuthEntry entry{};
+  entry.diversity = 0x1234;
+  EXPECT_EQ(entry.getDiscriminator(0xABCD000200004000), 0x1234);
+  entry.hasAddressDiversity = true;
+  EXPECT_EQ(entry.getDiscriminator(0xABCD000200004000), 0x1234000200004000);
+}
+
+TEST(ChainedAuthTable, binds_without_signing) {
+  uint64_t raw = 1 | kBind | MakeAuthBits(0x55, true, PointerAuthKey::IA);
+  const void * const addresses[] = {
+    reinterpret_cast<const void *>(0x7000),
+    reinterpret_cast<const void *>(0x9000)};
+  auto pointer = reinterpret_cast<ChainedPointerArm64EAuthBind *>(&raw);
+  EXPECT_EQ(pointer->getOrdinal(), 1);
+  EXPECT_EQ(ChainedPointerArm64EAuthBind::bind(pointer, addresses), 0x9000);
+  EXPECT_EQ(raw, 0x9000);
+}
+
+TEST(ChainedAuthTable, applier_strips_authenticated_pointers) {
+  auto payload = MakeArm64ePayload();
+  auto image = MakeImage();
+  Walker walker = MakeWalker(payload, image);
+  Applier applier{walker, image.data(), kLoadAddress};
+  const uint64_t targets[] = {0x7000, 0x9000};
+  applier.setBindTargets(targets, 2);
+  ASSERT_TRUE(applier.stripsAuthenticatedPointers());
+
+  std::vector<uint64_t> stripped = image;
+  ASSERT_TRUE(applier.apply(stripped.data(), 1));
+  EXPECT_EQ(stripped[16], kLoadAddress + 0x3000);
+  EXPECT_EQ(stripped[17], (kLoadAddress + 0x4000) | (uint64_t(0x80) << 56));
+  EXPECT_EQ(stripped[18], 0x9000);
+  EXPECT_EQ(stripped[25], kLoadAddress + 0x10);
+
+  applier.setStripsAuthenticatedPointers(false);
+  std::vector<uint64_t> kept = image;
+  ASSERT_TRUE(applier.apply(kept.data(), 1));
+  EXPECT_EQ(kept[16], image[16]);
+  EXPECT_EQ(kept[17], stripped[17]);
+  EXPECT_EQ(kept[18], image[18]);
+  EXPECT_EQ(kept[25], image[25]);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "ChainedFixupsTestSupport.h"
+
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupApplier.h>
+
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Dyld;
+using namespace dcl::Binary::Darwin::Dyld::Testing;
+
+using Applier = ChainedFixupApplier<Target, ByteOrder>;
+
+// A `DYLD_CHAINED_PTR_64` payload for a single segment.
+static std::vector<uint64_t>
+MakePayload64(const std::vector<uint16_t>& pageStarts) {
+  return MakePayload(
+    DYLD_CHAINED_PTR_64,
+    kPageSize,
+    0,
+    pageStarts,
+    static_cast<uint16_t>(pageStarts.size()));
+}
+
+TEST(ChainedFixupApplier, rebases_and_binds_a_copy) {
+  auto payload =
+    MakePayload64({0x00, 0x10, DYLD_CHAINED_PTR_START_NONE, 0x00});
+  std::vector<uint64_t> image(48);
+  image[16] = 0x100001000 | (uint64_t(0x80) << 36) | (uint64_t(2) << 51);
+  image[17] = (uint64_t(1) << 63) | 1 | (uint64_t(4) << 24);
+  image[26] = 0x100002000;
+  image[40] = uint64_t(1) << 63;
+  const std::vector<uint64_t> original = image;
+
+  Walker walker = MakeWalker(payload, image);
+  Applier applier{walker, image.data(), kLoadAddress};
+  ASSERT_EQ(applier.getPageCount(), 3);
+  const uint64_t targets[] = {0x7000, 0x9000};
+  applier.setBindTargets(targets, 2);
+
+  for (unsigned threadCount : {1u, 4u}) {
+    std::vector<uint64_t> copy = image;
+    ASSERT_TRUE(applier.apply(copy.data(), threadCount));
+    EXPECT_EQ(copy[16], (kLoadAddress + 0x1000) | (uint64_t(0x80) << 56));
+    EXPECT_EQ(copy[17], 0x9004);
+    EXPECT_EQ(copy[26], kLoadAddress + 0x2000);
+    EXPECT_EQ(copy[40], 0x7000);
+  }
+  EXPECT_EQ(image, original);
+}
+
+TEST(ChainedFixupApplier, fails_on_missing_bind_targets) {
+  auto payload = MakePayload64({0x00});
+  std::vector<uint64_t> image(24);
+  image[16] = (uint64_t(1) << 63) | 3;
+
+  Walker walker = MakeWalker(payload, image);
+  Applier applier{walker, image.data(), kLoadAddress};
+  const uint64_t targets[] = {0x7000};
+  applier.setBindTargets(targets, 1);
+  std::vector<uint64_t> copy = image;
+  EXPECT_FALSE(applier.apply(copy.data(), 2));
+}
+
+TEST(ChainedFixupApplier, threads_agree_with_serial_application) {
+  const size_t pageCount = 512;
+  const size_t wordsPerPage = kPageSize / sizeof(uint64_t);
+  auto payload = MakePayload64(std::vector<uint16_t>(pageCount, 0x00));
+  std::vector<uint64_t> image(16 + pageCount * wordsPerPage);
+  for (size_t page = 0; page < pageCount; page++) {
+    for (size_t word = 0; word < wordsPerPage; word++) {
+      uint64_t next = word + 1 < wordsPerPage ? 2 : 0;
+      image[16 + page * wordsPerPage + word] =
+        (kPreferredLoadAddress + page * kPageSize + word) | (next << 51);
+    }
+  }
+
+  Walker walker = MakeWalker(payload, image);
+  Applier applier{walker, image.data(), kLoadAddress};
+  std::vector<uint64_t> serial = image;
+  std::vector<uint64_t> parallel = image;
+  ASSERT_TRUE(applier.apply(serial.data(), 1));
+  ASSERT_TRUE(applier.apply(parallel.data(), 8));
+  EXPECT_EQ(serial, parallel);
+  EXPECT_EQ(
+    serial[16 + 3 * wordsPerPage + 5], kLoadAddress + 3 * kPageSize + 5);
+}
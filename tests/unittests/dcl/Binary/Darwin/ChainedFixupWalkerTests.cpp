@@ -0,0 +1,293 @@
+#include <gtest/gtest.h>
+
+#include "ChainedFixupsTestSupport.h"
+
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupWalker.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/IO/File.h>
+
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Dyld;
+using namespace dcl::Binary::Darwin::Dyld::Testing;
+
+// Only the second segment has fixups.
+static const uint32_t kSegmentIndex = 1;
+
+static std::vector<ChainedFixup> Walk(
+  const std::vector<uint64_t>& payload,
+  const void * segment,
+  uint64_t segmentSize,
+  bool * isValid = nullptr) {
+  auto begin = reinterpret_cast<const uint8_t *>(payload.data());
+  Walker walker{
+    begin,
+    begin + payload.size() * sizeof(uint64_t),
+    {{nullptr, 0},
+     {static_cast<const uint8_t *>(segment), segmentSize}},
+    kPreferredLoadAddress};
+  std::vector<ChainedFixup> fixups;
+  bool result = walker.forEach(
+    [&](const ChainedFixup& fixup) { fixups.push_back(fixup); });
+  if (isValid) {
+    *isValid = result;
+  }
+  return fixups;
+}
+
+TEST(ChainedFixupWalker, generic64) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_64,
+    0x40,
+    0,
+    {0x08, 0x00, DYLD_CHAINED_PTR_START_NONE},
+    3,
+    kSegmentIndex);
+  uint64_t segment[24] = {};
+  segment[1] = 0x100001000 | (uint64_t(0x80) << 36) | (uint64_t(2) << 51);
+  segment[2] = (uint64_t(1) << 63) | 3 | (uint64_t(5) << 24);
+  segment[8] = 0x100002000;
+  segment[16] = 0x100003000;
+
+  bool isValid = false;
+  auto fixups = Walk(payload, segment, sizeof(segment), &isValid);
+  ASSERT_TRUE(isValid);
+  ASSERT_EQ(fixups.size(), 3);
+
+  EXPECT_EQ(fixups[0].kind, ChainedFixupKind::Rebase);
+  EXPECT_EQ(fixups[0].segmentIndex, 1);
+  EXPECT_EQ(fixups[0].segmentOffset, 0x08);
+  EXPECT_EQ(fixups[0].target, 0x1000);
+  EXPECT_EQ(fixups[0].high8, 0x80);
+
+  EXPECT_EQ(fixups[1].kind, ChainedFixupKind::Bind);
+  EXPECT_EQ(fixups[1].segmentOffset, 0x10);
+  EXPECT_EQ(fixups[1].ordinal, 3);
+  EXPECT_EQ(fixups[1].addend, 5);
+
+  EXPECT_EQ(fixups[2].segmentOffset, 0x40);
+  EXPECT_EQ(fixups[2].target, 0x2000);
+}
+
+TEST(ChainedFixupWalker, arm64e) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_ARM64E,
+    0x100,
+    0,
+    {0x00},
+    1,
+    kSegmentIndex);
+  uint64_t segment[8] = {};
+  // Authenticated rebase, key DA with address diversity.
+  segment[0] = (uint64_t(1) << 63) | 0x2000 | (uint64_t(0x1234) << 32) |
+               (uint64_t(1) << 48) | (uint64_t(2) << 49) | (uint64_t(1) << 51);
+  // Bind with a negative addend.
+  segment[1] = (uint64_t(1) << 62) | 7 | (uint64_t(0x7FFFC) << 32) |
+               (uint64_t(1) << 51);
+  // Authenticated bind.
+  segment[2] = (uint64_t(3) << 62) | 9 | (uint64_t(1) << 49) |
+               (uint64_t(2) << 51);
+  segment[4] = 0x100003000 | (uint64_t(0x12) << 43);
+
+  bool isValid = false;
+  auto fixups = Walk(payload, segment, sizeof(segment), &isValid);
+  ASSERT_TRUE(isValid);
+  ASSERT_EQ(fixups.size(), 4);
+
+  EXPECT_EQ(fixups[0].kind, ChainedFixupKind::Rebase);
+  EXPECT_TRUE(fixups[0].isAuth);
+  EXPECT_EQ(fixups[0].target, 0x2000);
+  EXPECT_EQ(fixups[0].diversity, 0x1234);
+  EXPECT_TRUE(fixups[0].hasAddressDiversity);
+  EXPECT_EQ(fixups[0].key, 2);
+
+  EXPECT_EQ(fixups[1].kind, ChainedFixupKind::Bind);
+  EXPECT_FALSE(fixups[1].isAuth);
+  EXPECT_EQ(fixups[1].segmentOffset, 0x08);
+  EXPECT_EQ(fixups[1].ordinal, 7);
+  EXPECT_EQ(fixups[1].addend, -4);
+
+  EXPECT_EQ(fixups[2].kind, ChainedFixupKind::Bind);
+  EXPECT_TRUE(fixups[2].isAuth);
+  EXPECT_EQ(fixups[2].ordinal, 9);
+  EXPECT_EQ(fixups[2].key, 1);
+  EXPECT_EQ(fixups[2].addend, 0);
+
+  EXPECT_EQ(fixups[3].segmentOffset, 0x20);
+  EXPECT_EQ(fixups[3].target, 0x3000);
+  EXPECT_EQ(fixups[3].high8, 0x12);
+}
+
+TEST(ChainedFixupWalker, arm64e_userland24) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_ARM64E_USERLAND24,
+    0x100,
+    0,
+    {0x00},
+    1,
+    kSegmentIndex);
+  uint64_t segment[4] = {};
+  segment[0] = 0x3000 | (uint64_t(1) << 51);
+  segment[1] = (uint64_t(1) << 62) | 0x123456;
+
+  auto fixups = Walk(payload, segment, sizeof(segment));
+  ASSERT_EQ(fixups.size(), 2);
+  // Userland targets are offsets already.
+  EXPECT_EQ(fixups[0].target, 0x3000);
+  EXPECT_EQ(fixups[1].ordinal, 0x123456);
+}
+
+TEST(ChainedFixupWalker, generic32_with_multiple_chains) {
+  const uint32_t maxValidPointer = 0x100000;
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_32,
+    0x40,
+    maxValidPointer,
+    {DYLD_CHAINED_PTR_START_MULTI | 1,
+     0x00,
+     0x0c | DYLD_CHAINED_PTR_START_LAST},
+    1,
+    kSegmentIndex);
+  const uint32_t bias = (0x04000000 + maxValidPointer) / 2;
+  uint32_t segment[16] = {};
+  segment[0] = 0x1000 | (1 << 26);
+  segment[1] = bias + 5;
+  segment[3] = (1u << 31) | 2 | (1 << 20);
+
+  bool isValid = false;
+  auto fixups = Walk(payload, segment, sizeof(segment), &isValid);
+  ASSERT_TRUE(isValid);
+  ASSERT_EQ(fixups.size(), 3);
+  EXPECT_EQ(fixups[0].kind, ChainedFixupKind::Rebase);
+  EXPECT_EQ(fixups[0].target, 0x1000 - kPreferredLoadAddress);
+  EXPECT_EQ(fixups[1].kind, ChainedFixupKind::NonPointer);
+  EXPECT_EQ(fixups[1].segmentOffset, 0x04);
+  EXPECT_EQ(fixups[1].target, 5);
+  EXPECT_EQ(fixups[2].kind, ChainedFixupKind::Bind);
+  EXPECT_EQ(fixups[2].segmentOffset, 0x0c);
+  EXPECT_EQ(fixups[2].ordinal, 2);
+  EXPECT_EQ(fixups[2].addend, 1);
+}
+
+TEST(ChainedFixupWalker, kernel_cache_strides) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_X86_64_KERNEL_CACHE,
+    0x100,
+    0,
+    {0x00},
+    1,
+    kSegmentIndex);
+  uint8_t segment[24] = {};
+  const uint64_t first = 0x4000 | (uint64_t(1) << 30) | (uint64_t(9) << 51);
+  const uint64_t second = (uint64_t(1) << 63) | 0x5000 | (uint64_t(7) << 32);
+  std::memcpy(segment, &first, sizeof(first));
+  std::memcpy(segment + 9, &second, sizeof(second));
+
+  auto fixups = Walk(payload, segment, sizeof(segment));
+  ASSERT_EQ(fixups.size(), 2);
+  EXPECT_EQ(fixups[0].target, 0x4000);
+  EXPECT_EQ(fixups[0].cacheLevel, 1);
+  EXPECT_EQ(fixups[1].segmentOffset, 9);
+  EXPECT_TRUE(fixups[1].isAuth);
+  EXPECT_EQ(fixups[1].diversity, 7);
+}
+
+TEST(ChainedFixupWalker, generic32_cache_and_firmware) {
+  uint32_t segment[4] = {};
+  segment[0] = 0x1000 | (1u << 30);
+  segment[1] = 0x2000;
+  auto fixups = Walk(
+    MakePayload(DYLD_CHAINED_PTR_32_CACHE, 0x100, 0, {0x00}, 1, kSegmentIndex),
+    segment,
+    sizeof(segment));
+  ASSERT_EQ(fixups.size(), 2);
+  EXPECT_EQ(fixups[1].target, 0x2000);
+
+  segment[0] = 0x1000 | (2u << 26);
+  segment[2] = 0x3000;
+  fixups = Walk(
+    MakePayload(
+      DYLD_CHAINED_PTR_32_FIRMWARE,
+      0x100,
+      0,
+      {0x00},
+      1,
+      kSegmentIndex),
+    segment,
+    sizeof(segment));
+  ASSERT_EQ(fixups.size(), 2);
+  EXPECT_EQ(fixups[1].segmentOffset, 0x08);
+  EXPECT_EQ(fixups[1].target, 0x3000 - kPreferredLoadAddress);
+}
+
+TEST(ChainedFixupWalker, single_page) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_64_OFFSET,
+    0x40,
+    0,
+    {0x00, 0x08},
+    2,
+    kSegmentIndex);
+  uint64_t segment[16] = {};
+  segment[0] = 0x1000;
+  segment[9] = 0x2000;
+  auto begin = reinterpret_cast<const uint8_t *>(payload.data());
+  Walker walker{
+    begin,
+    begin + payload.size() * sizeof(uint64_t),
+    {{nullptr, 0},
+     {reinterpret_cast<const uint8_t *>(segment), sizeof(segment)}},
+    kPreferredLoadAddress};
+  ASSERT_EQ(walker.getSegmentCount(), 2);
+  EXPECT_EQ(walker.getStartsInSegment(0), nullptr);
+
+  std::vector<uint64_t> offsets;
+  ASSERT_TRUE(walker.forEachInPage(1, 1, [&](const ChainedFixup& fixup) {
+    offsets.push_back(fixup.segmentOffset);
+    EXPECT_EQ(fixup.target, 0x2000);
+  }));
+  EXPECT_EQ(offsets, (std::vector<uint64_t>{0x48}));
+}
+
+TEST(ChainedFixupWalker, rejects_malformed_chains) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_PTR_64,
+    0x40,
+    0,
+    {0x00},
+    1,
+    kSegmentIndex);
+  uint64_t segment[2] = {};
+  segment[0] = uint64_t(4) << 51;
+
+  bool isValid = true;
+  auto fixups = Walk(payload, segment, sizeof(segment), &isValid);
+  EXPECT_FALSE(isValid);
+  EXPECT_EQ(fixups.size(), 1);
+
+  // The page count must fit in the starts.
+  payload = MakePayload(DYLD_CHAINED_PTR_64, 0x40, 0, {0x00}, 2, kSegmentIndex);
+  auto begin = reinterpret_cast<const uint8_t *>(payload.data());
+  Walker walker{
+    begin, begin + payload.size() * sizeof(uint64_t), {}, 0};
+  EXPECT_TRUE(walker.empty());
+
+  Walker truncated{begin, begin + 16, {}, 0};
+  EXPECT_TRUE(truncated.empty());
+}
+
+TEST(ChainedFixupWalker, empty_swift) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  Walker walker{commands, file.getSize()};
+  ASSERT_FALSE(walker.empty());
+  EXPECT_EQ(walker.getPreferredLoadAddress(), 0x100000000);
+  EXPECT_EQ(walker.getSegmentCount(), 4);
+
+  size_t count = 0;
+  EXPECT_TRUE(walker.forEach([&](const ChainedFixup&) { count++; }));
+  EXPECT_EQ(count, 0);
+}
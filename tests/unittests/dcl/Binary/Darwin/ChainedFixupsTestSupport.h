@@ -0,0 +1,83 @@
+#ifndef DCL_TESTS_BINARY_DARWIN_CHAINEDFIXUPSTESTSUPPORT_H
+#define DCL_TESTS_BINARY_DARWIN_CHAINEDFIXUPSTESTSUPPORT_H
+
+#include <dcl/Binary/Darwin/Dyld/ChainedFixupWalker.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dcl::Binary::Darwin::Dyld::Testing {
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+using Walker = ChainedFixupWalker<Target, ByteOrder>;
+
+static const uint64_t kPreferredLoadAddress = 0x100000000;
+
+static const uint64_t kLoadAddress = 0x200000000;
+
+static const uint16_t kPageSize = 0x40;
+
+/// Builds a `LC_DYLD_CHAINED_FIXUPS` payload whose only fixups are in the
+/// segment at `segmentIndex`; the segments before it have none.
+inline std::vector<uint64_t> MakePayload(
+  uint16_t format,
+  uint16_t pageSize,
+  uint32_t maxValidPointer,
+  const std::vector<uint16_t>& pageStarts,
+  uint16_t pageCount,
+  uint32_t segmentIndex = 0) {
+  const uint32_t segmentCount = segmentIndex + 1;
+  const uint32_t imageSize = (segmentCount + 1) * sizeof(uint32_t);
+  const uint32_t startsOffset = (32 + imageSize + 7) & ~uint32_t(7);
+  std::vector<uint64_t> words(startsOffset / 8 + 10 + pageStarts.size());
+  auto bytes = reinterpret_cast<uint8_t *>(words.data());
+
+  dyld_chained_fixups_header header{};
+  header.starts_offset = 32;
+  std::memcpy(bytes, &header, sizeof(header));
+
+  std::vector<uint32_t> startsInImage(segmentCount + 1);
+  startsInImage[0] = segmentCount;
+  startsInImage[segmentCount] = startsOffset - 32;
+  std::memcpy(bytes + 32, startsInImage.data(), imageSize);
+
+  dyld_chained_starts_in_segment starts{};
+  starts.size = static_cast<uint32_t>(
+    offsetof(dyld_chained_starts_in_segment, page_start) +
+    pageStarts.size() * sizeof(uint16_t));
+  starts.page_size = pageSize;
+  starts.pointer_format = format;
+  starts.max_valid_pointer = maxValidPointer;
+  starts.page_count = pageCount;
+  std::memcpy(
+    bytes + startsOffset,
+    &starts,
+    offsetof(dyld_chained_starts_in_segment, page_start));
+  std::memcpy(
+    bytes + startsOffset +
+      offsetof(dyld_chained_starts_in_segment, page_start),
+    pageStarts.data(),
+    pageStarts.size() * sizeof(uint16_t));
+  return words;
+}
+
+/// Walks `payload` over a single segment that starts 0x80 bytes into
+/// `image`.
+inline Walker MakeWalker(
+  const std::vector<uint64_t>& payload, const std::vector<uint64_t>& image) {
+  auto begin = reinterpret_cast<const uint8_t *>(payload.data());
+  auto segment = reinterpret_cast<const uint8_t *>(image.data()) + 0x80;
+  return Walker{
+    begin,
+    begin + payload.size() * sizeof(uint64_t),
+    {{segment, image.size() * sizeof(uint64_t) - 0x80}},
+    kPreferredLoadAddress};
+}
+
+} // namespace dcl::Binary::Darwin::Dyld::Testing
+
+#endif // DCL_TESTS_BINARY_DARWIN_CHAINEDFIXUPSTESTSUPPORT_H
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/Dyld/ChainedImportTable.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if DCL_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Dyld;
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+using Decoder = ChainedImportDecoder<Target, ByteOrder>;
+
+static const char kSymbols[] = "\0_a\0_bb";
+
+static std::vector<uint8_t> MakePayload(
+  uint32_t importsFormat,
+  const std::vector<uint8_t>& imports,
+  uint32_t importsCount,
+  const std::string& symbols,
+  uint32_t symbolsFormat = 0) {
+  dyld_chained_fixups_header header{};
+  header.imports_offset = sizeof(header);
+  header.symbols_offset =
+    static_cast<uint32_t>(sizeof(header) + imports.size());
+  header.imports_count = importsCount;
+  header.imports_format = importsFormat;
+  header.symbols_format = symbolsFormat;
+
+  std::vector<uint8_t> payload(sizeof(header));
+  std::memcpy(payload.data(), &header, sizeof(header));
+  payload.insert(payload.end(), imports.begin(), imports.end());
+  payload.insert(payload.end(), symbols.begin(), symbols.end());
+  return payload;
+}
+
+template <typename Record>
+static void Append(std::vector<uint8_t>& bytes, const Record& record) {
+  auto begin = reinterpret_cast<const uint8_t *>(&record);
+  bytes.insert(bytes.end(), begin, begin + sizeof(record));
+}
+
+static bool
+Decode(const std::vector<uint8_t>& payload, ChainedImportTable& table) {
+  return Decoder{}.decode(
+    payload.data(), payload.data() + payload.size(), table);
+}
+
+static std::vector<uint8_t> MakeGenericImports() {
+  std::vector<uint8_t> imports;
+  Append(imports, dyld_chained_import{1, 0, 1});
+  Append(imports, dyld_chained_import{0xFE, 1, 4});
+  return imports;
+}
+
+TEST(ChainedImportTable, generic) {
+  auto payload = MakePayload(
+    DYLD_CHAINED_IMPORT,
+    MakeGenericImports(),
+    2,
+    std::string{kSymbols, sizeof(kSymbols)});
+  ChainedImportTable table;
+  ASSERT_TRUE(Decode(payload, table));
+  ASSERT_EQ(table.size(), 2);
+  EXPECT_FALSE(table.isInflated());
+
+  EXPECT_EQ(table[0].libraryOrdinal, 1);
+  EXPECT_FALSE(table[0].isWeak);
+  EXPECT_EQ(table[0].addend, 0);
+  EXPECT_EQ(table.getName(0), "_a");
+
+  EXPECT_EQ(table[1].libraryOrdinal, BIND_SPECIAL_DYLIB_FLAT_LOOKUP);
+  EXPECT_TRUE(table[1].isWeak);
+  EXPECT_EQ(table.getName(1), "_bb");
+}
+
+TEST(ChainedImportTable, addends) {
+  std::vector<uint8_t> imports;
+  Append(imports, dyld_chained_import_addend{2, 0, 1, -8});
+  auto payload = MakePayload(
+    DYLD_CHAINED_IMPORT_ADDEND,
+    imports,
+    1,
+    std::string{kSymbols, sizeof(kSymbols)});
+  ChainedImportTable table;
+  ASSERT_TRUE(Decode(payload, table));
+  ASSERT_EQ(table.size(), 1);
+  EXPECT_EQ(table[0].libraryOrdinal, 2);
+  EXPECT_EQ(table[0].addend, -8);
+  EXPECT_EQ(table.getName(0), "_a");
+
+  imports.clear();
+  Append(imports, dyld_chained_import_addend64{0xFFFF, 1, 0, 4, 1ull << 32});
+  payload = MakePayload(
+    DYLD_CHAINED_IMPORT_ADDEND64,
+    imports,
+    1,
+    std::string{kSymbols, sizeof(kSymbols)});
+  ASSERT_TRUE(Decode(payload, table));
+  ASSERT_EQ(table.size(), 1);
+  EXPECT_EQ(table[0].libraryOrdinal, BIND_SPECIAL_DYLIB_MAIN_EXECUTABLE);
+  EXPECT_TRUE(table[0].isWeak);
+  EXPECT_EQ(table[0].addend, int64_t(1) << 32);
+  EXPECT_EQ(table.getName(0), "_bb");
+}
+
+TEST(ChainedImportTable, rejects_malformed_payloads) {
+  ChainedImportTable table;
+  // A name past the end of the symbol pool.
+  std::vector<uint8_t> imports;
+  Append(imports, dyld_chained_import{1, 0, 64});
+  ASSERT_FALSE(Decode(
+    MakePayload(DYLD_CHAINED_IMPORT, imports, 1, std::string{"\0_a", 4}),
+    table));
+  EXPECT_TRUE(table.empty());
+
+  // More imports than records.
+  EXPECT_FALSE(Decode(
+    MakePayload(
+      DYLD_CHAINED_IMPORT,
+      MakeGenericImports(),
+      3,
+      std::string{kSymbols, sizeof(kSymbols)}),
+    table));
+
+  EXPECT_FALSE(Decode(
+    MakePayload(
+      4, MakeGenericImports(), 2, std::string{kSymbols, sizeof(kSymbols)}),
+    table));
+}
+
+#if DCL_HAS_ZLIB
+TEST(ChainedImportTable, inflates_compressed_symbols) {
+  // Long enough to need the arena to grow while inflating.
+  std::string symbols{kSymbols, sizeof(kSymbols)};
+  symbols += std::string(4096, 'x');
+  symbols.push_back('\0');
+
+  std::vector<uint8_t> compressed(compressBound(symbols.size()));
+  uLongf compressedSize = compressed.size();
+  ASSERT_EQ(
+    compress(
+      compressed.data(),
+      &compressedSize,
+      reinterpret_cast<const Bytef *>(symbols.data()),
+      symbols.size()),
+    Z_OK);
+  compressed.resize(compressedSize);
+
+  std::vector<uint8_t> imports = MakeGenericImports();
+  Append(imports, dyld_chained_import{3, 0, sizeof(kSymbols)});
+  auto payload = MakePayload(
+    DYLD_CHAINED_IMPORT,
+    imports,
+    3,
+    std::string{compressed.begin(), compressed.end()},
+    1);
+
+  ChainedImportTable table;
+  ASSERT_TRUE(Decode(payload, table));
+  EXPECT_TRUE(table.isInflated());
+  ASSERT_EQ(table.size(), 3);
+  EXPECT_EQ(table.getName(1), "_bb");
+  EXPECT_EQ(table.getName(2), std::string(4096, 'x'));
+
+  // A truncated stream cannot be inflated.
+  payload.resize(payload.size() - 4);
+  EXPECT_FALSE(Decode(payload, table));
+}
+
+TEST(ChainedImportTable, rejects_symbol_pools_inflating_too_far) {
+  // A megabyte of nulls deflates about a thousand times over.
+  std::string symbols(1 << 20, '\0');
+  std::vector<uint8_t> compressed(compressBound(symbols.size()));
+  uLongf compressedSize = compressed.size();
+  ASSERT_EQ(
+    compress2(
+      compressed.data(),
+      &compressedSize,
+      reinterpret_cast<const Bytef *>(symbols.data()),
+      symbols.size(),
+      Z_BEST_COMPRESSION),
+    Z_OK);
+  ASSERT_LT(compressedSize * Decoder::kMaxInflationRatio, symbols.size());
+  compressed.resize(compressedSize);
+
+  std::vector<uint8_t> imports;
+  Append(imports, dyld_chained_import{1, 0, 0});
+  ChainedImportTable table;
+  EXPECT_FALSE(Decode(
+    MakePayload(
+      DYLD_CHAINED_IMPORT,
+      imports,
+      1,
+      std::string{compressed.begin(), compressed.end()},
+      1),
+    table));
+  EXPECT_TRUE(table.empty());
+}
+#endif
+
+TEST(ChainedImportTable, empty_swift) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  ChainedImportTable table;
+  ASSERT_TRUE(Decoder{}.decode(commands, file.getSize(), table));
+  EXPECT_TRUE(table.empty());
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/Dyld/ExportsTrie.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Dyld;
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+
+// _f      -> terminal: address 0x10
+// _foo    -> terminal: weak, address 0x20
+// _foobar -> terminal: re-export from ordinal 2 as "_baz"
+// _fz     -> terminal: stub and resolver, stub 0x30, resolver 0x40
+static const uint8_t kTrie[] = {
+  /* 0x00 */ 0x00, 0x01, '_', 'f', 0x00, 0x06,
+  /* 0x06 */ 0x02, 0x00, 0x10, 0x02, 'o', 'o', 0x00, 0x13, 'z', 0x00, 0x26,
+  /* 0x11 */ 0x00, 0x00,
+  /* 0x13 */ 0x02, 0x04, 0x20, 0x01, 'b', 'a', 'r', 0x00, 0x1c,
+  /* 0x1c */ 0x07, 0x08, 0x02, '_', 'b', 'a', 'z', 0x00, 0x00,
+  /* 0x25 */ 0x00,
+  /* 0x26 */ 0x03, 0x10, 0x30, 0x40, 0x00,
+};
+
+static ExportsTrie MakeTrie() {
+  return ExportsTrie{kTrie, kTrie + sizeof(kTrie)};
+}
+
+TEST(ExportsTrie, lookup) {
+  auto trie = MakeTrie();
+  ExportedSymbol symbol;
+
+  ASSERT_TRUE(trie.lookup("_f", symbol));
+  EXPECT_EQ(symbol.getAddress(), 0x10);
+  EXPECT_EQ(symbol.getKind(), ExportedSymbol::Kind::Regular);
+
+  ASSERT_TRUE(trie.lookup("_foo", symbol));
+  EXPECT_EQ(symbol.getAddress(), 0x20);
+  EXPECT_TRUE(symbol.isWeakDefinition());
+
+  ASSERT_TRUE(trie.lookup("_foobar", symbol));
+  EXPECT_TRUE(symbol.isReexport());
+  EXPECT_EQ(symbol.getLibraryOrdinal(), 2);
+  EXPECT_EQ(symbol.getImportName(), "_baz");
+
+  ASSERT_TRUE(trie.lookup("_fz", symbol));
+  EXPECT_TRUE(symbol.isStubAndResolver());
+  EXPECT_EQ(symbol.getAddress(), 0x30);
+  EXPECT_EQ(symbol.getResolverAddress(), 0x40);
+
+  EXPECT_FALSE(trie.lookup("", symbol));
+  EXPECT_FALSE(trie.lookup("_", symbol));
+  EXPECT_FALSE(trie.lookup("_fo", symbol));
+  EXPECT_FALSE(trie.lookup("_foob", symbol));
+  EXPECT_FALSE(trie.lookup("_foobarx", symbol));
+  EXPECT_FALSE(trie.lookup("_g", symbol));
+}
+
+TEST(ExportsTrie, enumerate) {
+  auto trie = MakeTrie();
+  std::vector<std::pair<std::string, uint64_t>> symbols;
+  ExportsTrieEnumerator enumerator;
+  EXPECT_TRUE(enumerator.enumerate(
+    trie, [&](std::string_view name, const ExportedSymbol& symbol) {
+      symbols.emplace_back(std::string{name}, symbol.getFlags());
+    }));
+  std::vector<std::pair<std::string, uint64_t>> expected{
+    {"_f", 0x00},
+    {"_foo", EXPORT_SYMBOL_FLAGS_WEAK_DEFINITION},
+    {"_foobar", EXPORT_SYMBOL_FLAGS_REEXPORT},
+    {"_fz", EXPORT_SYMBOL_FLAGS_STUB_AND_RESOLVER},
+  };
+  EXPECT_EQ(symbols, expected);
+
+  size_t visited = 0;
+  EXPECT_FALSE(enumerator.enumerate(
+    trie, [&](std::string_view, const ExportedSymbol&) {
+      return ++visited < 2;
+    }));
+  EXPECT_EQ(visited, 2);
+}
+
+TEST(ExportsTrie, rejects_cycles) {
+  // The only child of the root is the root itself.
+  static const uint8_t trie[] = {0x00, 0x01, 'a', 0x00, 0x00};
+  ExportsTrie cyclic{trie, trie + sizeof(trie)};
+  size_t visited = 0;
+  ExportsTrieEnumerator enumerator;
+  enumerator.enumerate(
+    cyclic, [&](std::string_view, const ExportedSymbol&) { visited++; });
+  EXPECT_EQ(visited, 0);
+  ExportedSymbol symbol;
+  EXPECT_FALSE(cyclic.lookup("aaaa", symbol));
+}
+
+TEST(ExportsTrie, rejects_shared_children) {
+  // Both edges of each of 40 nodes lead to the next one, hence the last
+  // node, the only terminal one, is reached along 2^40 paths.
+  const size_t nodeCount = 40;
+  const size_t nodeSize = 10;
+  std::vector<uint8_t> trie;
+  for (size_t index = 0; index < nodeCount; index++) {
+    size_t next = (index + 1) * nodeSize;
+    trie.insert(trie.end(), {0x00, 0x02});
+    for (uint8_t label : {'a', 'b'}) {
+      trie.insert(
+        trie.end(),
+        {label,
+         0x00,
+         static_cast<uint8_t>(0x80 | (next & 0x7F)),
+         static_cast<uint8_t>(next >> 7)});
+    }
+  }
+  trie.insert(trie.end(), {0x02, 0x00, 0x00, 0x00});
+
+  ExportsTrie shared{trie.data(), trie.data() + trie.size()};
+  size_t visited = 0;
+  ExportsTrieEnumerator enumerator;
+  EXPECT_FALSE(enumerator.enumerate(
+    shared, [&](std::string_view, const ExportedSymbol&) { visited++; }));
+  EXPECT_EQ(visited, 1);
+  ExportedSymbol symbol;
+  EXPECT_TRUE(shared.lookup(std::string(nodeCount, 'b'), symbol));
+}
+
+TEST(ExportsTrie, rejects_truncated_numbers) {
+  ExportedSymbol symbol;
+  ExportsTrieEnumerator enumerator;
+  auto visitor = [](std::string_view, const ExportedSymbol&) {};
+
+  // The child offset of the only edge runs past the end.
+  static const uint8_t childOffset[] = {0x00, 0x01, 'a', 0x00, 0x80};
+  ExportsTrie truncatedEdge{childOffset, childOffset + sizeof(childOffset)};
+  EXPECT_FALSE(truncatedEdge.lookup("a", symbol));
+  EXPECT_FALSE(enumerator.enumerate(truncatedEdge, visitor));
+
+  // The terminal size of the root runs past the end.
+  static const uint8_t terminalSize[] = {0x80, 0x80};
+  ExportsTrie truncatedNode{terminalSize, terminalSize + sizeof(terminalSize)};
+  EXPECT_FALSE(truncatedNode.lookup("", symbol));
+  EXPECT_FALSE(enumerator.enumerate(truncatedNode, visitor));
+
+  // The address runs past the terminal information.
+  static const uint8_t address[] = {0x02, 0x00, 0x80, 0x00};
+  ExportsTrie truncatedAddress{address, address + sizeof(address)};
+  EXPECT_FALSE(truncatedAddress.lookup("", symbol));
+
+  // Numbers wider than 64 bits.
+  static const uint8_t wide[] = {
+    0x0B, 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0x7F, 0x00};
+  ExportsTrie tooWide{wide, wide + sizeof(wide)};
+  EXPECT_FALSE(tooWide.lookup("", symbol));
+}
+
+TEST(ExportsTrie, empty_swift) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  ExportsTrie trie{commands, file.getSize()};
+  ASSERT_FALSE(trie.empty());
+
+  ExportedSymbol symbol;
+  ASSERT_TRUE(trie.lookup("_main", symbol));
+  EXPECT_EQ(symbol.getAddress(), 0x3fa8);
+  ASSERT_TRUE(trie.lookup("__mh_execute_header", symbol));
+  EXPECT_EQ(symbol.getAddress(), 0);
+
+  std::vector<std::string> names;
+  trie.forEach([&](std::string_view name, const ExportedSymbol&) {
+    names.emplace_back(name);
+  });
+  EXPECT_EQ(names, (std::vector<std::string>{"__mh_execute_header", "_main"}));
+}
@@ -0,0 +1,82 @@
+#ifndef DCL_TESTS_BINARY_DARWIN_FATTESTSUPPORT_H
+#define DCL_TESTS_BINARY_DARWIN_FATTESTSUPPORT_H
+
+#include <dcl/Binary/Darwin/Fat.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace dcl::Binary::Darwin::Testing {
+
+/// The CPU a slice of a fat file claims to be of.
+class FatSliceCPU {
+public:
+  cpu_type_t cputype;
+
+  cpu_subtype_t cpusubtype;
+};
+
+/// A fat header of `archs` in big-endian as on disk, followed by
+/// `payloadSize` bytes of zeros.
+template <typename ArchTy>
+inline std::vector<uint8_t>
+MakeFatArchs(const std::vector<ArchTy>& archs, size_t payloadSize) {
+  using BigEndianess = dcl::Platform::BigEndianess;
+  std::vector<uint8_t> fat(
+    sizeof(fat_header) + archs.size() * sizeof(ArchTy) + payloadSize);
+  fat_header header;
+  header.magic = BigEndianess::swapFromHost(uint32_t(
+    std::is_same<ArchTy, fat_arch_64>::value ? FAT_MAGIC_64 : FAT_MAGIC));
+  header.nfat_arch = BigEndianess::swapFromHost(uint32_t(archs.size()));
+  std::memcpy(fat.data(), &header, sizeof(header));
+  for (size_t index = 0; index < archs.size(); index++) {
+    ArchTy arch = archs[index];
+    arch.cputype = BigEndianess::swapFromHost(arch.cputype);
+    arch.cpusubtype = BigEndianess::swapFromHost(arch.cpusubtype);
+    arch.offset = BigEndianess::swapFromHost(arch.offset);
+    arch.size = BigEndianess::swapFromHost(arch.size);
+    arch.align = BigEndianess::swapFromHost(arch.align);
+    std::memcpy(
+      fat.data() + sizeof(header) + index * sizeof(arch), &arch, sizeof(arch));
+  }
+  return fat;
+}
+
+/// A fat file of a copy of `slice` for each of `cpus`, with the slices
+/// aligned to 16 KiB and the file ending with the last one.
+template <typename ArchTy = fat_arch>
+inline std::vector<uint8_t> MakeFat(
+  const std::vector<uint8_t>& slice, const std::vector<FatSliceCPU>& cpus) {
+  using OffsetTy = decltype(ArchTy::offset);
+  const uint32_t align = 14;
+  const uint64_t alignment = uint64_t(1) << align;
+  const uint64_t stride = (slice.size() + alignment - 1) & ~(alignment - 1);
+
+  std::vector<ArchTy> archs;
+  for (size_t index = 0; index < cpus.size(); index++) {
+    ArchTy arch{};
+    arch.cputype = cpus[index].cputype;
+    arch.cpusubtype = cpus[index].cpusubtype;
+    arch.offset = OffsetTy(alignment + index * stride);
+    arch.size = OffsetTy(slice.size());
+    arch.align = align;
+    archs.push_back(arch);
+  }
+  const size_t headerSize = sizeof(fat_header) + cpus.size() * sizeof(ArchTy);
+  const size_t fileSize =
+    cpus.empty() ? alignment
+                 : alignment + (cpus.size() - 1) * stride + slice.size();
+  auto fat = MakeFatArchs(archs, fileSize - headerSize);
+  for (size_t index = 0; index < cpus.size(); index++) {
+    std::memcpy(
+      fat.data() + alignment + index * stride, slice.data(), slice.size());
+  }
+  return fat;
+}
+
+} // namespace dcl::Binary::Darwin::Testing
+
+#endif // DCL_TESTS_BINARY_DARWIN_FATTESTSUPPORT_H
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include "FatTestSupport.h"
+
+#include <dcl/Binary/Darwin/Fat.h>
+#include <dcl/Binary/Darwin/MachOView.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Testing;
+using dcl::Platform::BigEndianess;
+
+TEST(Fat, arch_collection_starts_after_the_header) {
+  auto fat = MakeFatArchs<fat_arch>(
+    {{CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, 0x40, 0x10, 4},
+     {CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E, 0x80, 0x20, 4}},
+    0x100);
+  using Archs = FatArchCollection<details::File<uint32_t>, BigEndianess>;
+  auto& archs = *reinterpret_cast<const Archs *>(fat.data());
+  ASSERT_EQ(archs.cend() - archs.cbegin(), 2);
+  EXPECT_EQ(archs.at(0).getCPUType(), CPU_TYPE_X86_64);
+  EXPECT_EQ(archs.at(1).getCPUSubtype(), CPU_SUBTYPE_ARM64E);
+  EXPECT_EQ(archs.at(1).getOffset(), 0x80);
+}
+
+TEST(Fat, arch_64_offsets_are_64_bit) {
+  const uint64_t offset = uint64_t(5) << 32;
+  auto fat = MakeFatArchs<fat_arch_64>(
+    {{CPU_TYPE_ARM64,
+      CPU_SUBTYPE_ARM64_ALL,
+      offset,
+      uint64_t(1) << 33,
+      14,
+      0}},
+    0);
+  using Archs = FatArchCollection<details::File<uint64_t>, BigEndianess>;
+  auto& archs = *reinterpret_cast<const Archs *>(fat.data());
+  EXPECT_EQ(archs.at(0).getOffset(), offset);
+  EXPECT_EQ(archs.at(0).getSize(), uint64_t(1) << 33);
+  EXPECT_EQ(archs.at(0).getAlign(), 14);
+
+  // The index rejects archs past the end of the file, yet keeps 64-bit
+  // offsets of files large enough to hold them.
+  FatArchIndex index;
+  EXPECT_FALSE(index.build(fat.data(), fat.size()));
+  EXPECT_TRUE(index.empty());
+  ASSERT_TRUE(index.build(fat.data(), uint64_t(7) << 32));
+  ASSERT_EQ(index.size(), 1);
+  EXPECT_EQ(index[0].offset, offset);
+  EXPECT_EQ(index[0].size, uint64_t(1) << 33);
+}
+
+TEST(Fat, arch_index) {
+  auto fat = MakeFatArchs<fat_arch>(
+    {{CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, 0x40, 0x10, 4},
+     {CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 0x80, 0x20, 4},
+     {CPU_TYPE_ARM64,
+      int32_t(CPU_SUBTYPE_ARM64E | CPU_SUBTYPE_PTRAUTH_ABI),
+      0xC0,
+      0x20,
+      4}},
+    0x100);
+  FatArchIndex index;
+  ASSERT_TRUE(index.build(fat.data(), fat.size()));
+  ASSERT_EQ(index.size(), 3);
+  EXPECT_EQ(index[0].cputype, CPU_TYPE_X86_64);
+  EXPECT_EQ(index[2].offset, 0xC0);
+  EXPECT_EQ(index[2].size, 0x20);
+  EXPECT_EQ(index[2].align, 4);
+
+  EXPECT_EQ(index.find(CPU_TYPE_ARM64), &index[1]);
+  EXPECT_EQ(index.find(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E), &index[2]);
+  EXPECT_EQ(index.find(CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_H), nullptr);
+  EXPECT_EQ(index.find(CPU_TYPE_POWERPC), nullptr);
+
+  // Mach-O files are not fat.
+  uint32_t thin[] = {MH_MAGIC_64, 0};
+  EXPECT_FALSE(index.build(thin, sizeof(thin)));
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(Fat, grades_cpus_like_dyld) {
+  using details::GradeCPU;
+  const cpu_subtype_t arm64e =
+    int32_t(CPU_SUBTYPE_ARM64E | CPU_SUBTYPE_PTRAUTH_ABI);
+  const cpu_type_t arm64 = CPU_TYPE_ARM64;
+  EXPECT_GT(
+    GradeCPU(arm64, CPU_SUBTYPE_ARM64E, arm64, arm64e),
+    GradeCPU(arm64, CPU_SUBTYPE_ARM64E, arm64, CPU_SUBTYPE_ARM64_ALL));
+  EXPECT_GT(
+    GradeCPU(arm64, CPU_SUBTYPE_ARM64E, arm64, CPU_SUBTYPE_ARM64_ALL), 0);
+  EXPECT_EQ(GradeCPU(arm64, CPU_SUBTYPE_ARM64_ALL, arm64, arm64e), 0);
+
+  EXPECT_GT(
+    GradeCPU(
+      CPU_TYPE_X86_64,
+      CPU_SUBTYPE_X86_64_H,
+      CPU_TYPE_X86_64,
+      CPU_SUBTYPE_X86_64_ALL),
+    0);
+  EXPECT_EQ(
+    GradeCPU(
+      CPU_TYPE_X86_64,
+      CPU_SUBTYPE_X86_64_ALL,
+      CPU_TYPE_X86_64,
+      CPU_SUBTYPE_X86_64_H),
+    0);
+  EXPECT_EQ(
+    GradeCPU(
+      CPU_TYPE_X86_64, CPU_SUBTYPE_ANY, CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL),
+    0);
+}
+
+TEST(Fat, selects_the_best_arch) {
+  auto fat = MakeFatArchs<fat_arch>(
+    {{CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL, 0x40, 0x10, 4},
+     {CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_H, 0x50, 0x10, 4},
+     {CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL, 0x80, 0x20, 4},
+     {CPU_TYPE_ARM64,
+      int32_t(CPU_SUBTYPE_ARM64E | CPU_SUBTYPE_PTRAUTH_ABI),
+      0xC0,
+      0x20,
+      4}},
+    0x100);
+  FatArchIndex index;
+  ASSERT_TRUE(index.build(fat.data(), fat.size()));
+  EXPECT_EQ(index.select(CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_H), &index[1]);
+  EXPECT_EQ(index.select(CPU_TYPE_X86_64, CPU_SUBTYPE_X86_64_ALL), &index[0]);
+  EXPECT_EQ(index.select(CPU_TYPE_X86_64, CPU_SUBTYPE_ANY), &index[0]);
+  EXPECT_EQ(index.select(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E), &index[3]);
+  EXPECT_EQ(index.select(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_V8), &index[2]);
+  EXPECT_EQ(index.select(CPU_TYPE_POWERPC, CPU_SUBTYPE_ANY), nullptr);
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/FieldLayouts.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/Binary/Darwin/MachOView.h>
+
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+using dcl::Platform::BigEndianess;
+
+TEST(FieldLayouts, bulk_swaps_big_endian_fat_archs) {
+  using BigFatArch = FatArch<details::File<uint32_t>, BigEndianess>;
+  std::vector<fat_arch> raw(7);
+  for (uint32_t index = 0; index < raw.size(); index++) {
+    raw[index].cputype = BigEndianess::swapFromHost(CPU_TYPE_ARM64);
+    raw[index].cpusubtype = BigEndianess::swapFromHost<int32_t>(index);
+    raw[index].offset = BigEndianess::swapFromHost(0x4000 * (index + 1));
+    raw[index].size = BigEndianess::swapFromHost(0x1234 + index);
+    raw[index].align = BigEndianess::swapFromHost<uint32_t>(14);
+  }
+
+  auto archs = reinterpret_cast<const BigFatArch *>(raw.data());
+  std::vector<fat_arch> host(raw.size());
+  dcl::Platform::BulkSwapToHost(archs, raw.size(), host.data());
+
+  for (uint32_t index = 0; index < raw.size(); index++) {
+    EXPECT_EQ(host[index].cputype, CPU_TYPE_ARM64);
+    EXPECT_EQ(host[index].cpusubtype, index);
+    EXPECT_EQ(host[index].offset, archs[index].getOffset());
+    EXPECT_EQ(host[index].size, archs[index].getSize());
+    EXPECT_EQ(host[index].align, archs[index].getAlign());
+  }
+}
+
+TEST(FieldLayouts, bulk_swaps_big_endian_sections) {
+  using BigSection = Section<Remote<uint64_t>, BigEndianess>;
+  std::vector<section_64> raw(3);
+  for (uint32_t index = 0; index < raw.size(); index++) {
+    std::memset(&raw[index], 0, sizeof(section_64));
+    std::strcpy(raw[index].sectname, "__text");
+    std::strcpy(raw[index].segname, "__TEXT");
+    raw[index].addr = BigEndianess::swapFromHost<uint64_t>(0x100000000 + index);
+    raw[index].size = BigEndianess::swapFromHost<uint64_t>(0x80);
+    raw[index].offset = BigEndianess::swapFromHost<uint32_t>(0x1000 * index);
+    raw[index].flags = BigEndianess::swapFromHost<uint32_t>(0x80000400);
+  }
+
+  auto sections = reinterpret_cast<const BigSection *>(raw.data());
+  std::vector<section_64> host(raw.size());
+  dcl::Platform::BulkSwapToHost(sections, raw.size(), host.data());
+
+  for (uint32_t index = 0; index < raw.size(); index++) {
+    EXPECT_STREQ(host[index].sectname, "__text");
+    EXPECT_STREQ(host[index].segname, "__TEXT");
+    EXPECT_EQ(host[index].addr, sections[index].getVirtualMemoryAddress());
+    EXPECT_EQ(host[index].size, sections[index].getVirtualMemorySize());
+    EXPECT_EQ(host[index].offset, sections[index].getFileOffset());
+    EXPECT_EQ(host[index].flags, sections[index].getFlags());
+  }
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/Collections.h>
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachO.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <iterator>
+
+using namespace dcl::Binary::Darwin;
+
+using Header = MachHeader<Remote<uint64_t>, dcl::Platform::LittleEndianess>;
+using Index =
+  LoadCommandIndex<Remote<uint64_t>, dcl::Platform::LittleEndianess>;
+
+TEST(LoadCommandIndex, empty_swift) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<Header *>(file.getBytes());
+  Index index{header};
+
+  EXPECT_EQ(index.size(), header->getNumberOfCommands());
+  EXPECT_EQ(index.count(LoadCommandKind64::Semgent), 4);
+  EXPECT_EQ(index.count(LoadCommandKind64::DylibLoad), 2);
+  EXPECT_EQ(index.count(LoadCommandKind64::RPath), 0);
+  EXPECT_TRUE(index.all(LoadCommandKind64::RPath).empty());
+  EXPECT_EQ(index.first(LoadCommandKind64::RPath), nullptr);
+
+  auto uuid = index.first(LoadCommandKind64::UUID);
+  ASSERT_NE(uuid, nullptr);
+  EXPECT_EQ(uuid->getBase() - index.getHeader()->getBase(), 888);
+
+  auto symbolTable =
+    index.first<SymbolTableCommand>(LoadCommandKind64::StabSymbolTable);
+  ASSERT_NE(symbolTable, nullptr);
+  EXPECT_EQ(symbolTable->getCommandSize(), sizeof(symtab_command));
+
+  EXPECT_NE(index.first(LoadCommandKind64::DyldChainedFixups), nullptr);
+  EXPECT_EQ(index.first(LoadCommandKind64::DyldInfo), nullptr);
+  EXPECT_EQ(index.first(LoadCommandKind64::DyldInfoOnly), nullptr);
+}
+
+TEST(LoadCommandIndex, all_agrees_with_linear_walk) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<Header *>(file.getBytes());
+  Index index{header};
+
+  std::vector<const uint8_t *> segments;
+  LoadCommandCollection loadCommands{header};
+  for (auto& eachLoadCommand : loadCommands) {
+    if (eachLoadCommand.getCommand() == LoadCommandKind64::Semgent) {
+      segments.push_back(eachLoadCommand.getBase());
+    }
+  }
+
+  std::vector<const uint8_t *> indexed;
+  for (auto& eachSegment : index.all(LoadCommandKind64::Semgent)) {
+    EXPECT_EQ(eachSegment.getCommand(), LoadCommandKind64::Semgent);
+    indexed.push_back(eachSegment.getBase());
+  }
+  EXPECT_EQ(indexed, segments);
+}
+
+TEST(LoadCommandIndex, distrusts_the_number_of_commands) {
+  mach_header_64 header{};
+  header.magic = MH_MAGIC_64;
+  header.ncmds = 0xFFFFFFFF;
+  header.sizeofcmds = 0;
+  Index index{reinterpret_cast<Header *>(&header)};
+  EXPECT_EQ(index.size(), 0);
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include "FatTestSupport.h"
+
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/MachOStream.h>
+#include <dcl/IO/File.h>
+#include <dcl/IO/StreamReader.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstring>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace dcl::Binary::Darwin;
+using namespace dcl::Binary::Darwin::Testing;
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+
+/// Writes `bytes` to a pipe from another thread, then closes it.
+class Pipe {
+public:
+  int fds[2];
+
+  std::thread writer;
+
+  explicit Pipe(const std::vector<uint8_t>& bytes) {
+    EXPECT_EQ(pipe(fds), 0);
+    writer = std::thread([this, &bytes]() {
+      size_t written = 0;
+      while (written < bytes.size()) {
+        ssize_t count =
+          write(fds[1], bytes.data() + written, bytes.size() - written);
+        if (count <= 0) {
+          break;
+        }
+        written += count;
+      }
+      close(fds[1]);
+    });
+  }
+
+  ~Pipe() {
+    // Drains what was not read so that the writer never blocks.
+    char drain[4096];
+    while (read(fds[0], drain, sizeof(drain)) > 0) {
+    }
+    writer.join();
+    close(fds[0]);
+  }
+};
+
+static std::vector<uint8_t> ReadEmptySwift() {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto bytes = static_cast<const uint8_t *>(file.getBytes());
+  return std::vector<uint8_t>(bytes, bytes + file.getSize());
+}
+
+// A fat file of `thin` as arm64 and arm64e.
+static std::vector<uint8_t> MakeARM64Fat(const std::vector<uint8_t>& thin) {
+  return MakeFat(
+    thin,
+    {{CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL},
+     {CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E}});
+}
+
+// Checks that the `__LINKEDIT` fetched from `stream` is the one of `thin`.
+static void ExpectLinkEdit(MachOStream& stream, std::vector<uint8_t>& thin) {
+  auto header = reinterpret_cast<MachHeader<Target, ByteOrder> *>(thin.data());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  uint64_t fileOffset = 0;
+  uint64_t fileSize = 0;
+  for (auto& eachCommand : commands.all(Target::LoadCommandKindTy::Semgent)) {
+    auto segment =
+      reinterpret_cast<SegmentCommand<Target, ByteOrder> *>(&eachCommand);
+    if (!std::strcmp(segment->getWrappedValue().segname, "__LINKEDIT")) {
+      fileOffset = segment->getFileOffset();
+      fileSize = segment->getFileSize();
+    }
+  }
+  ASSERT_GT(fileSize, 0);
+
+  std::vector<uint8_t> linkEdit;
+  uint64_t fetchedOffset = 0;
+  ASSERT_TRUE(
+    (stream.fetchLinkEdit<Target, ByteOrder>(linkEdit, fetchedOffset)));
+  EXPECT_EQ(fetchedOffset, fileOffset);
+  ASSERT_EQ(linkEdit.size(), fileSize);
+  EXPECT_EQ(
+    std::memcmp(linkEdit.data(), thin.data() + fileOffset, fileSize), 0);
+
+  // The stream is past the header by now.
+  std::vector<uint8_t> bytes;
+  EXPECT_FALSE(stream.fetch(0, 16, bytes));
+  EXPECT_TRUE(bytes.empty());
+}
+
+TEST(MachOStream, reads_a_mach_o_from_a_pipe) {
+  auto thin = ReadEmptySwift();
+  Pipe pipe{thin};
+  dcl::IO::StreamReader reader{pipe.fds[0]};
+  MachOStream stream{reader};
+  ASSERT_TRUE(stream.readHeader(CPU_TYPE_ARM64));
+  EXPECT_EQ(stream.getFormat(), Format::LittleEndianess64Bit);
+  EXPECT_TRUE(stream.getFatArchs().empty());
+  EXPECT_EQ(stream.getSliceOffset(), 0);
+
+  auto header = stream.getHeader<Target, ByteOrder>();
+  ASSERT_NE(header, nullptr);
+  EXPECT_EQ(
+    stream.getHeaderSize(),
+    sizeof(mach_header_64) + header->getSizeOfCommands());
+  EXPECT_EQ(
+    std::memcmp(stream.getHeaderBytes(), thin.data(), stream.getHeaderSize()),
+    0);
+  EXPECT_EQ((stream.getHeader<Remote<uint32_t>, ByteOrder>()), nullptr);
+
+  auto view = stream.getView();
+  EXPECT_EQ(std::distance(view.begin(), view.end()), 1);
+  EXPECT_NE((view.getMachO<Target, ByteOrder>()), nullptr);
+
+  ExpectLinkEdit(stream, thin);
+}
+
+TEST(MachOStream, selects_a_slice_of_a_fat_file) {
+  auto thin = ReadEmptySwift();
+  auto fat = MakeARM64Fat(thin);
+  Pipe pipe{fat};
+  dcl::IO::StreamReader reader{pipe.fds[0]};
+  MachOStream stream{reader};
+  ASSERT_TRUE(stream.readHeader(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E));
+  ASSERT_EQ(stream.getFatArchs().size(), 2);
+  EXPECT_EQ(stream.getSliceOffset(), stream.getFatArchs()[1].offset);
+  EXPECT_NE((stream.getHeader<Target, ByteOrder>()), nullptr);
+
+  ExpectLinkEdit(stream, thin);
+}
+
+TEST(MachOStream, rejects_other_streams) {
+  auto thin = ReadEmptySwift();
+  {
+    Pipe pipe{thin};
+    dcl::IO::StreamReader reader{pipe.fds[0]};
+    MachOStream stream{reader};
+    EXPECT_FALSE(stream.readHeader(CPU_TYPE_X86_64));
+    EXPECT_EQ(stream.getFormat(), Format::Unknown);
+    EXPECT_EQ(stream.getHeaderSize(), 0);
+  }
+  {
+    // The load commands exceed the lookahead.
+    Pipe pipe{thin};
+    dcl::IO::StreamReader reader{pipe.fds[0], 64, 64};
+    MachOStream stream{reader};
+    EXPECT_FALSE(stream.readHeader());
+  }
+  {
+    // A load command runs past the others.
+    auto malformed = thin;
+    load_command command;
+    std::memcpy(&command, malformed.data() + sizeof(mach_header_64), 8);
+    command.cmdsize = 0x10000;
+    std::memcpy(malformed.data() + sizeof(mach_header_64), &command, 8);
+    Pipe pipe{malformed};
+    dcl::IO::StreamReader reader{pipe.fds[0]};
+    MachOStream stream{reader};
+    EXPECT_FALSE(stream.readHeader());
+    EXPECT_EQ(stream.getHeaderSize(), 0);
+    auto view = stream.getView();
+    EXPECT_EQ(std::distance(view.begin(), view.end()), 0);
+  }
+  {
+    std::vector<uint8_t> garbage(64, 0xAB);
+    Pipe pipe{garbage};
+    dcl::IO::StreamReader reader{pipe.fds[0]};
+    MachOStream stream{reader};
+    EXPECT_FALSE(stream.readHeader());
+  }
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include "FatTestSupport.h"
+
+#include <dcl/Binary/Darwin/MachOVerifier.h>
+#include <dcl/Binary/Darwin/MachOView.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+
+using namespace dcl::Binary::Darwin::Testing;
+
+using BigEndianess = dcl::Platform::BigEndianess;
+
+static const std::vector<FatSliceCPU> kARM64{
+  {CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL}};
+
+static std::vector<uint8_t> ReadEmptySwift() {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto begin = static_cast<const uint8_t *>(file.getBytes());
+  return std::vector<uint8_t>(begin, begin + file.getSize());
+}
+
+// The offset of the first load command of `kind`, or zero.
+static size_t FindCommand(const std::vector<uint8_t>& image, uint32_t kind) {
+  mach_header_64 header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  size_t offset = sizeof(header);
+  for (uint32_t index = 0; index < header.ncmds; index++) {
+    load_command command;
+    std::memcpy(&command, image.data() + offset, sizeof(command));
+    if (command.cmd == kind) {
+      return offset;
+    }
+    offset += command.cmdsize;
+  }
+  return 0;
+}
+
+template <typename Struct>
+static void Patch(
+  std::vector<uint8_t>& image,
+  size_t offset,
+  const std::function<void(Struct&)>& patch) {
+  Struct value;
+  std::memcpy(&value, image.data() + offset, sizeof(value));
+  patch(value);
+  std::memcpy(image.data() + offset, &value, sizeof(value));
+}
+
+static bool Verify(const std::vector<uint8_t>& bytes) {
+  return MachOVerifier::verify(bytes.data(), bytes.size());
+}
+
+TEST(MachOVerifier, empty_swift) {
+  auto image = ReadEmptySwift();
+  EXPECT_TRUE(Verify(image));
+  EXPECT_TRUE(MachOVerifier::verifyMachO(image.data(), image.size()));
+}
+
+TEST(MachOVerifier, rejects_truncated_files) {
+  auto image = ReadEmptySwift();
+  EXPECT_FALSE(MachOVerifier::verify(image.data(), 3));
+  EXPECT_FALSE(MachOVerifier::verify(image.data(), sizeof(mach_header_64)));
+  EXPECT_FALSE(MachOVerifier::verify(image.data(), image.size() - 1));
+  EXPECT_FALSE(MachOVerifier::verify(nullptr, 0));
+}
+
+TEST(MachOVerifier, rejects_malformed_load_commands) {
+  auto image = ReadEmptySwift();
+  size_t offset = FindCommand(image, LC_DYLD_CHAINED_FIXUPS);
+  ASSERT_NE(offset, 0);
+
+  auto tooLong = image;
+  Patch<load_command>(
+    tooLong, offset, [](load_command& command) { command.cmdsize = 0x10000; });
+  EXPECT_FALSE(Verify(tooLong));
+
+  auto tooShort = image;
+  Patch<load_command>(
+    tooShort, offset, [](load_command& command) { command.cmdsize = 4; });
+  EXPECT_FALSE(Verify(tooShort));
+
+  auto outOfBounds = image;
+  Patch<linkedit_data_command>(
+    outOfBounds, offset, [&](linkedit_data_command& command) {
+      command.datasize = static_cast<uint32_t>(image.size());
+    });
+  EXPECT_FALSE(Verify(outOfBounds));
+
+  auto tooManyCommands = image;
+  Patch<mach_header_64>(tooManyCommands, 0, [](mach_header_64& header) {
+    header.ncmds += 1;
+  });
+  EXPECT_FALSE(Verify(tooManyCommands));
+}
+
+TEST(MachOVerifier, rejects_segments_out_of_bounds) {
+  auto image = ReadEmptySwift();
+  size_t offset = FindCommand(image, LC_SYMTAB);
+  ASSERT_NE(offset, 0);
+  Patch<symtab_command>(image, offset, [](symtab_command& command) {
+    command.nsyms = 0x40000000;
+  });
+  EXPECT_FALSE(Verify(image));
+
+  image = ReadEmptySwift();
+  offset = FindCommand(image, LC_SEGMENT_64);
+  ASSERT_NE(offset, 0);
+  Patch<segment_command_64>(image, offset, [](segment_command_64& command) {
+    command.fileoff = ~uint64_t(0);
+  });
+  EXPECT_FALSE(Verify(image));
+}
+
+TEST(MachOVerifier, load_commands_of_a_file_of_unknown_size) {
+  auto image = ReadEmptySwift();
+  mach_header_64 header;
+  std::memcpy(&header, image.data(), sizeof(header));
+  image.resize(sizeof(header) + header.sizeofcmds);
+  EXPECT_TRUE(MachOVerifier::verifyLoadCommands(image.data(), image.size()));
+  EXPECT_FALSE(Verify(image));
+  EXPECT_FALSE(MachOVerifier::verifyLoadCommands(image.data(), 32));
+
+  size_t offset = FindCommand(image, LC_SEGMENT_64);
+  ASSERT_NE(offset, 0);
+  // Ranges still must not overflow.
+  Patch<segment_command_64>(image, offset, [](segment_command_64& command) {
+    command.fileoff = ~uint64_t(0);
+    command.filesize = 1;
+  });
+  EXPECT_FALSE(MachOVerifier::verifyLoadCommands(image.data(), image.size()));
+}
+
+TEST(MachOVerifier, fat) {
+  auto image = ReadEmptySwift();
+  auto fat = MakeFat(image, kARM64);
+  EXPECT_TRUE(Verify(fat));
+  auto fat64 = MakeFat<fat_arch_64>(image, kARM64);
+  EXPECT_TRUE(Verify(fat64));
+
+  Patch<fat_arch>(fat, sizeof(fat_header), [](fat_arch& arch) {
+    arch.size = BigEndianess::swapFromHost(
+      BigEndianess::swapToHost(arch.size) + 1);
+  });
+  EXPECT_FALSE(Verify(fat));
+
+  Patch<fat_header>(fat64, 0, [](fat_header& header) {
+    header.nfat_arch = BigEndianess::swapFromHost(uint32_t(0x10000000));
+  });
+  EXPECT_FALSE(Verify(fat64));
+
+  // Fat files do not nest.
+  auto nested = MakeFat(image, kARM64);
+  EXPECT_FALSE(Verify(MakeFat(nested, kARM64)));
+}
+
+TEST(MachOVerifier, view_of_verified_file) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  MachOView view{file};
+  EXPECT_TRUE(view.isVerified());
+  EXPECT_TRUE(view.isValid());
+  EXPECT_EQ(view.getSize(), file.getSize());
+  EXPECT_EQ(std::distance(view.begin(), view.end()), 1);
+  EXPECT_NE(
+    (view.getMachO<Remote<uint64_t>, dcl::Platform::LittleEndianess>()),
+    nullptr);
+}
+
+TEST(MachOVerifier, view_of_malformed_buffer_has_no_slices) {
+  auto image = ReadEmptySwift();
+  MachOView truncated{image.data(), image.size() / 2};
+  EXPECT_FALSE(truncated.isVerified());
+  EXPECT_FALSE(truncated.isValid());
+  EXPECT_EQ(std::distance(truncated.begin(), truncated.end()), 0);
+  EXPECT_EQ(
+    (truncated.getMachO<Remote<uint64_t>, dcl::Platform::LittleEndianess>()),
+    nullptr);
+
+  // Views without a size used to exit on unrecognized magics.
+  uint32_t garbage[] = {0x12345678, 0};
+  MachOView unknown{garbage};
+  EXPECT_FALSE(unknown.isVerified());
+  EXPECT_TRUE(unknown.isValid());
+  EXPECT_EQ(std::distance(unknown.begin(), unknown.end()), 0);
+}
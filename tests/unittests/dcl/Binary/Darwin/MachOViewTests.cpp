@@ -1,14 +1,45 @@
 #include <gtest/gtest.h>
 
+#include "FatTestSupport.h"
+
 #include <dcl/Binary/Darwin/Collections.h>
 #include <dcl/Binary/Darwin/Dyld/DyldFixupChains.h>
 #include <dcl/Binary/Darwin/Dyld/DyldInfo.h>
 #include <dcl/Binary/Darwin/MachOView.h>
 #include <dcl/IO/File.h>
+#include <dcl/IO/ImageCache.h>
 #include <dcl/Platform/ByteOrder.h>
 
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <unistd.h>
+
 using namespace dcl::Binary::Darwin;
 
+// empty_swift, and fat files made of copies of it.
+class MachOViewFat : public ::testing::Test {
+protected:
+  dcl::IO::File thin{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+
+  // A fat file of `sliceCount` copies of `thin`. Slice `index` claims to be
+  // of `cputype` and subtype `index`.
+  template <typename ArchTy = fat_arch>
+  std::vector<uint8_t>
+  makeFat(uint32_t sliceCount, cpu_type_t cputype = CPU_TYPE_X86_64) const {
+    std::vector<Testing::FatSliceCPU> cpus;
+    for (uint32_t index = 0; index < sliceCount; index++) {
+      cpus.push_back({cputype, cpu_subtype_t(index)});
+    }
+    auto bytes = static_cast<const uint8_t *>(thin.getBytes());
+    return Testing::MakeFat<ArchTy>({bytes, bytes + thin.getSize()}, cpus);
+  }
+};
+
 TEST(MachOView, constructor_with_valid_file) {
   dcl::IO::File file{
     BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
@@ -63,4 +94,187 @@ TEST(MachOView, empty_swift) {
   }
   size_t sliceCount = std::distance(view.begin(), view.end());
   EXPECT_EQ(sliceCount, 1);
-}
\ No newline at end of file
+}
+
+TEST(MachOView, visit) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  MachOView view{file};
+  size_t visitCount = 0;
+  size_t commandCount = 0;
+  EXPECT_TRUE(view.visit([&](auto& machO) {
+    using MachOTy = std::remove_reference_t<decltype(machO)>;
+    EXPECT_FALSE(std::is_const<MachOTy>::value);
+    EXPECT_EQ(
+      static_cast<void *>(&machO),
+      static_cast<void *>(
+        view.getMachO<Remote<uint64_t>, dcl::Platform::LittleEndianess>()));
+    visitCount++;
+    commandCount += machO.getHeader()->getNumberOfCommands();
+  }));
+  EXPECT_EQ(visitCount, 1);
+  EXPECT_GT(commandCount, 0);
+
+  const MachOView& constView = view;
+  EXPECT_TRUE(constView.visit([&](auto& machO) {
+    using MachOTy = std::remove_reference_t<decltype(machO)>;
+    EXPECT_TRUE(std::is_const<MachOTy>::value);
+  }));
+
+  uint32_t garbage[] = {0x12345678, 0};
+  MachOView unknown{garbage};
+  EXPECT_TRUE(unknown.visit([](auto&) { FAIL(); }));
+}
+
+TEST_F(MachOViewFat, for_each_slice_parallel) {
+  auto fat = makeFat(4);
+  MachOView view{fat.data(), fat.size()};
+  ASSERT_TRUE(view.isVerified());
+
+  for (unsigned threadCount : {1u, 2u, 8u}) {
+    auto offsets = view.forEachSliceParallel(
+      [&](MachOView::Slice& slice) {
+        ptrdiff_t offset = -1;
+        slice.visit([&](auto& machO) {
+          offset = reinterpret_cast<uint8_t *>(&machO) - fat.data();
+        });
+        return offset;
+      },
+      threadCount);
+    ASSERT_EQ(offsets.size(), 4);
+    EXPECT_EQ(offsets[0], 0x4000);
+    for (size_t index = 1; index < offsets.size(); index++) {
+      EXPECT_GT(offsets[index], offsets[index - 1]);
+    }
+  }
+
+  auto isRecognized = view.forEachSliceParallel(
+    [](MachOView::Slice& slice) { return slice.visit([](auto&) {}); });
+  EXPECT_EQ(isRecognized, std::vector<bool>(4, true));
+
+  std::atomic<size_t> visitCount{0};
+  view.forEachSliceParallel([&](MachOView::Slice&) { visitCount++; }, 3);
+  EXPECT_EQ(visitCount.load(), 4);
+}
+
+TEST_F(MachOViewFat, fat_64) {
+  auto fat = makeFat<fat_arch_64>(2);
+  MachOView view{fat.data(), fat.size()};
+  ASSERT_TRUE(view.isVerified());
+  EXPECT_EQ(std::distance(view.begin(), view.end()), 2);
+  for (auto eachSlice : view) {
+    EXPECT_EQ(eachSlice.getMachOFormat(), Format::LittleEndianess64Bit);
+    EXPECT_NE(
+      (eachSlice.getMachO<Remote<uint64_t>, dcl::Platform::LittleEndianess>()),
+      nullptr);
+  }
+
+  ASSERT_EQ(view.getFatArchs().size(), 2);
+  const FatArchEntry * arch = view.getFatArchs().find(CPU_TYPE_X86_64, 1);
+  ASSERT_NE(arch, nullptr);
+  EXPECT_EQ(arch, &view.getFatArchs()[1]);
+  EXPECT_EQ(view.findFatArch(CPU_TYPE_X86_64), &view.getFatArchs()[0]);
+  EXPECT_EQ(view.findFatArch(CPU_TYPE_ARM64), nullptr);
+  EXPECT_EQ(
+    GetFormatWithBytes<MachOMagic>(view.getSliceBytes(*arch)),
+    Format::LittleEndianess64Bit);
+}
+
+TEST(MachOView, thin_files_have_no_fat_archs) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  MachOView view{file};
+  EXPECT_TRUE(view.getFatArchs().empty());
+}
+
+TEST_F(MachOViewFat, select_slice) {
+  MachOView thinView{thin};
+  EXPECT_EQ(thinView.selectSlice(CPU_TYPE_ARM64), thin.getBytes());
+  EXPECT_EQ(
+    thinView.selectSlice(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E), thin.getBytes());
+  EXPECT_EQ(thinView.selectSlice(CPU_TYPE_X86_64), nullptr);
+
+  // Slices of arm64, arm64 v8 and arm64e.
+  auto fat = makeFat(3, CPU_TYPE_ARM64);
+  MachOView view{fat.data(), fat.size()};
+  EXPECT_EQ(
+    view.selectSlice(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_ALL),
+    view.getSliceBytes(view.getFatArchs()[0]));
+  EXPECT_EQ(
+    view.selectSlice(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64_V8),
+    view.getSliceBytes(view.getFatArchs()[1]));
+  EXPECT_EQ(view.selectSlice(CPU_TYPE_X86_64), nullptr);
+
+  // Slices other than the selected one are not read.
+  const FatArchEntry& other = view.getFatArchs()[1];
+  std::memset(view.getSliceBytes(other), 0xFF, other.size);
+  MachOView trusted{fat.data()};
+  void * selected = trusted.selectSlice(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E);
+  ASSERT_EQ(selected, trusted.getSliceBytes(trusted.getFatArchs()[2]));
+  EXPECT_TRUE(MachOView(selected, trusted.getFatArchs()[2].size).visit(
+    [](auto&) {}));
+}
+
+TEST_F(MachOViewFat, slice_mapped_on_its_own) {
+  auto fat = makeFat(3, CPU_TYPE_ARM64);
+  char path[] = "/tmp/dcl_fat_XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, fat.data(), fat.size()), ssize_t(fat.size()));
+  close(fd);
+
+  {
+    dcl::IO::File file{
+      path,
+      dcl::IO::Permissions::Read,
+      dcl::IO::AccessPattern::Random,
+      dcl::IO::MappingOptions::Deferred};
+    ASSERT_EQ(file.getBytes(), nullptr);
+
+    dcl::IO::MappedRange header = file.mapRange(0, 0x1000);
+    FatArchIndex archs;
+    ASSERT_TRUE(
+      archs.build(header.getBytes(), header.getSize(), file.getSize()));
+    const FatArchEntry * arch =
+      archs.select(CPU_TYPE_ARM64, CPU_SUBTYPE_ARM64E);
+    ASSERT_EQ(arch, &archs[2]);
+
+    dcl::IO::MappedRange slice = file.mapRange(arch->offset, arch->size);
+    MachOView view{slice};
+    EXPECT_TRUE(view.isVerified());
+    EXPECT_EQ(std::distance(view.begin(), view.end()), 1);
+    EXPECT_NE(
+      (view.getMachO<Remote<uint64_t>, dcl::Platform::LittleEndianess>()),
+      nullptr);
+  }
+  std::remove(path);
+}
+
+TEST_F(MachOViewFat, copy_uuid) {
+  uint8_t uuid[16] = {};
+  ASSERT_TRUE(MachOView{thin}.copyUUID(uuid));
+  uint8_t zero[16] = {};
+  EXPECT_NE(std::memcmp(uuid, zero, sizeof(uuid)), 0);
+
+  auto fat = makeFat(2);
+  uint8_t fatUUID[16] = {};
+  ASSERT_TRUE((MachOView{fat.data(), fat.size()}.copyUUID(fatUUID)));
+  EXPECT_EQ(std::memcmp(uuid, fatUUID, sizeof(uuid)), 0);
+
+  // Images are found by UUID in a cache once opened.
+  dcl::IO::ImageCache cache{
+    1 << 30, [](const void * bytes, size_t size, dcl::IO::ImageUUID& uuid) {
+      uint8_t copied[16];
+      if (!MachOView{const_cast<void *>(bytes), size}.copyUUID(copied)) {
+        return false;
+      }
+      std::memcpy(uuid.data(), copied, sizeof(copied));
+      return true;
+    }};
+  auto image = cache.open(BLOBS_PATH "/macOS/empty_swift");
+  ASSERT_NE(image, nullptr);
+  ASSERT_TRUE(image->hasUUID());
+  dcl::IO::ImageUUID key;
+  std::memcpy(key.data(), uuid, sizeof(uuid));
+  EXPECT_EQ(cache.find(key), image);
+}
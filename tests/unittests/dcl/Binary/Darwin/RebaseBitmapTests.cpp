@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/Dyld/DyldInfo.h>
+#include <dcl/Binary/Darwin/Dyld/RebaseBitmap.h>
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using namespace dcl::Binary::Darwin::Dyld;
+
+// Three segments of two pages each.
+static const SegmentSizes kSegments{std::vector<uint64_t>(3, 0x2000)};
+
+// clang-format off
+static const uint8_t kRebases[] = {
+  REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_POINTER,
+  REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0x10,
+  REBASE_OPCODE_DO_REBASE_IMM_TIMES | 2,                  // 0x10, 0x18
+  REBASE_OPCODE_ADD_ADDR_IMM_SCALED | 1,
+  REBASE_OPCODE_DO_REBASE_ULEB_TIMES, 0x01,               // 0x28
+  REBASE_OPCODE_ADD_ADDR_ULEB, 0x08,
+  REBASE_OPCODE_DO_REBASE_ADD_ADDR_ULEB, 0x10,            // 0x38
+  REBASE_OPCODE_DO_REBASE_ULEB_TIMES_SKIPPING_ULEB, 0x02, 0x80, 0x20,
+                                                          // 0x50, 0x1058
+  REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 2, 0x04,
+  REBASE_OPCODE_DO_REBASE_IMM_TIMES | 1,                  // unaligned
+  REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_TEXT_ABSOLUTE32,
+  REBASE_OPCODE_DO_REBASE_IMM_TIMES | 1,                  // not a pointer
+  REBASE_OPCODE_DONE,
+};
+// clang-format on
+
+TEST(RebaseBitmap, interprets_every_opcode) {
+  RebaseOpcodeInterpreter interpreter{8, kSegments};
+  RebaseBitmap bitmap{8, 0x1000};
+  ASSERT_TRUE(
+    interpreter.interpret(kRebases, kRebases + sizeof(kRebases), bitmap));
+
+  std::vector<std::pair<size_t, uint64_t>> rebases;
+  bitmap.forEach([&](size_t segmentIndex, uint64_t segmentOffset) {
+    rebases.emplace_back(segmentIndex, segmentOffset);
+  });
+  std::vector<std::pair<size_t, uint64_t>> expected{
+    {1, 0x10}, {1, 0x18}, {1, 0x28}, {1, 0x38}, {1, 0x50}, {1, 0x1058}};
+  EXPECT_EQ(rebases, expected);
+  EXPECT_EQ(bitmap.count(), 6);
+
+  EXPECT_TRUE(bitmap.contains(1, 0x28));
+  EXPECT_FALSE(bitmap.contains(1, 0x20));
+  EXPECT_FALSE(bitmap.contains(1, 0x2000));
+  EXPECT_FALSE(bitmap.contains(0, 0x10));
+
+  ASSERT_EQ(bitmap.getSegmentCount(), 2);
+  EXPECT_EQ(bitmap.getWordsPerPage(), 8);
+  ASSERT_EQ(bitmap.getPageCount(1), 2);
+  EXPECT_EQ(
+    bitmap.getPageWords(1, 0)[0],
+    (1 << 2) | (1 << 3) | (1 << 5) | (1 << 7) | (1 << 10));
+  EXPECT_EQ(bitmap.getPageWords(1, 1)[0], 1 << 11);
+
+  ASSERT_EQ(bitmap.getExceptions().size(), 2);
+  EXPECT_EQ(bitmap.getExceptions()[0].segmentIndex, 2);
+  EXPECT_EQ(bitmap.getExceptions()[0].segmentOffset, 0x04);
+  EXPECT_EQ(bitmap.getExceptions()[0].type, REBASE_TYPE_POINTER);
+  EXPECT_EQ(bitmap.getExceptions()[1].segmentOffset, 0x0c);
+  EXPECT_EQ(bitmap.getExceptions()[1].type, REBASE_TYPE_TEXT_ABSOLUTE32);
+}
+
+TEST(RebaseBitmap, rejects_runaway_offsets) {
+  const uint8_t rebases[] = {
+    REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_POINTER,
+    REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB,
+    0x80,
+    0x80,
+    0x80,
+    0x80,
+    0x80,
+    0x01,
+    REBASE_OPCODE_DO_REBASE_IMM_TIMES | 1,
+  };
+  RebaseOpcodeInterpreter interpreter{8, kSegments};
+  RebaseBitmap bitmap{8, 0x4000};
+  EXPECT_FALSE(
+    interpreter.interpret(rebases, rebases + sizeof(rebases), bitmap));
+  EXPECT_EQ(bitmap.getSegmentCount(), 0);
+}
+
+TEST(RebaseBitmap, rejects_rebases_out_of_their_segment) {
+  RebaseOpcodeInterpreter interpreter{8, kSegments};
+  RebaseBitmap bitmap{8, 0x1000};
+  auto interpret = [&](std::vector<uint8_t> rebases) {
+    return interpreter.interpret(
+      rebases.data(), rebases.data() + rebases.size(), bitmap);
+  };
+  const uint8_t pointer = REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_POINTER;
+
+  // The last pointer of a segment, and the one past it.
+  EXPECT_TRUE(interpret(
+    {pointer, REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0xF8, 0x3F,
+     REBASE_OPCODE_DO_REBASE_IMM_TIMES | 1}));
+  EXPECT_FALSE(interpret(
+    {pointer, REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1, 0xF8, 0x3F,
+     REBASE_OPCODE_DO_REBASE_IMM_TIMES | 2}));
+  EXPECT_EQ(bitmap.count(), 0);
+
+  // A segment the image does not have.
+  EXPECT_FALSE(interpret(
+    {pointer, REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 15, 0x00,
+     REBASE_OPCODE_DO_REBASE_IMM_TIMES | 1}));
+  EXPECT_EQ(bitmap.getSegmentCount(), 0);
+
+  // One opcode asking for 2^29 rebases, which fails before growing the
+  // bitmap.
+  EXPECT_FALSE(interpret(
+    {pointer, REBASE_OPCODE_DO_REBASE_ULEB_TIMES, 0x80, 0x80, 0x80, 0x80,
+     0x02}));
+  EXPECT_EQ(bitmap.getSegmentCount(), 0);
+}
+
+TEST(RebaseBitmap, rejects_truncated_numbers) {
+  const uint8_t rebases[] = {
+    REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_POINTER,
+    REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB | 1,
+    0x10,
+    REBASE_OPCODE_DO_REBASE_ULEB_TIMES_SKIPPING_ULEB,
+    0x02,
+    0x80,
+  };
+  RebaseOpcodeInterpreter interpreter{8, kSegments};
+  RebaseBitmap bitmap{8, 0x1000};
+  for (size_t size = 2; size <= sizeof(rebases); size++) {
+    if (size == 3) {
+      continue;
+    }
+    EXPECT_FALSE(interpreter.interpret(rebases, rebases + size, bitmap))
+      << size;
+  }
+  EXPECT_EQ(bitmap.count(), 0);
+}
+
+TEST(RebaseBitmap, rejects_too_many_exceptions) {
+  // kMaxExceptionCount + 1 as a ULEB128.
+  const uint8_t rebases[] = {
+    REBASE_OPCODE_SET_TYPE_IMM | REBASE_TYPE_TEXT_ABSOLUTE32,
+    REBASE_OPCODE_SET_SEGMENT_AND_OFFSET_ULEB,
+    0x00,
+    REBASE_OPCODE_DO_REBASE_ULEB_TIMES,
+    0x81,
+    0x80,
+    0x40,
+  };
+  static_assert(RebaseOpcodeInterpreter::kMaxExceptionCount == 1 << 20);
+  // Room for more than that many pointers.
+  RebaseOpcodeInterpreter interpreter{
+    8, SegmentSizes{std::vector<uint64_t>{uint64_t(1) << 24}}};
+  RebaseBitmap bitmap{8, 0x1000};
+  EXPECT_FALSE(
+    interpreter.interpret(rebases, rebases + sizeof(rebases), bitmap));
+  EXPECT_EQ(
+    bitmap.getExceptions().size(), RebaseOpcodeInterpreter::kMaxExceptionCount);
+}
+
+TEST(RebaseOpcodeIterator, skips_operands) {
+  RebaseOpcodeStream stream{kRebases, kRebases + sizeof(kRebases)};
+  EXPECT_EQ(std::distance(stream.begin(), stream.end()), 13);
+}
+
+TEST(RebaseOpcodeIterator, stops_at_malformed_opcodes) {
+  // An undefined opcode.
+  const uint8_t undefined[] = {REBASE_OPCODE_DONE, 0x90, REBASE_OPCODE_DONE};
+  RebaseOpcodeStream stream{undefined, undefined + sizeof(undefined)};
+  EXPECT_EQ(std::distance(stream.begin(), stream.end()), 2);
+
+  // An operand running past the end.
+  const uint8_t truncated[] = {REBASE_OPCODE_ADD_ADDR_ULEB, 0x80};
+  RebaseOpcodeStream truncatedStream{truncated, truncated + sizeof(truncated)};
+  EXPECT_EQ(
+    std::distance(truncatedStream.begin(), truncatedStream.end()), 1);
+}
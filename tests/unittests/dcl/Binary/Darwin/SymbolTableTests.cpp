@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Binary/Darwin/LoadCommandIndex.h>
+#include <dcl/Binary/Darwin/SymbolTable.h>
+#include <dcl/IO/File.h>
+#include <dcl/Platform/ByteOrder.h>
+
+#include <string>
+#include <vector>
+
+using namespace dcl::Binary::Darwin;
+
+using Target = Remote<uint64_t>;
+using ByteOrder = dcl::Platform::LittleEndianess;
+
+TEST(SymbolTable, empty_swift_names) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  SymbolTable<Target, ByteOrder> symbols{commands, file.getSize()};
+
+  ASSERT_EQ(symbols.getSymbolCount(), 3);
+  EXPECT_EQ(
+    symbols.getName(symbols.getSymbol(0)), "___swift_reflection_version");
+  EXPECT_EQ(symbols.getName(symbols.getSymbol(1)), "__mh_execute_header");
+  EXPECT_EQ(symbols.getName(symbols.getSymbol(2)), "_main");
+  EXPECT_FALSE(symbols.getSymbol(0).isExternal());
+  EXPECT_TRUE(symbols.getSymbol(2).isExternal());
+  EXPECT_EQ(symbols.getSymbol(2).getValue(), 0x100003fa8);
+
+  size_t count = 0;
+  for (auto& eachSymbol : symbols) {
+    EXPECT_TRUE(eachSymbol.isDefinedInSection());
+    count++;
+  }
+  EXPECT_EQ(count, 3);
+}
+
+TEST(SymbolTable, empty_swift_symbolicate) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  SymbolTable<Target, ByteOrder> symbols{commands, file.getSize()};
+
+  EXPECT_EQ(symbols.lookup(0xfff), nullptr);
+  EXPECT_EQ(symbols.lookup(0x100003fac), &symbols.getSymbol(2));
+
+  uint64_t addresses[] = {
+    0x100003fb8, 0xfff, 0x100003fa8, 0x100000010, 0x100003fb4, 0x100003fa8};
+  const Nlist<Target, ByteOrder> * results[6];
+  symbols.symbolicate(addresses, 6, results);
+
+  for (size_t index = 0; index < 6; index++) {
+    EXPECT_EQ(results[index], symbols.lookup(addresses[index]));
+  }
+  EXPECT_EQ(results[0], &symbols.getSymbol(0));
+  EXPECT_EQ(results[1], nullptr);
+  EXPECT_EQ(results[3], &symbols.getSymbol(1));
+}
+
+TEST(SymbolTable, empty_swift_find_symbol) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  auto header = static_cast<MachHeader<Target, ByteOrder> *>(file.getBytes());
+  LoadCommandIndex<Target, ByteOrder> commands{header};
+  SymbolTable<Target, ByteOrder> symbols{commands, file.getSize()};
+
+  EXPECT_EQ(symbols.findSymbol("_main"), &symbols.getSymbol(2));
+  EXPECT_EQ(symbols.findSymbol("__mh_execute_header"), &symbols.getSymbol(1));
+  EXPECT_EQ(
+    symbols.findSymbol("___swift_reflection_version"), &symbols.getSymbol(0));
+  EXPECT_EQ(symbols.findSymbol("_mai"), nullptr);
+  EXPECT_EQ(symbols.findSymbol("_main_"), nullptr);
+  EXPECT_EQ(symbols.findSymbol(""), nullptr);
+}
+
+TEST(SymbolTable, symbol_name_table) {
+  std::vector<std::string> names;
+  for (size_t index = 0; index < 1000; index++) {
+    names.push_back("_symbol_" + std::to_string(index));
+  }
+  auto getName = [&](uint32_t index) { return std::string_view{names[index]}; };
+  details::SymbolNameTable table;
+  table.reserve(names.size());
+  for (uint32_t index = 0; index < names.size(); index++) {
+    table.insert(names[index], index, getName);
+  }
+  table.insert("_symbol_7", 999, getName);
+  for (uint32_t index = 0; index < names.size(); index++) {
+    EXPECT_EQ(table.find(names[index], getName), index);
+  }
+  EXPECT_EQ(table.find("_symbol_1000", getName), table.kEmpty);
+}
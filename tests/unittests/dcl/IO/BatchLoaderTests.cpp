@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <dcl/IO/BatchLoader.h>
+#include <dcl/IO/File.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+static void ExpectLoaded(
+  const dcl::IO::BatchLoader& loader,
+  const std::vector<const char *>& paths,
+  const char * tinyPath) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  size_t headerSize = std::min(loader.getHeaderSize(), file.getSize());
+
+  ASSERT_EQ(loader.size(), paths.size());
+  for (size_t index = 0; index < paths.size(); index++) {
+    const dcl::IO::BatchEntry& entry = loader[index];
+    if (paths[index] == tinyPath) {
+      ASSERT_TRUE(entry.isLoaded());
+      EXPECT_EQ(entry.fileSize, 5);
+      ASSERT_EQ(entry.size, 5);
+      EXPECT_EQ(std::memcmp(loader.getBytes(index), "tiny", 5), 0);
+    } else if (index % 3 == 1) {
+      EXPECT_EQ(entry.error, ENOENT);
+    } else {
+      ASSERT_TRUE(entry.isLoaded());
+      EXPECT_EQ(entry.fileSize, file.getSize());
+      ASSERT_EQ(entry.size, headerSize);
+      EXPECT_EQ(
+        std::memcmp(loader.getBytes(index), file.getBytes(), headerSize), 0);
+    }
+  }
+}
+
+TEST(BatchLoader, loads_headers_of_many_files) {
+  char tinyPath[] = "/tmp/dcl_batch_XXXXXX";
+  int fd = mkstemp(tinyPath);
+  ASSERT_NE(fd, -1);
+  ASSERT_EQ(write(fd, "tiny", 5), 5);
+  close(fd);
+
+  // More files than a ring takes at once, every third one missing.
+  std::vector<const char *> paths;
+  for (size_t index = 0; index < 600; index++) {
+    if (index % 3 == 1) {
+      paths.push_back("/nonexistent/dcl");
+    } else if (index == 300) {
+      paths.push_back(tinyPath);
+    } else {
+      paths.push_back(BLOBS_PATH "/macOS/empty_swift");
+    }
+  }
+
+  for (size_t headerSize :
+       {dcl::IO::BatchLoader::kDefaultHeaderSize, size_t(4096)}) {
+    dcl::IO::BatchLoader loader{headerSize};
+    EXPECT_FALSE(loader.load(paths.data(), paths.size()));
+    EXPECT_NE(loader.getMethod(), dcl::IO::BatchMethod::Automatic);
+    ExpectLoaded(loader, paths, tinyPath);
+
+    EXPECT_FALSE(loader.load(
+      paths.data(), paths.size(), dcl::IO::BatchMethod::ThreadPool, 4));
+    EXPECT_EQ(loader.getMethod(), dcl::IO::BatchMethod::ThreadPool);
+    ExpectLoaded(loader, paths, tinyPath);
+  }
+
+  dcl::IO::BatchLoader loader;
+  const char * existing[] = {tinyPath, tinyPath};
+  EXPECT_TRUE(loader.load(existing, 2, dcl::IO::BatchMethod::IOURing));
+  EXPECT_TRUE(loader.load(nullptr, 0));
+  EXPECT_TRUE(loader.empty());
+  std::remove(tinyPath);
+}
@@ -10,8 +10,57 @@ TEST(File, ConstructsWithEmptyString) {
 }
 
 TEST(File, ConstructsWithString) {
-  dcl::IO::File file{"/usr/lib/dyld", dcl::IO::Permissions::Read};
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
   EXPECT_TRUE(file.getBytes() != nullptr);
   EXPECT_TRUE(file.getFd() != -1);
   EXPECT_TRUE(file.getSize() != 0);
-}
\ No newline at end of file
+}
+
+TEST(File, AdvisesAccessPatterns) {
+  for (auto pattern :
+       {dcl::IO::AccessPattern::Normal,
+        dcl::IO::AccessPattern::Sequential,
+        dcl::IO::AccessPattern::Random,
+        dcl::IO::AccessPattern::WillNeed}) {
+    dcl::IO::File file{
+      BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read, pattern};
+    ASSERT_NE(file.getBytes(), nullptr);
+    EXPECT_TRUE(file.advise(pattern));
+  }
+
+  dcl::IO::File missing{"", dcl::IO::Permissions::Read};
+  EXPECT_FALSE(missing.advise(dcl::IO::AccessPattern::Random));
+}
+
+TEST(File, PrefetchesRanges) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  EXPECT_TRUE(file.prefetch(0, file.getSize()));
+  // Unaligned ranges, and ranges past the end which are clamped.
+  EXPECT_TRUE(file.prefetch(123, 456));
+  EXPECT_TRUE(file.prefetch(file.getSize() - 1, 4096));
+  EXPECT_FALSE(file.prefetch(file.getSize(), 1));
+
+  dcl::IO::File missing{"", dcl::IO::Permissions::Read};
+  EXPECT_FALSE(missing.prefetch(0, 1));
+}
+
+TEST(File, MapsPrivately) {
+  using dcl::IO::MappingOptions;
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift",
+    dcl::IO::Permissions::Read,
+    dcl::IO::AccessPattern::Normal,
+    MappingOptions::Private | MappingOptions::Populate |
+      MappingOptions::HugePages};
+  ASSERT_NE(file.getBytes(), nullptr);
+  auto bytes = static_cast<uint32_t *>(file.getBytes());
+  ASSERT_EQ(bytes[0], 0xFEEDFACF);
+  // Writable although the file is opened for reading only.
+  bytes[0] = 0;
+
+  dcl::IO::File shared{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  EXPECT_EQ(*static_cast<const uint32_t *>(shared.getBytes()), 0xFEEDFACF);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <dcl/IO/ImageCache.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Takes the first bytes of an image as its UUID.
+static bool ReadLeadingBytes(
+  const void * bytes, size_t size, dcl::IO::ImageUUID& uuid) {
+  if (size < uuid.size()) {
+    return false;
+  }
+  std::memcpy(uuid.data(), bytes, uuid.size());
+  return true;
+}
+
+// A temporary file of `size` bytes of `fill`, removed on destruction.
+class TemporaryFile {
+public:
+  char path[32];
+
+  TemporaryFile(size_t size, char fill) {
+    std::strcpy(path, "/tmp/dcl_image_XXXXXX");
+    int fd = mkstemp(path);
+    EXPECT_NE(fd, -1);
+    close(fd);
+    rewrite(size, fill, 0);
+  }
+
+  ~TemporaryFile() { std::remove(path); }
+
+  /// Replaces the contents, moving the modification time `seconds` ahead.
+  void rewrite(size_t size, char fill, time_t seconds) {
+    std::string contents(size, fill);
+    FILE * file = std::fopen(path, "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(std::fwrite(contents.data(), 1, size, file), size);
+    std::fclose(file);
+    if (seconds) {
+      struct timespec times[2];
+      times[0].tv_sec = times[1].tv_sec = time(nullptr) + seconds;
+      times[0].tv_nsec = times[1].tv_nsec = 0;
+      ASSERT_EQ(utimensat(AT_FDCWD, path, times, 0), 0);
+    }
+  }
+};
+
+TEST(ImageCache, opens_each_image_once) {
+  dcl::IO::ImageCache cache{1 << 30, &ReadLeadingBytes};
+  auto image = cache.open(BLOBS_PATH "/macOS/empty_swift");
+  ASSERT_NE(image, nullptr);
+  ASSERT_NE(image->getBytes(), nullptr);
+  EXPECT_EQ(image->getPath(), BLOBS_PATH "/macOS/empty_swift");
+  EXPECT_TRUE(image->hasUUID());
+
+  EXPECT_EQ(cache.open(BLOBS_PATH "/macOS/empty_swift"), image);
+  EXPECT_EQ(cache.find(image->getUUID()), image);
+  EXPECT_EQ(cache.getHitCount(), 2);
+  EXPECT_EQ(cache.getMissCount(), 1);
+  EXPECT_EQ(cache.getCount(), 1);
+  EXPECT_EQ(cache.getSize(), image->getSize());
+
+  EXPECT_EQ(cache.open("/nonexistent/dcl"), nullptr);
+  EXPECT_EQ(cache.find(dcl::IO::ImageUUID{}), nullptr);
+  EXPECT_EQ(cache.getMissCount(), 3);
+}
+
+TEST(ImageCache, evicts_the_least_recently_used_images) {
+  TemporaryFile a{4096, 'a'};
+  TemporaryFile b{4096, 'b'};
+  TemporaryFile c{4096, 'c'};
+  dcl::IO::ImageCache cache{3 * 4096, &ReadLeadingBytes};
+  auto imageA = cache.open(a.path);
+  auto imageB = cache.open(b.path);
+  auto imageC = cache.open(c.path);
+  ASSERT_NE(imageC, nullptr);
+  EXPECT_EQ(cache.getCount(), 3);
+
+  // `a` is used again, hence `b` goes first.
+  EXPECT_EQ(cache.open(a.path), imageA);
+  cache.setBudget(2 * 4096);
+  EXPECT_EQ(cache.getCount(), 2);
+  EXPECT_EQ(cache.getSize(), 2 * 4096);
+  EXPECT_EQ(cache.find(imageB->getUUID()), nullptr);
+  EXPECT_EQ(cache.find(imageA->getUUID()), imageA);
+
+  // An evicted image stays mapped while it is held.
+  EXPECT_EQ(static_cast<const char *>(imageB->getBytes())[4095], 'b');
+  auto reopenedB = cache.open(b.path);
+  EXPECT_NE(reopenedB, imageB);
+  EXPECT_EQ(cache.find(imageC->getUUID()), nullptr);
+
+  cache.clear();
+  EXPECT_EQ(cache.getCount(), 0);
+  EXPECT_EQ(cache.getSize(), 0);
+  EXPECT_EQ(static_cast<const char *>(reopenedB->getBytes())[0], 'b');
+}
+
+TEST(ImageCache, remaps_modified_files) {
+  TemporaryFile file{4096, 'a'};
+  dcl::IO::ImageCache cache{1 << 20};
+  auto image = cache.open(file.path);
+  ASSERT_NE(image, nullptr);
+  EXPECT_FALSE(image->hasUUID());
+
+  file.rewrite(8192, 'b', 10);
+  auto modified = cache.open(file.path);
+  ASSERT_NE(modified, nullptr);
+  EXPECT_NE(modified, image);
+  EXPECT_EQ(modified->getSize(), 8192);
+  EXPECT_EQ(static_cast<const char *>(modified->getBytes())[0], 'b');
+  EXPECT_EQ(cache.getCount(), 1);
+  EXPECT_EQ(cache.getSize(), 8192);
+}
+
+TEST(ImageCache, is_shared_by_threads) {
+  std::vector<TemporaryFile> files;
+  files.reserve(8);
+  for (int index = 0; index < 8; index++) {
+    files.emplace_back(4096, char('a' + index));
+  }
+  dcl::IO::ImageCache cache{4 * 4096, &ReadLeadingBytes};
+
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 4; thread++) {
+    threads.emplace_back([&, thread]() {
+      for (int round = 0; round < 200; round++) {
+        const TemporaryFile& file = files[(round * 3 + thread) % files.size()];
+        auto image = cache.open(file.path);
+        ASSERT_NE(image, nullptr);
+        EXPECT_EQ(
+          static_cast<const char *>(image->getBytes())[0],
+          char('a' + (&file - files.data())));
+        cache.find(image->getUUID());
+      }
+    });
+  }
+  for (std::thread& eachThread : threads) {
+    eachThread.join();
+  }
+  EXPECT_LE(cache.getSize(), 4 * 4096);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include <dcl/IO/File.h>
+#include <dcl/IO/MappedRange.h>
+
+#include <cstring>
+
+TEST(MappedRange, maps_unaligned_windows) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  ASSERT_GT(file.getSize(), 0x5000);
+  auto bytes = static_cast<const uint8_t *>(file.getBytes());
+
+  for (size_t offset : {size_t(0), size_t(0x1000), size_t(0x1234)}) {
+    dcl::IO::MappedRange range = file.mapRange(offset, 0x3000);
+    ASSERT_NE(range.getBytes(), nullptr);
+    EXPECT_EQ(range.getOffset(), offset);
+    EXPECT_EQ(range.getSize(), 0x3000);
+    EXPECT_EQ(std::memcmp(range.getBytes(), bytes + offset, 0x3000), 0);
+  }
+}
+
+TEST(MappedRange, clamps_to_the_end_of_the_file) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift", dcl::IO::Permissions::Read};
+  dcl::IO::MappedRange tail = file.mapRange(file.getSize() - 16, 0x10000);
+  EXPECT_EQ(tail.getSize(), 16);
+
+  EXPECT_TRUE(file.mapRange(file.getSize(), 1).empty());
+  EXPECT_EQ(file.mapRange(file.getSize(), 1).getBytes(), nullptr);
+  EXPECT_TRUE(file.mapRange(0, 0).empty());
+
+  dcl::IO::MappedRange moved{std::move(tail)};
+  EXPECT_EQ(tail.getBytes(), nullptr);
+  EXPECT_EQ(moved.getSize(), 16);
+}
+
+TEST(MappedRange, deferred_files_are_not_mapped) {
+  dcl::IO::File file{
+    BLOBS_PATH "/macOS/empty_swift",
+    dcl::IO::Permissions::Read,
+    dcl::IO::AccessPattern::Normal,
+    dcl::IO::MappingOptions::Deferred};
+  EXPECT_TRUE(file.isOpen());
+  EXPECT_EQ(file.getBytes(), nullptr);
+  EXPECT_GT(file.getSize(), 0);
+  EXPECT_TRUE(file.prefetch(0, 0x1000));
+
+  dcl::IO::MappedRange header = file.mapRange(0, 4);
+  ASSERT_NE(header.getBytes(), nullptr);
+  EXPECT_EQ(*static_cast<const uint32_t *>(header.getBytes()), 0xFEEDFACF);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <dcl/IO/StreamReader.h>
+
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+/// Writes `bytes` to a pipe from another thread, then closes it.
+class Pipe {
+public:
+  int fds[2];
+
+  std::thread writer;
+
+  explicit Pipe(const std::vector<uint8_t>& bytes) {
+    EXPECT_EQ(pipe(fds), 0);
+    writer = std::thread([this, &bytes]() {
+      size_t written = 0;
+      while (written < bytes.size()) {
+        ssize_t count =
+          write(fds[1], bytes.data() + written, bytes.size() - written);
+        if (count <= 0) {
+          break;
+        }
+        written += count;
+      }
+      close(fds[1]);
+    });
+  }
+
+  ~Pipe() {
+    // Drains what was not read so that the writer never blocks.
+    char drain[4096];
+    while (read(fds[0], drain, sizeof(drain)) > 0) {
+    }
+    writer.join();
+    close(fds[0]);
+  }
+};
+
+static std::vector<uint8_t> MakeBytes(size_t size) {
+  std::vector<uint8_t> bytes(size);
+  for (size_t index = 0; index < size; index++) {
+    bytes[index] = static_cast<uint8_t>(index * 7 + index / 256);
+  }
+  return bytes;
+}
+
+TEST(StreamReader, peeks_and_consumes_forward) {
+  auto bytes = MakeBytes(300000);
+  Pipe pipe{bytes};
+  // A small buffer so that peeks have to grow it and reads bypass it.
+  dcl::IO::StreamReader stream{pipe.fds[0], 16, 100000};
+
+  auto peeked = static_cast<const uint8_t *>(stream.peek(4));
+  ASSERT_NE(peeked, nullptr);
+  EXPECT_EQ(std::memcmp(peeked, bytes.data(), 4), 0);
+  EXPECT_EQ(stream.getOffset(), 0);
+
+  peeked = static_cast<const uint8_t *>(stream.peek(70000));
+  ASSERT_NE(peeked, nullptr);
+  EXPECT_EQ(std::memcmp(peeked, bytes.data(), 70000), 0);
+  EXPECT_EQ(stream.peek(100001), nullptr);
+
+  ASSERT_TRUE(stream.skip(1000));
+  std::vector<uint8_t> read(100000);
+  ASSERT_TRUE(stream.read(read.data(), read.size()));
+  EXPECT_EQ(std::memcmp(read.data(), bytes.data() + 1000, read.size()), 0);
+  EXPECT_EQ(stream.getOffset(), 101000);
+
+  EXPECT_FALSE(stream.skipTo(100));
+  ASSERT_TRUE(stream.skipTo(250000));
+  peeked = static_cast<const uint8_t *>(stream.peek(50000));
+  ASSERT_NE(peeked, nullptr);
+  EXPECT_EQ(std::memcmp(peeked, bytes.data() + 250000, 50000), 0);
+  EXPECT_EQ(stream.peek(50001), nullptr);
+  EXPECT_FALSE(stream.isAtEnd());
+
+  dcl::IO::StreamReader moved{std::move(stream)};
+  EXPECT_EQ(stream.getFd(), -1);
+  ASSERT_TRUE(moved.skip(50000));
+  EXPECT_TRUE(moved.isAtEnd());
+  EXPECT_FALSE(moved.skip(1));
+}
+
+TEST(StreamReader, fails_past_the_end) {
+  auto bytes = MakeBytes(100);
+  Pipe pipe{bytes};
+  dcl::IO::StreamReader stream{pipe.fds[0]};
+  std::vector<uint8_t> read(200);
+  EXPECT_FALSE(stream.read(read.data(), read.size()));
+  EXPECT_EQ(stream.getOffset(), 100);
+  EXPECT_TRUE(stream.isAtEnd());
+
+  dcl::IO::StreamReader closed{-1};
+  EXPECT_TRUE(closed.isAtEnd());
+  EXPECT_EQ(closed.peek(1), nullptr);
+}
+
+TEST(StreamReader, keeps_read_errors) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  // The write end of a pipe cannot be read.
+  dcl::IO::StreamReader stream{fds[1]};
+  EXPECT_EQ(stream.peek(1), nullptr);
+  EXPECT_EQ(stream.getError(), EBADF);
+  EXPECT_FALSE(stream.isAtEnd());
+  uint8_t byte;
+  EXPECT_FALSE(stream.read(&byte, 1));
+
+  dcl::IO::StreamReader moved{std::move(stream)};
+  EXPECT_EQ(moved.getError(), EBADF);
+  EXPECT_EQ(stream.getError(), 0);
+  close(fds[0]);
+  close(fds[1]);
+}
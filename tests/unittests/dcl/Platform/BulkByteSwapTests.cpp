@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Platform/BulkByteSwap.h>
+
+#include <vector>
+
+using namespace dcl::Platform;
+
+namespace {
+
+struct Record {
+  uint32_t a;
+  uint8_t b[2];
+  uint16_t c;
+  uint64_t d;
+  uint32_t e;
+  uint32_t f;
+};
+
+using RecordLayout =
+  FieldLayout<Field<4>, Field<1, 2>, Field<2>, Field<8>, Field<4, 2>>;
+
+static_assert(RecordLayout::size == sizeof(Record));
+
+Record makeRecord(uint32_t seed) {
+  Record record;
+  record.a = 0x01020304 * seed;
+  record.b[0] = static_cast<uint8_t>(seed);
+  record.b[1] = static_cast<uint8_t>(seed + 1);
+  record.c = static_cast<uint16_t>(0x0a0b + seed);
+  record.d = 0x1122334455667788ULL + seed;
+  record.e = ~seed;
+  record.f = seed << 16;
+  return record;
+}
+
+Record swapRecord(Record record) {
+  using Other =
+    std::conditional_t<kHostIsLittleEndian, BigEndianess, LittleEndianess>;
+  record.a = Other::swapToHost(record.a);
+  record.c = Other::swapToHost(record.c);
+  record.d = Other::swapToHost(record.d);
+  record.e = Other::swapToHost(record.e);
+  record.f = Other::swapToHost(record.f);
+  return record;
+}
+
+bool isEqual(const Record& lhs, const Record& rhs) {
+  return lhs.a == rhs.a && lhs.b[0] == rhs.b[0] && lhs.b[1] == rhs.b[1] &&
+         lhs.c == rhs.c && lhs.d == rhs.d && lhs.e == rhs.e && lhs.f == rhs.f;
+}
+
+} // namespace
+
+TEST(BulkByteSwap, matches_per_field_swap_for_every_count) {
+  for (uint32_t count = 0; count < 40; count++) {
+    std::vector<Record> source;
+    for (uint32_t index = 0; index < count; index++) {
+      source.push_back(makeRecord(index + 1));
+    }
+    std::vector<Record> destination(count);
+    BulkByteSwap<RecordLayout>(source.data(), destination.data(), count);
+    for (uint32_t index = 0; index < count; index++) {
+      EXPECT_TRUE(isEqual(destination[index], swapRecord(source[index])))
+        << "count: " << count << ", index: " << index;
+    }
+  }
+}
+
+TEST(BulkByteSwap, swaps_in_place) {
+  std::vector<Record> records;
+  for (uint32_t index = 0; index < 17; index++) {
+    records.push_back(makeRecord(index + 1));
+  }
+  std::vector<Record> expected;
+  for (const auto& record : records) {
+    expected.push_back(swapRecord(record));
+  }
+  BulkByteSwap<RecordLayout>(records.data(), records.data(), records.size());
+  for (size_t index = 0; index < records.size(); index++) {
+    EXPECT_TRUE(isEqual(records[index], expected[index]));
+  }
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <dcl/Platform/ByteOrder.h>
+#include <dcl/Platform/TypeWrapper.h>
+
+#include <cstring>
+
+using namespace dcl::Platform;
+
+TEST(ByteOrder, host_byte_order_matches_memory_layout) {
+  const uint32_t value = 0x01020304;
+  uint8_t bytes[sizeof(value)];
+  std::memcpy(bytes, &value, sizeof(value));
+  EXPECT_EQ(kHostIsLittleEndian, bytes[0] == 0x04);
+}
+
+TEST(ByteOrder, swaps_unsigned_integers) {
+  using NonHostByteOrder =
+    std::conditional_t<kHostIsLittleEndian, BigEndianess, LittleEndianess>;
+  EXPECT_EQ(NonHostByteOrder::swapToHost<uint8_t>(0x12), 0x12);
+  EXPECT_EQ(NonHostByteOrder::swapToHost<uint16_t>(0x1234), 0x3412);
+  EXPECT_EQ(NonHostByteOrder::swapToHost<uint32_t>(0x12345678), 0x78563412);
+  EXPECT_EQ(
+    NonHostByteOrder::swapToHost<uint64_t>(0x0102030405060708ULL),
+    0x0807060504030201ULL);
+  EXPECT_EQ(HostByteOrder::swapToHost<uint32_t>(0x12345678), 0x12345678);
+}
+
+TEST(ByteOrder, swaps_signed_integers) {
+  using NonHostByteOrder =
+    std::conditional_t<kHostIsLittleEndian, BigEndianess, LittleEndianess>;
+  EXPECT_EQ(NonHostByteOrder::swapToHost<int8_t>(-2), -2);
+  EXPECT_EQ(NonHostByteOrder::swapToHost<int16_t>(-2), int16_t(0xfeff));
+  EXPECT_EQ(NonHostByteOrder::swapToHost<int32_t>(-2), int32_t(0xfeffffff));
+  EXPECT_EQ(
+    NonHostByteOrder::swapFromHost<int64_t>(
+      NonHostByteOrder::swapToHost<int64_t>(-1234567890123LL)),
+    -1234567890123LL);
+}
+
+TEST(ByteOrder, is_constexpr) {
+  static_assert(BigEndianess::swapToHost<uint16_t>(0x0102) ==
+                (kHostIsLittleEndian ? 0x0201 : 0x0102));
+  static_assert(LittleEndianess::swapToHost<uint16_t>(0x0102) ==
+                (kHostIsLittleEndian ? 0x0102 : 0x0201));
+}
+
+namespace {
+
+struct Pair {
+  uint16_t first;
+  uint32_t second;
+};
+
+template <typename ByteOrder>
+class WrappedPair : public TypeWrapper<Pair, ByteOrder> {
+public:
+  using TypeWrapper<Pair, ByteOrder>::TypeWrapper;
+
+  DCL_PLATFORM_TYPE_ACCESSOR(uint16_t, First, first);
+
+  DCL_PLATFORM_TYPE_ACCESSOR(uint32_t, Second, second);
+};
+
+} // namespace
+
+TEST(TypeWrapper, big_endian_accessors_round_trip) {
+  WrappedPair<BigEndianess> pair{Pair{0, 0}};
+  pair.setFirst(0x1234);
+  pair.setSecond(0xcafebabe);
+  EXPECT_EQ(pair.getFirst(), 0x1234);
+  EXPECT_EQ(pair.getSecond(), 0xcafebabe);
+
+  const uint8_t * bytes =
+    reinterpret_cast<const uint8_t *>(&pair.getWrappedValue().second);
+  EXPECT_EQ(bytes[0], 0xca);
+  EXPECT_EQ(bytes[3], 0xbe);
+}
+
+TEST(TypeWrapper, little_endian_accessors_round_trip) {
+  WrappedPair<LittleEndianess> pair{Pair{0, 0}};
+  pair.setSecond(0xcafebabe);
+  EXPECT_EQ(pair.getSecond(), 0xcafebabe);
+
+  const uint8_t * bytes =
+    reinterpret_cast<const uint8_t *>(&pair.getWrappedValue().second);
+  EXPECT_EQ(bytes[0], 0xbe);
+  EXPECT_EQ(bytes[3], 0xca);
+}